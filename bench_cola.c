@@ -0,0 +1,180 @@
+/*
+ * bench_cola.c
+ * Mide el throughput de encolar/desencolar con 1 a N productores y la misma
+ * cantidad de consumidores, comparando cola_concurrente_t contra lista_t
+ * protegida por un mutex (el uso que reemplaza).
+ *
+ * Compilar con:
+ *   gcc -std=c99 -O2 -pthread bench_cola.c cola_concurrente.c lista.c -o bench_cola
+ * Uso:
+ *   ./bench_cola [hilos_max] [elementos_por_productor]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "cola_concurrente.h"
+#include "lista.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define HILOS_MAX_DEFECTO 8
+#define ELEMENTOS_DEFECTO 1000000
+
+
+/* ******************************************************************
+ *                    COLAS A COMPARAR
+ * *****************************************************************/
+
+typedef struct cola_mutex {
+    lista_t* lista;
+    pthread_mutex_t mutex;
+} cola_mutex_t;
+
+static bool mutex_encolar(void* cola, void* dato)
+{
+    cola_mutex_t* c = cola;
+    pthread_mutex_lock(&c->mutex);
+    bool ok = lista_insertar_ultimo(c->lista, dato);
+    pthread_mutex_unlock(&c->mutex);
+    return ok;
+}
+
+static void* mutex_desencolar(void* cola)
+{
+    cola_mutex_t* c = cola;
+    pthread_mutex_lock(&c->mutex);
+    void* dato = lista_borrar_primero(c->lista);
+    pthread_mutex_unlock(&c->mutex);
+    return dato;
+}
+
+static bool concurrente_encolar(void* cola, void* dato)
+{
+    return cola_concurrente_insertar_ultimo(cola, dato);
+}
+
+static void* concurrente_desencolar(void* cola)
+{
+    return cola_concurrente_borrar_primero(cola);
+}
+
+typedef struct prueba {
+    const char* nombre;
+    void* cola;
+    bool (*encolar)(void*, void*);
+    void* (*desencolar)(void*);
+    void (*salir)(void*);
+    size_t elementos;
+    atomic_size_t consumidos;
+    size_t total;
+} prueba_t;
+
+static void concurrente_salir(void* cola)
+{
+    cola_concurrente_salir(cola);
+}
+
+
+/* ******************************************************************
+ *                    HILOS
+ * *****************************************************************/
+
+static void* productor(void* extra)
+{
+    prueba_t* prueba = extra;
+    for (size_t i = 1; i <= prueba->elementos; i++) {
+        // los datos nunca son NULL, así NULL significa cola vacía
+        while (!prueba->encolar(prueba->cola, (void*)(uintptr_t)i)) {
+        }
+    }
+    if (prueba->salir) prueba->salir(prueba->cola);
+    return NULL;
+}
+
+static void* consumidor(void* extra)
+{
+    prueba_t* prueba = extra;
+    uintptr_t suma = 0;
+    while (atomic_load(&prueba->consumidos) < prueba->total) {
+        void* dato = prueba->desencolar(prueba->cola);
+        if (dato) {
+            suma += (uintptr_t)dato;
+            atomic_fetch_add(&prueba->consumidos, 1);
+        }
+    }
+    if (prueba->salir) prueba->salir(prueba->cola);
+    return (void*)suma;
+}
+
+static double segundos(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec / 1e9;
+}
+
+static void correr(prueba_t* prueba, size_t hilos)
+{
+    pthread_t productores[hilos], consumidores[hilos];
+    prueba->total = hilos * prueba->elementos;
+    atomic_store(&prueba->consumidos, 0);
+
+    double inicio = segundos();
+    for (size_t i = 0; i < hilos; i++) {
+        pthread_create(&productores[i], NULL, productor, prueba);
+        pthread_create(&consumidores[i], NULL, consumidor, prueba);
+    }
+    uintptr_t suma = 0;
+    for (size_t i = 0; i < hilos; i++) {
+        void* parcial;
+        pthread_join(productores[i], NULL);
+        pthread_join(consumidores[i], &parcial);
+        suma += (uintptr_t)parcial;
+    }
+    double duracion = segundos() - inicio;
+
+    uintptr_t esperada = (uintptr_t)hilos * prueba->elementos * (prueba->elementos + 1) / 2;
+    printf("%-12s %3zu prod %3zu cons  %8.3f s  %12.0f ops/s  %s\n", prueba->nombre, hilos, hilos,
+           duracion, 2.0 * (double)prueba->total / duracion, suma == esperada ? "OK" : "ERROR");
+}
+
+
+/* ******************************************************************
+ *                        PROGRAMA PRINCIPAL
+ * *****************************************************************/
+
+int main(int argc, char *argv[])
+{
+    size_t hilos_max = argc > 1 ? (size_t)strtol(argv[1], NULL, 10) : HILOS_MAX_DEFECTO;
+    size_t elementos = argc > 2 ? (size_t)strtol(argv[2], NULL, 10) : ELEMENTOS_DEFECTO;
+    if (hilos_max == 0 || 2 * hilos_max > COLA_MAX_HILOS) {
+        fprintf(stderr, "hilos_max debe estar entre 1 y %d\n", COLA_MAX_HILOS / 2);
+        return 1;
+    }
+
+    for (size_t hilos = 1; hilos <= hilos_max; hilos++) {
+        cola_mutex_t con_mutex = {.lista = lista_crear()};
+        pthread_mutex_init(&con_mutex.mutex, NULL);
+        prueba_t prueba_mutex = {
+            .nombre = "lista+mutex", .cola = &con_mutex, .elementos = elementos,
+            .encolar = mutex_encolar, .desencolar = mutex_desencolar,
+        };
+        correr(&prueba_mutex, hilos);
+        lista_destruir(con_mutex.lista, NULL);
+        pthread_mutex_destroy(&con_mutex.mutex);
+
+        cola_concurrente_t* cola = cola_concurrente_crear();
+        prueba_t prueba_concurrente = {
+            .nombre = "concurrente", .cola = cola, .elementos = elementos,
+            .encolar = concurrente_encolar, .desencolar = concurrente_desencolar,
+            .salir = concurrente_salir,
+        };
+        correr(&prueba_concurrente, hilos);
+        cola_concurrente_destruir(cola, NULL);
+    }
+    return 0;
+}
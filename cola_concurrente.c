@@ -0,0 +1,308 @@
+#include "cola_concurrente.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define TAM_LINEA_CACHE 64
+#define PELIGROS_POR_HILO 2
+// Con este umbral cada barrido libera al menos la mitad de lo retirado
+#define UMBRAL_RETIRADOS (2 * COLA_MAX_HILOS * PELIGROS_POR_HILO)
+
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+typedef struct nodo {
+	_Atomic(struct nodo*) proximo;
+	void* dato;
+} nodo_t;
+
+/* Cada hilo publica en peligro[] los nodos que está por leer; un nodo
+ * retirado no se libera mientras figure en el registro de algún hilo.
+ * retirados sólo lo toca el dueño del registro.
+ */
+typedef struct registro {
+	_Atomic(const void*) duenio;
+	_Atomic(nodo_t*) peligro[PELIGROS_POR_HILO];
+	nodo_t** retirados;
+	size_t cant_retirados;
+	size_t cap_retirados;
+	char relleno[TAM_LINEA_CACHE];
+} registro_t;
+
+// primero y ultimo van en líneas distintas: productores y consumidores no se pisan
+struct cola_concurrente {
+	_Atomic(nodo_t*) primero;
+	char relleno_primero[TAM_LINEA_CACHE];
+	_Atomic(nodo_t*) ultimo;
+	char relleno_ultimo[TAM_LINEA_CACHE];
+	registro_t registros[COLA_MAX_HILOS];
+};
+
+// La dirección de esta variable identifica al hilo
+static _Thread_local char identidad_hilo;
+static _Thread_local struct {
+	const cola_concurrente_t* cola;
+	registro_t* registro;
+} registro_cache;
+
+
+/* ******************************************************************
+ *                    PUNTEROS DE PELIGRO
+ * *****************************************************************/
+
+static registro_t* buscar_registro_propio(cola_concurrente_t* cola) {
+	for (size_t i = 0; i < COLA_MAX_HILOS; i++) {
+		if (atomic_load(&cola->registros[i].duenio) == &identidad_hilo) {
+			return &cola->registros[i];
+		}
+	}
+	return NULL;
+}
+
+static registro_t* obtener_registro(cola_concurrente_t* cola) {
+	// se verifica el dueño por si la cola cacheada fue destruida y otra ocupa su lugar
+	if (registro_cache.cola == cola && atomic_load(&registro_cache.registro->duenio) == &identidad_hilo) {
+		return registro_cache.registro;
+	}
+	registro_t* registro = buscar_registro_propio(cola);
+	for (size_t i = 0; !registro && i < COLA_MAX_HILOS; i++) {
+		const void* esperado = NULL;
+		if (atomic_compare_exchange_strong(&cola->registros[i].duenio, &esperado, &identidad_hilo)) {
+			registro = &cola->registros[i];
+		}
+	}
+	if (registro) {
+		registro_cache.cola = cola;
+		registro_cache.registro = registro;
+	}
+	return registro;
+}
+
+// Publica el puntero leído de origen y verifica que siga siendo el mismo
+static nodo_t* proteger(registro_t* registro, size_t indice, _Atomic(nodo_t*)* origen) {
+	nodo_t* nodo;
+	do {
+		nodo = atomic_load(origen);
+		atomic_store(&registro->peligro[indice], nodo);
+	} while (nodo != atomic_load(origen));
+	return nodo;
+}
+
+static void soltar(registro_t* registro) {
+	for (size_t i = 0; i < PELIGROS_POR_HILO; i++) {
+		atomic_store(&registro->peligro[i], NULL);
+	}
+}
+
+static bool esta_en_peligro(cola_concurrente_t* cola, const nodo_t* nodo) {
+	for (size_t i = 0; i < COLA_MAX_HILOS; i++) {
+		for (size_t j = 0; j < PELIGROS_POR_HILO; j++) {
+			if (atomic_load(&cola->registros[i].peligro[j]) == nodo) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+static int comparar_punteros(const void* a, const void* b) {
+	uintptr_t x = (uintptr_t)*(nodo_t* const*)a;
+	uintptr_t y = (uintptr_t)*(nodo_t* const*)b;
+	return (x > y) - (x < y);
+}
+
+/* Libera los retirados que ningún hilo tiene publicados. Los punteros de
+ * peligro se leen una sola vez y se ordenan, así cada retirado se busca en
+ * O(log H) en lugar de recorrer todos los registros.
+ */
+static void barrer(cola_concurrente_t* cola, registro_t* registro) {
+	nodo_t* peligros[COLA_MAX_HILOS * PELIGROS_POR_HILO];
+	size_t cant_peligros = 0;
+	for (size_t i = 0; i < COLA_MAX_HILOS; i++) {
+		for (size_t j = 0; j < PELIGROS_POR_HILO; j++) {
+			nodo_t* nodo = atomic_load(&cola->registros[i].peligro[j]);
+			if (nodo) {
+				peligros[cant_peligros++] = nodo;
+			}
+		}
+	}
+	qsort(peligros, cant_peligros, sizeof(nodo_t*), comparar_punteros);
+
+	size_t quedan = 0;
+	for (size_t i = 0; i < registro->cant_retirados; i++) {
+		nodo_t* nodo = registro->retirados[i];
+		if (bsearch(&nodo, peligros, cant_peligros, sizeof(nodo_t*), comparar_punteros)) {
+			registro->retirados[quedan++] = nodo;
+		} else {
+			free(nodo);
+		}
+	}
+	registro->cant_retirados = quedan;
+}
+
+static void retirar(cola_concurrente_t* cola, registro_t* registro, nodo_t* nodo) {
+	if (registro->cant_retirados == registro->cap_retirados) {
+		size_t cap = registro->cap_retirados ? registro->cap_retirados * 2 : UMBRAL_RETIRADOS;
+		nodo_t** retirados = realloc(registro->retirados, cap * sizeof(nodo_t*));
+		if (!retirados) {
+			// sin memoria para anotarlo se espera a que nadie lo use
+			while (esta_en_peligro(cola, nodo)) {
+			}
+			free(nodo);
+			return;
+		}
+		registro->retirados = retirados;
+		registro->cap_retirados = cap;
+	}
+	registro->retirados[registro->cant_retirados++] = nodo;
+	if (registro->cant_retirados >= UMBRAL_RETIRADOS) {
+		barrer(cola, registro);
+	}
+}
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DE LA COLA
+ * *****************************************************************/
+
+cola_concurrente_t* cola_concurrente_crear(void) {
+	cola_concurrente_t* cola = malloc(sizeof(cola_concurrente_t));
+	if (!cola) {
+		return NULL;
+	}
+	// la cola siempre tiene un nodo centinela adelante
+	nodo_t* centinela = malloc(sizeof(nodo_t));
+	if (!centinela) {
+		free(cola);
+		return NULL;
+	}
+	atomic_init(&centinela->proximo, NULL);
+	atomic_init(&cola->primero, centinela);
+	atomic_init(&cola->ultimo, centinela);
+	for (size_t i = 0; i < COLA_MAX_HILOS; i++) {
+		registro_t* registro = &cola->registros[i];
+		atomic_init(&registro->duenio, NULL);
+		for (size_t j = 0; j < PELIGROS_POR_HILO; j++) {
+			atomic_init(&registro->peligro[j], NULL);
+		}
+		registro->retirados = NULL;
+		registro->cant_retirados = 0;
+		registro->cap_retirados = 0;
+	}
+	return cola;
+}
+
+bool cola_concurrente_esta_vacia(cola_concurrente_t* cola) {
+	registro_t* registro = obtener_registro(cola);
+	if (!registro) {
+		// como borrar_primero, que en este caso devuelve NULL
+		return true;
+	}
+	nodo_t* primero = proteger(registro, 0, &cola->primero);
+	bool vacia = atomic_load(&primero->proximo) == NULL;
+	soltar(registro);
+	return vacia;
+}
+
+bool cola_concurrente_insertar_ultimo(cola_concurrente_t* cola, void* dato) {
+	registro_t* registro = obtener_registro(cola);
+	nodo_t* nodo = malloc(sizeof(nodo_t));
+	if (!registro || !nodo) {
+		free(nodo);
+		return false;
+	}
+	nodo->dato = dato;
+	atomic_init(&nodo->proximo, NULL);
+
+	while (true) {
+		nodo_t* ultimo = proteger(registro, 0, &cola->ultimo);
+		nodo_t* proximo = atomic_load(&ultimo->proximo);
+		if (ultimo != atomic_load(&cola->ultimo)) {
+			continue;
+		}
+		if (proximo) {
+			// otro productor enganchó un nodo y todavía no movió ultimo: se lo ayuda
+			atomic_compare_exchange_weak(&cola->ultimo, &ultimo, proximo);
+			continue;
+		}
+		nodo_t* esperado = NULL;
+		if (atomic_compare_exchange_weak(&ultimo->proximo, &esperado, nodo)) {
+			atomic_compare_exchange_strong(&cola->ultimo, &ultimo, nodo);
+			break;
+		}
+	}
+	soltar(registro);
+	return true;
+}
+
+void* cola_concurrente_borrar_primero(cola_concurrente_t* cola) {
+	registro_t* registro = obtener_registro(cola);
+	if (!registro) {
+		return NULL;
+	}
+	nodo_t* primero;
+	void* dato;
+	while (true) {
+		primero = proteger(registro, 0, &cola->primero);
+		nodo_t* ultimo = atomic_load(&cola->ultimo);
+		nodo_t* proximo = proteger(registro, 1, &primero->proximo);
+		if (primero != atomic_load(&cola->primero)) {
+			continue;
+		}
+		if (!proximo) {
+			soltar(registro);
+			return NULL;
+		}
+		if (primero == ultimo) {
+			atomic_compare_exchange_weak(&cola->ultimo, &ultimo, proximo);
+			continue;
+		}
+		dato = proximo->dato;
+		if (atomic_compare_exchange_weak(&cola->primero, &primero, proximo)) {
+			break;
+		}
+	}
+	soltar(registro);
+	// el centinela viejo sale de la cola; proximo pasa a ser el centinela
+	retirar(cola, registro, primero);
+	return dato;
+}
+
+void cola_concurrente_salir(cola_concurrente_t* cola) {
+	registro_t* registro = buscar_registro_propio(cola);
+	if (!registro) {
+		return;
+	}
+	barrer(cola, registro);
+	soltar(registro);
+	if (registro_cache.registro == registro) {
+		registro_cache.cola = NULL;
+		registro_cache.registro = NULL;
+	}
+	// los retirados que queden los hereda el próximo hilo que tome el registro
+	atomic_store(&registro->duenio, NULL);
+}
+
+void cola_concurrente_destruir(cola_concurrente_t* cola, void destruir_dato(void*)) {
+	nodo_t* centinela = atomic_load(&cola->primero);
+	nodo_t* nodo = atomic_load(&centinela->proximo);
+	free(centinela);
+	while (nodo) {
+		nodo_t* proximo = atomic_load(&nodo->proximo);
+		if (destruir_dato) {
+			destruir_dato(nodo->dato);
+		}
+		free(nodo);
+		nodo = proximo;
+	}
+	for (size_t i = 0; i < COLA_MAX_HILOS; i++) {
+		registro_t* registro = &cola->registros[i];
+		for (size_t j = 0; j < registro->cant_retirados; j++) {
+			free(registro->retirados[j]);
+		}
+		free(registro->retirados);
+	}
+	free(cola);
+}
@@ -0,0 +1,53 @@
+#ifndef COLA_CONCURRENTE_H
+#define COLA_CONCURRENTE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Cola sin locks para varios productores y varios consumidores (cola de
+ * Michael y Scott). Tiene la semántica de usar lista_insertar_ultimo y
+ * lista_borrar_primero como cola de trabajo, pero sin mutex: ningún hilo
+ * bloquea a otro. Los nodos que un hilo saca se liberan recién cuando
+ * ningún otro hilo puede estar leyéndolos (punteros de peligro).
+ *
+ * Cada hilo que usa una cola ocupa uno de sus COLA_MAX_HILOS registros,
+ * que se toma solo en la primera operación y se devuelve con
+ * cola_concurrente_salir. Un hilo que no consigue registro, porque ya hay
+ * COLA_MAX_HILOS usándola, ve la cola vacía: cola_concurrente_esta_vacia
+ * devuelve verdadero, borrar_primero NULL e insertar_ultimo falso.
+ */
+
+#define COLA_MAX_HILOS 128
+
+struct cola_concurrente;
+typedef struct cola_concurrente cola_concurrente_t;
+
+// Crea una cola.
+// Post: devuelve una nueva cola vacía, o NULL si no hubo memoria.
+cola_concurrente_t* cola_concurrente_crear(void);
+
+// Devuelve verdadero si la cola no tenía elementos al momento de mirarla.
+// Pre: la cola fue creada.
+bool cola_concurrente_esta_vacia(cola_concurrente_t* cola);
+
+// Agrega un elemento al final de la cola. Devuelve falso en caso de error.
+// Pre: la cola fue creada y la usan a lo sumo COLA_MAX_HILOS hilos a la vez.
+// Post: el dato se encuentra al final de la cola.
+bool cola_concurrente_insertar_ultimo(cola_concurrente_t* cola, void* dato);
+
+// Saca el primer elemento de la cola y devuelve su valor; si está vacía
+// devuelve NULL.
+// Pre: la cola fue creada y la usan a lo sumo COLA_MAX_HILOS hilos a la vez.
+void* cola_concurrente_borrar_primero(cola_concurrente_t* cola);
+
+// Devuelve el registro del hilo que llama, para que lo use otro hilo. Se
+// llama antes de que termine un hilo que usó la cola.
+// Pre: la cola fue creada.
+void cola_concurrente_salir(cola_concurrente_t* cola);
+
+// Destruye la cola. Si se recibe la función destruir_dato por parámetro,
+// para cada uno de los elementos que queden llama a destruir_dato.
+// Pre: la cola fue creada y ningún hilo la está usando.
+void cola_concurrente_destruir(cola_concurrente_t* cola, void destruir_dato(void*));
+
+#endif // COLA_CONCURRENTE_H
@@ -0,0 +1,544 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "congelado.h"
+#include "hash.h"
+
+#define MAGIA_ARCHIVO "HCONGELA"
+#define VERSION_ARCHIVO 1
+#define BITS_POR_CLAVE 2 // tamaño de cada nivel contra las claves que le llegan
+#define MAX_NIVELES 32
+#define PALABRAS_POR_RANGO 8 // un rango acumulado cada 512 bits
+#define SECCIONES 6
+
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+/* Encabezado del bloque (y del archivo). Lo siguen, cada uno alineado a 8
+ * bytes:
+ * - inicios[niveles + 1]: el primer bit de cada nivel; el último es el
+ *   total de bits;
+ * - bits[palabras]: los niveles uno detrás del otro;
+ * - rangos[palabras / PALABRAS_POR_RANGO + 1]: bits prendidos antes de
+ *   cada grupo de palabras;
+ * - desplazamientos[cantidad + 1]: dónde empieza cada clave en la arena;
+ * - datos[cantidad];
+ * - la arena con las claves, en el orden de sus posiciones.
+ */
+typedef struct encabezado {
+	char magia[8];
+	uint32_t version;
+	uint32_t tam_dato;
+	uint64_t cantidad;
+	uint64_t niveles;
+	uint64_t palabras;
+	uint64_t primera_sobrante; // posición de la primera clave sin nivel
+	uint64_t largo_arena;
+} encabezado_t;
+
+struct congelado {
+	const encabezado_t* encabezado;
+	const uint64_t* inicios;
+	const uint64_t* bits;
+	const uint64_t* rangos;
+	const uint64_t* desplazamientos;
+	void* const* datos;
+	const char* arena;
+	char* bloque;
+	size_t largo;
+	bool mapeado;
+};
+
+// Clave que chocó en todos los niveles, con su dato
+typedef struct sobrante {
+	const char* clave;
+	void* dato;
+} sobrante_t;
+
+
+/* ******************************************************************
+ *                    FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+/* Hash de 64 bits (FNV-1a mezclado). Con 32 bits, a partir de unas decenas
+ * de miles de claves habría pares con el mismo hash, que chocan en todos
+ * los niveles.
+ */
+static uint64_t hash64(const char* clave) {
+	uint64_t h = UINT64_C(0xcbf29ce484222325);
+	for (const unsigned char* c = (const unsigned char*)clave; *c; c++) {
+		h = (h ^ *c) * UINT64_C(0x100000001b3);
+	}
+	return hash_mezclar(h);
+}
+
+// Bit de la clave dentro de un nivel de tam bits
+static uint64_t bit_en_nivel(uint64_t h, size_t nivel, uint64_t tam) {
+	return hash_mezclar(h + (nivel + 1) * UINT64_C(0x9e3779b97f4a7c15)) % tam;
+}
+
+static size_t contar_unos(uint64_t x) {
+	x = x - ((x >> 1) & UINT64_C(0x5555555555555555));
+	x = (x & UINT64_C(0x3333333333333333)) + ((x >> 2) & UINT64_C(0x3333333333333333));
+	x = (x + (x >> 4)) & UINT64_C(0x0f0f0f0f0f0f0f0f);
+	return (size_t)((x * UINT64_C(0x0101010101010101)) >> 56);
+}
+
+static bool bit_prendido(const uint64_t* bits, uint64_t bit) {
+	return (bits[bit / 64] >> (bit % 64)) & 1;
+}
+
+// Cantidad de bits prendidos antes de bit: la posición de su clave
+static size_t rango(const uint64_t* bits, const uint64_t* rangos, uint64_t bit) {
+	size_t palabra = (size_t)(bit / 64);
+	size_t r = (size_t)rangos[palabra / PALABRAS_POR_RANGO];
+	for (size_t i = palabra - palabra % PALABRAS_POR_RANGO; i < palabra; i++) {
+		r += contar_unos(bits[i]);
+	}
+	return r + contar_unos(bits[palabra] & ((UINT64_C(1) << (bit % 64)) - 1));
+}
+
+static size_t alinear(size_t largo) {
+	return (largo + 7) & ~(size_t)7;
+}
+
+// Deja en desde[] dónde empieza cada sección y devuelve el largo del bloque
+static size_t ubicar_secciones(const encabezado_t* encabezado, size_t desde[SECCIONES]) {
+	size_t largos[SECCIONES] = {
+		(size_t)(encabezado->niveles + 1) * sizeof(uint64_t),
+		(size_t)encabezado->palabras * sizeof(uint64_t),
+		(size_t)(encabezado->palabras / PALABRAS_POR_RANGO + 1) * sizeof(uint64_t),
+		(size_t)(encabezado->cantidad + 1) * sizeof(uint64_t),
+		(size_t)encabezado->cantidad * sizeof(void*),
+		(size_t)encabezado->largo_arena,
+	};
+	size_t total = alinear(sizeof(encabezado_t));
+	for (size_t i = 0; i < SECCIONES; i++) {
+		desde[i] = total;
+		total += alinear(largos[i]);
+	}
+	return total;
+}
+
+static void apuntar_secciones(congelado_t* congelado, char* bloque, size_t largo) {
+	size_t desde[SECCIONES];
+	congelado->encabezado = (const encabezado_t*)bloque;
+	ubicar_secciones(congelado->encabezado, desde);
+	congelado->inicios = (const uint64_t*)(bloque + desde[0]);
+	congelado->bits = (const uint64_t*)(bloque + desde[1]);
+	congelado->rangos = (const uint64_t*)(bloque + desde[2]);
+	congelado->desplazamientos = (const uint64_t*)(bloque + desde[3]);
+	congelado->datos = (void* const*)(bloque + desde[4]);
+	congelado->arena = bloque + desde[5];
+	congelado->bloque = bloque;
+	congelado->largo = largo;
+}
+
+static int comparar_sobrantes(const void* a, const void* b) {
+	return strcmp(((const sobrante_t*)a)->clave, ((const sobrante_t*)b)->clave);
+}
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL CONJUNTO
+ * *****************************************************************/
+
+/* Reparte las claves en niveles. Deja en lugares[i] el bit global de la
+ * clave i, o UINT64_MAX si chocó en todos, y en niveles[] los bits de cada
+ * nivel. Devuelve la cantidad de niveles, o -1 si no hubo memoria.
+ */
+static int armar_niveles(const uint64_t* hashes, size_t cantidad, uint64_t* lugares,
+		uint64_t* niveles[MAX_NIVELES], size_t palabras_nivel[MAX_NIVELES]) {
+	size_t* pendientes = malloc((cantidad + 1) * sizeof(size_t));
+	size_t* siguientes = malloc((cantidad + 1) * sizeof(size_t));
+	if (!pendientes || !siguientes) {
+		free(pendientes);
+		free(siguientes);
+		return -1;
+	}
+	for (size_t i = 0; i < cantidad; i++) {
+		pendientes[i] = i;
+		lugares[i] = UINT64_MAX;
+	}
+	size_t restantes = cantidad;
+	uint64_t inicio = 0;
+	int cant_niveles = 0;
+	bool ok = true;
+	while (ok && restantes > 0 && cant_niveles < MAX_NIVELES) {
+		size_t palabras = (BITS_POR_CLAVE * restantes + 63) / 64;
+		uint64_t tam = (uint64_t)palabras * 64;
+		uint64_t* ocupados = calloc(palabras, sizeof(uint64_t));
+		uint64_t* chocados = calloc(palabras, sizeof(uint64_t));
+		if (!ocupados || !chocados) {
+			free(ocupados);
+			free(chocados);
+			ok = false;
+			continue;
+		}
+		for (size_t i = 0; i < restantes; i++) {
+			uint64_t bit = bit_en_nivel(hashes[pendientes[i]], (size_t)cant_niveles, tam);
+			uint64_t mascara = UINT64_C(1) << (bit % 64);
+			if (ocupados[bit / 64] & mascara) {
+				chocados[bit / 64] |= mascara;
+			}
+			ocupados[bit / 64] |= mascara;
+		}
+		// sólo quedan prendidos los bits de una sola clave
+		for (size_t i = 0; i < palabras; i++) {
+			ocupados[i] &= ~chocados[i];
+		}
+		free(chocados);
+		size_t quedan = 0;
+		for (size_t i = 0; i < restantes; i++) {
+			uint64_t bit = bit_en_nivel(hashes[pendientes[i]], (size_t)cant_niveles, tam);
+			if (bit_prendido(ocupados, bit)) {
+				lugares[pendientes[i]] = inicio + bit;
+			} else {
+				siguientes[quedan++] = pendientes[i];
+			}
+		}
+		niveles[cant_niveles] = ocupados;
+		palabras_nivel[cant_niveles] = palabras;
+		cant_niveles++;
+		inicio += tam;
+		size_t* aux = pendientes;
+		pendientes = siguientes;
+		siguientes = aux;
+		restantes = quedan;
+	}
+	free(pendientes);
+	free(siguientes);
+	if (!ok) {
+		for (int i = 0; i < cant_niveles; i++) {
+			free(niveles[i]);
+		}
+		return -1;
+	}
+	return cant_niveles;
+}
+
+/* Llena el bloque ya ubicado: bits y rangos de los niveles, y cada clave
+ * con su dato en su posición. Devuelve false si no hubo memoria.
+ */
+static bool llenar_bloque(congelado_t* congelado, const char** claves, void** datos,
+		const uint64_t* lugares, uint64_t** niveles, const size_t* palabras_nivel) {
+	const encabezado_t* encabezado = congelado->encabezado;
+	size_t cantidad = (size_t)encabezado->cantidad;
+	uint64_t* inicios = (uint64_t*)congelado->inicios;
+	uint64_t* bits = (uint64_t*)congelado->bits;
+	uint64_t* rangos = (uint64_t*)congelado->rangos;
+	uint64_t* desplazamientos = (uint64_t*)congelado->desplazamientos;
+	void** datos_bloque = (void**)congelado->datos;
+	char* arena = (char*)congelado->arena;
+
+	size_t palabra = 0;
+	for (size_t i = 0; i < encabezado->niveles; i++) {
+		inicios[i] = (uint64_t)palabra * 64;
+		memcpy(bits + palabra, niveles[i], palabras_nivel[i] * sizeof(uint64_t));
+		palabra += palabras_nivel[i];
+	}
+	inicios[encabezado->niveles] = (uint64_t)palabra * 64;
+	uint64_t acumulado = 0;
+	for (size_t i = 0; i < encabezado->palabras; i++) {
+		if (i % PALABRAS_POR_RANGO == 0) {
+			rangos[i / PALABRAS_POR_RANGO] = acumulado;
+		}
+		acumulado += contar_unos(bits[i]);
+	}
+	// el último grupo, si quedó completo, cierra con el total
+	if (encabezado->palabras % PALABRAS_POR_RANGO == 0) {
+		rangos[encabezado->palabras / PALABRAS_POR_RANGO] = acumulado;
+	}
+
+	size_t cant_sobrantes = cantidad - (size_t)encabezado->primera_sobrante;
+	sobrante_t* sobrantes = malloc((cant_sobrantes + 1) * sizeof(sobrante_t));
+	size_t* posiciones = malloc((cantidad + 1) * sizeof(size_t));
+	if (!sobrantes || !posiciones) {
+		free(sobrantes);
+		free(posiciones);
+		return false;
+	}
+	size_t s = 0;
+	for (size_t i = 0; i < cantidad; i++) {
+		if (lugares[i] != UINT64_MAX) {
+			posiciones[i] = rango(bits, rangos, lugares[i]);
+		} else {
+			sobrantes[s].clave = claves[i];
+			sobrantes[s].dato = datos[i];
+			s++;
+		}
+	}
+	qsort(sobrantes, cant_sobrantes, sizeof(sobrante_t), comparar_sobrantes);
+
+	// primero el largo de cada posición, después los desplazamientos
+	memset(desplazamientos, 0, (cantidad + 1) * sizeof(uint64_t));
+	for (size_t i = 0; i < cantidad; i++) {
+		if (lugares[i] != UINT64_MAX) {
+			desplazamientos[posiciones[i] + 1] = strlen(claves[i]) + 1;
+			datos_bloque[posiciones[i]] = datos[i];
+		}
+	}
+	for (size_t i = 0; i < cant_sobrantes; i++) {
+		size_t posicion = (size_t)encabezado->primera_sobrante + i;
+		desplazamientos[posicion + 1] = strlen(sobrantes[i].clave) + 1;
+		datos_bloque[posicion] = sobrantes[i].dato;
+	}
+	for (size_t i = 0; i < cantidad; i++) {
+		desplazamientos[i + 1] += desplazamientos[i];
+	}
+	for (size_t i = 0; i < cantidad; i++) {
+		if (lugares[i] != UINT64_MAX) {
+			size_t posicion = posiciones[i];
+			memcpy(arena + desplazamientos[posicion], claves[i], desplazamientos[posicion + 1] - desplazamientos[posicion]);
+		}
+	}
+	for (size_t i = 0; i < cant_sobrantes; i++) {
+		size_t posicion = (size_t)encabezado->primera_sobrante + i;
+		memcpy(arena + desplazamientos[posicion], sobrantes[i].clave, desplazamientos[posicion + 1] - desplazamientos[posicion]);
+	}
+	free(sobrantes);
+	free(posiciones);
+	return true;
+}
+
+congelado_t *congelado_crear(const char **claves, void **datos, size_t cantidad) {
+	congelado_t* congelado = malloc(sizeof(congelado_t));
+	uint64_t* hashes = malloc((cantidad + 1) * sizeof(uint64_t));
+	uint64_t* lugares = malloc((cantidad + 1) * sizeof(uint64_t));
+	if (!congelado || !hashes || !lugares) {
+		free(congelado);
+		free(hashes);
+		free(lugares);
+		return NULL;
+	}
+	for (size_t i = 0; i < cantidad; i++) {
+		hashes[i] = hash64(claves[i]);
+	}
+	uint64_t* niveles[MAX_NIVELES];
+	size_t palabras_nivel[MAX_NIVELES];
+	int cant_niveles = armar_niveles(hashes, cantidad, lugares, niveles, palabras_nivel);
+	free(hashes);
+	if (cant_niveles < 0) {
+		free(congelado);
+		free(lugares);
+		return NULL;
+	}
+
+	encabezado_t encabezado;
+	memset(&encabezado, 0, sizeof(encabezado));
+	memcpy(encabezado.magia, MAGIA_ARCHIVO, sizeof(encabezado.magia));
+	encabezado.version = VERSION_ARCHIVO;
+	encabezado.tam_dato = sizeof(void*);
+	encabezado.cantidad = cantidad;
+	encabezado.niveles = (uint64_t)cant_niveles;
+	for (int i = 0; i < cant_niveles; i++) {
+		encabezado.palabras += palabras_nivel[i];
+	}
+	for (size_t i = 0; i < cantidad; i++) {
+		encabezado.largo_arena += strlen(claves[i]) + 1;
+		if (lugares[i] != UINT64_MAX) {
+			encabezado.primera_sobrante++;
+		}
+	}
+	size_t desde[SECCIONES];
+	size_t largo = ubicar_secciones(&encabezado, desde);
+	// con calloc el relleno entre secciones queda en cero en el archivo
+	char* bloque = calloc(1, largo);
+	bool ok = bloque != NULL;
+	if (ok) {
+		memcpy(bloque, &encabezado, sizeof(encabezado));
+		apuntar_secciones(congelado, bloque, largo);
+		congelado->mapeado = false;
+		ok = llenar_bloque(congelado, claves, datos, lugares, niveles, palabras_nivel);
+	}
+	for (int i = 0; i < cant_niveles; i++) {
+		free(niveles[i]);
+	}
+	free(lugares);
+	if (!ok) {
+		free(bloque);
+		free(congelado);
+		return NULL;
+	}
+	return congelado;
+}
+
+bool congelado_buscar(const congelado_t *congelado, const char *clave, size_t *posicion) {
+	const encabezado_t* encabezado = congelado->encabezado;
+	uint64_t h = hash64(clave);
+	// una clave guardada tiene apagados sus bits de los niveles anteriores
+	// al suyo: el primer bit prendido es el único candidato
+	for (size_t nivel = 0; nivel < encabezado->niveles; nivel++) {
+		uint64_t inicio = congelado->inicios[nivel];
+		uint64_t bit = inicio + bit_en_nivel(h, nivel, congelado->inicios[nivel + 1] - inicio);
+		if (bit_prendido(congelado->bits, bit)) {
+			size_t candidata = rango(congelado->bits, congelado->rangos, bit);
+			if (strcmp(congelado_clave(congelado, candidata), clave) != 0) {
+				return false;
+			}
+			*posicion = candidata;
+			return true;
+		}
+	}
+	size_t desde = (size_t)encabezado->primera_sobrante;
+	size_t hasta = (size_t)encabezado->cantidad;
+	while (desde < hasta) {
+		size_t medio = desde + (hasta - desde) / 2;
+		int comparacion = strcmp(clave, congelado_clave(congelado, medio));
+		if (comparacion == 0) {
+			*posicion = medio;
+			return true;
+		}
+		if (comparacion < 0) {
+			hasta = medio;
+		} else {
+			desde = medio + 1;
+		}
+	}
+	return false;
+}
+
+size_t congelado_cantidad(const congelado_t *congelado) {
+	return (size_t)congelado->encabezado->cantidad;
+}
+
+const char *congelado_clave(const congelado_t *congelado, size_t posicion) {
+	return congelado->arena + congelado->desplazamientos[posicion];
+}
+
+void *congelado_dato(const congelado_t *congelado, size_t posicion) {
+	return congelado->datos[posicion];
+}
+
+size_t congelado_bytes(const congelado_t *congelado) {
+	return congelado->largo;
+}
+
+void congelado_destruir(congelado_t *congelado) {
+	if (congelado->mapeado) {
+		munmap(congelado->bloque, congelado->largo);
+	} else {
+		free(congelado->bloque);
+	}
+	free(congelado);
+}
+
+
+/* ******************************************************************
+ *                    ARCHIVO MAPEADO
+ * *****************************************************************/
+
+bool congelado_escribir(const congelado_t *congelado, const char *ruta) {
+	char* temporal = malloc(strlen(ruta) + sizeof(".tmp"));
+	if (!temporal) {
+		return false;
+	}
+	sprintf(temporal, "%s.tmp", ruta);
+	FILE* archivo = fopen(temporal, "wb");
+	if (!archivo) {
+		free(temporal);
+		return false;
+	}
+	// el bloque ya tiene el formato del archivo
+	bool ok = fwrite(congelado->bloque, 1, congelado->largo, archivo) == congelado->largo;
+	ok = fclose(archivo) == 0 && ok;
+	ok = ok && rename(temporal, ruta) == 0;
+	if (!ok) {
+		remove(temporal);
+	}
+	free(temporal);
+	return ok;
+}
+
+/* Comprueba que las secciones del bloque mapeado sean coherentes entre sí,
+ * y lo que las búsquedas dan por cierto sin mirar: los rangos son los que
+ * salen de los bits (si no, la posición de una clave puede caer fuera de
+ * la tabla), hay un bit prendido por cada clave con nivel y cada clave
+ * está dentro de la arena y termina en '\0'.
+ */
+static bool secciones_validas(const congelado_t* congelado) {
+	const encabezado_t* encabezado = congelado->encabezado;
+	if (congelado->inicios[0] != 0 || congelado->inicios[encabezado->niveles] != encabezado->palabras * 64) {
+		return false;
+	}
+	for (size_t i = 0; i < encabezado->niveles; i++) {
+		if (congelado->inicios[i + 1] <= congelado->inicios[i]) {
+			return false;
+		}
+	}
+	uint64_t prendidos = 0;
+	for (size_t i = 0; i <= encabezado->palabras; i++) {
+		if (i % PALABRAS_POR_RANGO == 0 && congelado->rangos[i / PALABRAS_POR_RANGO] != prendidos) {
+			return false;
+		}
+		if (i < encabezado->palabras) {
+			prendidos += contar_unos(congelado->bits[i]);
+		}
+	}
+	if (prendidos != encabezado->primera_sobrante || congelado->desplazamientos[0] != 0
+			|| congelado->desplazamientos[encabezado->cantidad] != encabezado->largo_arena) {
+		return false;
+	}
+	// cada clave ocupa al menos su '\0', así que los desplazamientos crecen
+	for (size_t i = 0; i < encabezado->cantidad; i++) {
+		uint64_t fin = congelado->desplazamientos[i + 1];
+		if (fin <= congelado->desplazamientos[i] || fin > encabezado->largo_arena || congelado->arena[fin - 1] != '\0') {
+			return false;
+		}
+	}
+	return true;
+}
+
+congelado_t *congelado_mapear(const char *ruta) {
+	int fd = open(ruta, O_RDONLY);
+	if (fd < 0) {
+		return NULL;
+	}
+	struct stat estado;
+	if (fstat(fd, &estado) != 0 || (size_t)estado.st_size < sizeof(encabezado_t)) {
+		close(fd);
+		return NULL;
+	}
+	size_t largo = (size_t)estado.st_size;
+	char* mapa = mmap(NULL, largo, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapa == MAP_FAILED) {
+		return NULL;
+	}
+	// validarlo lo recorre de punta a punta; después se lee salteado
+	posix_madvise(mapa, largo, POSIX_MADV_SEQUENTIAL);
+
+	const encabezado_t* encabezado = (const encabezado_t*)mapa;
+	congelado_t* congelado = malloc(sizeof(congelado_t));
+	// los tamaños se acotan antes de multiplicarlos
+	bool valido = memcmp(encabezado->magia, MAGIA_ARCHIVO, sizeof(encabezado->magia)) == 0
+		&& encabezado->version == VERSION_ARCHIVO && encabezado->tam_dato == sizeof(void*)
+		&& encabezado->niveles <= MAX_NIVELES && encabezado->palabras <= largo
+		&& encabezado->cantidad <= largo && encabezado->largo_arena <= largo
+		&& encabezado->primera_sobrante <= encabezado->cantidad;
+	if (valido) {
+		size_t desde[SECCIONES];
+		valido = ubicar_secciones(encabezado, desde) == largo;
+	}
+	if (congelado && valido) {
+		apuntar_secciones(congelado, mapa, largo);
+		congelado->mapeado = true;
+		valido = secciones_validas(congelado);
+	}
+	if (!congelado || !valido) {
+		free(congelado);
+		munmap(mapa, largo);
+		return NULL;
+	}
+	// cada búsqueda lee unas pocas palabras sueltas
+	posix_madvise(mapa, largo, POSIX_MADV_RANDOM);
+	return congelado;
+}
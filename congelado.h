@@ -0,0 +1,62 @@
+#ifndef CONGELADO_H
+#define CONGELADO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Conjunto inmutable de pares (clave, dato) con una función de hash
+ * perfecta mínima: cada una de las n claves va a una posición distinta en
+ * [0, n), sin lugares vacíos. La función se arma por niveles de bits (a lo
+ * BBHash): cada nivel es un arreglo de bits del doble de las claves que le
+ * llegan, y una clave se queda en el primer nivel donde no choca con
+ * ninguna otra. La posición es la cantidad de bits prendidos antes del
+ * suyo. Las claves que chocan en todos los niveles quedan al final,
+ * ordenadas, y se buscan por bisección.
+ *
+ * Todo vive en un solo bloque con el mismo formato que el archivo, así que
+ * escribirlo es copiar el bloque y mapearlo es usar el archivo tal cual.
+ * El hash lo usa para hash_congelar.
+ */
+
+struct congelado;
+
+typedef struct congelado congelado_t;
+
+/* Arma el conjunto copiando las claves; los datos se guardan tal cual.
+ * Devuelve NULL si no hubo memoria.
+ * Pre: las claves son distintas.
+ */
+congelado_t *congelado_crear(const char **claves, void **datos, size_t cantidad);
+
+/* Busca la clave y deja su posición en posicion. Devuelve false si no está.
+ * Pre: el conjunto fue creado o mapeado.
+ */
+bool congelado_buscar(const congelado_t *congelado, const char *clave, size_t *posicion);
+
+// Devuelve la cantidad de claves.
+size_t congelado_cantidad(const congelado_t *congelado);
+
+// Devuelve la clave de la posición, con posicion < cantidad.
+const char *congelado_clave(const congelado_t *congelado, size_t posicion);
+
+// Devuelve el dato de la posición, con posicion < cantidad.
+void *congelado_dato(const congelado_t *congelado, size_t posicion);
+
+// Devuelve los bytes que ocupa el bloque.
+size_t congelado_bytes(const congelado_t *congelado);
+
+/* Escribe el conjunto en el archivo ruta. Devuelve false si no pudo; el
+ * archivo anterior, si había, queda intacto.
+ */
+bool congelado_escribir(const congelado_t *congelado, const char *ruta);
+
+/* Mapea el archivo escrito por congelado_escribir, de sólo lectura. Al
+ * abrirlo lo recorre una vez para validarlo: un archivo dañado no hace
+ * leer fuera del mapeo. Devuelve NULL si no existe o no es válido.
+ */
+congelado_t *congelado_mapear(const char *ruta);
+
+// Libera el conjunto (o deshace el mapeo). No toca los datos.
+void congelado_destruir(congelado_t *congelado);
+
+#endif // CONGELADO_H
@@ -0,0 +1,292 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <time.h>
+#include <pthread.h>
+#include "epoca.h"
+
+#define RETIRADOS_POR_BLOQUE 256
+#define TANDA_RECOLECCION 64 // se sacan de la cola de a tantos por vez
+#define TAM_LINEA_CACHE 64
+#define AFUERA UINT64_MAX
+
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+typedef struct retirado {
+	void* dato;
+	epoca_destruir_t destruir;
+	uint64_t epoca; // la global cuando se retiró
+} retirado_t;
+
+// Los retirados forman una cola de bloques; las épocas quedan en orden
+typedef struct bloque_retirados {
+	struct bloque_retirados* siguiente;
+	size_t inicio;
+	size_t fin;
+	retirado_t retirados[RETIRADOS_POR_BLOQUE];
+} bloque_retirados_t;
+
+/* Cada lector ocupa su propia línea de cache: entrar y salir sólo escriben
+ * ahí. Los lectores no se sacan de la lista hasta epoca_destruir, así el
+ * recolector la puede recorrer sin lock.
+ */
+struct epoca_lector {
+	_Atomic uint64_t epoca; // la global al entrar, o AFUERA
+	atomic_bool libre;
+	struct epoca_lector* siguiente;
+	epoca_t* recolector;
+	char relleno[TAM_LINEA_CACHE];
+};
+
+struct epoca {
+	_Atomic uint64_t global;
+	_Atomic(epoca_lector_t*) lectores;
+	pthread_mutex_t mutex; // de la cola y el alta de lectores
+	bloque_retirados_t* primero;
+	bloque_retirados_t* ultimo;
+	atomic_size_t pendientes;
+
+	// hilo recolector
+	bool con_hilo;
+	bool terminar;
+	pthread_t hilo;
+	pthread_cond_t despertar;
+	size_t presupuesto_hilo;
+	unsigned milisegundos;
+};
+
+
+/* ******************************************************************
+ *                    FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+/* La menor época de los lectores que están adentro. Un retirado con época
+ * menor ya no estaba alcanzable cuando entraron todos ellos.
+ */
+static uint64_t minima_adentro(const epoca_t* epoca) {
+	atomic_thread_fence(memory_order_seq_cst);
+	uint64_t minima = AFUERA;
+	epoca_lector_t* lector = atomic_load_explicit(&((epoca_t*)epoca)->lectores, memory_order_acquire);
+	for (; lector; lector = lector->siguiente) {
+		uint64_t suya = atomic_load(&lector->epoca);
+		if (suya < minima) {
+			minima = suya;
+		}
+	}
+	return minima;
+}
+
+static void esperar_lectores(epoca_t* epoca, uint64_t hasta) {
+	while (minima_adentro(epoca) <= hasta) {
+		sched_yield();
+	}
+}
+
+//saca de la cola hasta cantidad retirados con época menor que limite
+static size_t sacar_destruibles(epoca_t* epoca, uint64_t limite, retirado_t* tanda, size_t cantidad) {
+	size_t sacados = 0;
+	while (sacados < cantidad && epoca->primero) {
+		bloque_retirados_t* bloque = epoca->primero;
+		if (bloque->inicio == bloque->fin) {
+			if (bloque == epoca->ultimo) {
+				break;
+			}
+			epoca->primero = bloque->siguiente;
+			free(bloque);
+			continue;
+		}
+		if (bloque->retirados[bloque->inicio].epoca >= limite) {
+			break;
+		}
+		tanda[sacados++] = bloque->retirados[bloque->inicio++];
+	}
+	return sacados;
+}
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL RECOLECTOR
+ * *****************************************************************/
+
+epoca_t *epoca_crear(void) {
+	epoca_t* epoca = malloc(sizeof(epoca_t));
+	if (!epoca) {
+		return NULL;
+	}
+	atomic_init(&epoca->global, 0);
+	atomic_init(&epoca->lectores, NULL);
+	atomic_init(&epoca->pendientes, 0);
+	pthread_mutex_init(&epoca->mutex, NULL);
+	pthread_cond_init(&epoca->despertar, NULL);
+	epoca->primero = NULL;
+	epoca->ultimo = NULL;
+	epoca->con_hilo = false;
+	epoca->terminar = false;
+	return epoca;
+}
+
+void epoca_retirar(epoca_t *epoca, void *dato, epoca_destruir_t destruir) {
+	// el dato ya no es alcanzable: un lector que lea esta época o una
+	// posterior no pudo haberlo visto
+	uint64_t actual = atomic_load(&epoca->global);
+	pthread_mutex_lock(&epoca->mutex);
+	bloque_retirados_t* ultimo = epoca->ultimo;
+	if (!ultimo || ultimo->fin == RETIRADOS_POR_BLOQUE) {
+		bloque_retirados_t* nuevo = malloc(sizeof(bloque_retirados_t));
+		if (!nuevo) {
+			pthread_mutex_unlock(&epoca->mutex);
+			atomic_fetch_add(&epoca->global, 1);
+			esperar_lectores(epoca, actual);
+			destruir(dato);
+			return;
+		}
+		nuevo->siguiente = NULL;
+		nuevo->inicio = 0;
+		nuevo->fin = 0;
+		if (ultimo) {
+			ultimo->siguiente = nuevo;
+		} else {
+			epoca->primero = nuevo;
+		}
+		epoca->ultimo = ultimo = nuevo;
+	}
+	ultimo->retirados[ultimo->fin++] = (retirado_t){dato, destruir, actual};
+	atomic_fetch_add_explicit(&epoca->pendientes, 1, memory_order_relaxed);
+	pthread_mutex_unlock(&epoca->mutex);
+}
+
+/* Avanza la época global antes de mirar a los lectores: los que entren
+ * desde ahora leen una época mayor que la de todo lo ya retirado.
+ */
+size_t epoca_recolectar(epoca_t *epoca, size_t presupuesto) {
+	atomic_fetch_add(&epoca->global, 1);
+	uint64_t limite = minima_adentro(epoca);
+	uint64_t global = atomic_load(&epoca->global);
+	if (limite > global) {
+		limite = global;
+	}
+	retirado_t tanda[TANDA_RECOLECCION];
+	size_t destruidos = 0;
+	while (destruidos < presupuesto) {
+		size_t pedir = presupuesto - destruidos < TANDA_RECOLECCION ? presupuesto - destruidos : TANDA_RECOLECCION;
+		pthread_mutex_lock(&epoca->mutex);
+		size_t sacados = sacar_destruibles(epoca, limite, tanda, pedir);
+		pthread_mutex_unlock(&epoca->mutex);
+		if (sacados == 0) {
+			break;
+		}
+		// se destruyen sin el lock, así retirar no espera a destruir
+		for (size_t i = 0; i < sacados; i++) {
+			tanda[i].destruir(tanda[i].dato);
+		}
+		atomic_fetch_sub_explicit(&epoca->pendientes, sacados, memory_order_relaxed);
+		destruidos += sacados;
+	}
+	return destruidos;
+}
+
+size_t epoca_pendientes(const epoca_t *epoca) {
+	return atomic_load_explicit(&((epoca_t*)epoca)->pendientes, memory_order_relaxed);
+}
+
+static void* recolectar_siempre(void* extra) {
+	epoca_t* epoca = extra;
+	pthread_mutex_lock(&epoca->mutex);
+	while (!epoca->terminar) {
+		pthread_mutex_unlock(&epoca->mutex);
+		size_t destruidos = epoca_recolectar(epoca, epoca->presupuesto_hilo);
+		pthread_mutex_lock(&epoca->mutex);
+		if (destruidos < epoca->presupuesto_hilo && !epoca->terminar) {
+			struct timespec hasta;
+			clock_gettime(CLOCK_REALTIME, &hasta);
+			hasta.tv_nsec += (long)(epoca->milisegundos % 1000) * 1000000;
+			hasta.tv_sec += epoca->milisegundos / 1000 + hasta.tv_nsec / 1000000000;
+			hasta.tv_nsec %= 1000000000;
+			pthread_cond_timedwait(&epoca->despertar, &epoca->mutex, &hasta);
+		}
+	}
+	pthread_mutex_unlock(&epoca->mutex);
+	return NULL;
+}
+
+bool epoca_recolectar_en_hilo(epoca_t *epoca, size_t presupuesto, unsigned milisegundos) {
+	pthread_mutex_lock(&epoca->mutex);
+	bool lanzado = false;
+	if (!epoca->con_hilo && presupuesto > 0) {
+		epoca->presupuesto_hilo = presupuesto;
+		epoca->milisegundos = milisegundos;
+		epoca->terminar = false;
+		lanzado = pthread_create(&epoca->hilo, NULL, recolectar_siempre, epoca) == 0;
+		epoca->con_hilo = lanzado;
+	}
+	pthread_mutex_unlock(&epoca->mutex);
+	return lanzado;
+}
+
+epoca_lector_t *epoca_lector_crear(epoca_t *epoca) {
+	pthread_mutex_lock(&epoca->mutex);
+	epoca_lector_t* lector = atomic_load_explicit(&epoca->lectores, memory_order_relaxed);
+	while (lector && !atomic_load(&lector->libre)) {
+		lector = lector->siguiente;
+	}
+	if (lector) {
+		atomic_store(&lector->libre, false);
+	} else if ((lector = malloc(sizeof(epoca_lector_t)))) {
+		atomic_init(&lector->epoca, AFUERA);
+		atomic_init(&lector->libre, false);
+		lector->recolector = epoca;
+		lector->siguiente = atomic_load_explicit(&epoca->lectores, memory_order_relaxed);
+		atomic_store_explicit(&epoca->lectores, lector, memory_order_release);
+	}
+	pthread_mutex_unlock(&epoca->mutex);
+	return lector;
+}
+
+/* Anotar la época tiene que verse antes que cualquier lectura de datos: si
+ * el recolector no llega a verla, esas lecturas son posteriores a su mirada
+ * y ya no alcanzan lo que retiró antes.
+ */
+void epoca_entrar(epoca_lector_t *lector) {
+	atomic_store(&lector->epoca, atomic_load(&lector->recolector->global));
+	atomic_thread_fence(memory_order_seq_cst);
+}
+
+void epoca_salir(epoca_lector_t *lector) {
+	atomic_store_explicit(&lector->epoca, AFUERA, memory_order_release);
+}
+
+void epoca_lector_destruir(epoca_lector_t *lector) {
+	atomic_store(&lector->libre, true);
+}
+
+void epoca_destruir(epoca_t *epoca) {
+	pthread_mutex_lock(&epoca->mutex);
+	epoca->terminar = true;
+	pthread_cond_signal(&epoca->despertar);
+	pthread_mutex_unlock(&epoca->mutex);
+	if (epoca->con_hilo) {
+		pthread_join(epoca->hilo, NULL);
+	}
+	while (epoca->primero) {
+		bloque_retirados_t* bloque = epoca->primero;
+		for (size_t i = bloque->inicio; i < bloque->fin; i++) {
+			bloque->retirados[i].destruir(bloque->retirados[i].dato);
+		}
+		epoca->primero = bloque->siguiente;
+		free(bloque);
+	}
+	epoca_lector_t* lector = atomic_load(&epoca->lectores);
+	while (lector) {
+		epoca_lector_t* siguiente = lector->siguiente;
+		free(lector);
+		lector = siguiente;
+	}
+	pthread_cond_destroy(&epoca->despertar);
+	pthread_mutex_destroy(&epoca->mutex);
+	free(epoca);
+}
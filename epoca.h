@@ -0,0 +1,77 @@
+#ifndef EPOCA_H
+#define EPOCA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Destrucción diferida por épocas. En lugar de destruir un dato en el
+ * momento, se lo retira: queda en una cola marcado con la época actual y
+ * se destruye después, de a tandas acotadas, con epoca_recolectar o desde
+ * un hilo aparte. Así borrar un dato caro de destruir (un árbol grande) no
+ * frena al que borra.
+ *
+ * Además protege a los lectores concurrentes: un hilo que va a usar datos
+ * que otro puede retirar se registra y encierra cada uso entre epoca_entrar
+ * y epoca_salir. Un dato retirado no se destruye mientras haya un lector
+ * que entró antes de que se retirara.
+ *
+ * Todas las primitivas pueden llamarse desde varios hilos a la vez, salvo
+ * epoca_destruir.
+ */
+
+struct epoca;
+struct epoca_lector;
+
+typedef struct epoca epoca_t;
+typedef struct epoca_lector epoca_lector_t;
+
+typedef void (*epoca_destruir_t)(void *);
+
+/* Crea el recolector, o devuelve NULL si no hubo memoria.
+ */
+epoca_t *epoca_crear(void);
+
+/* Deja dato para que se destruya con destruir cuando ningún lector pueda
+ * estar usándolo. Si no hay memoria para encolarlo, espera a los lectores
+ * y lo destruye en el momento.
+ * Pre: dato ya no es alcanzable para los lectores que entren desde ahora;
+ * el hilo que retira no está adentro.
+ */
+void epoca_retirar(epoca_t *epoca, void *dato, epoca_destruir_t destruir);
+
+/* Destruye hasta presupuesto datos retirados que ya no puede estar usando
+ * ningún lector, empezando por los más viejos. Devuelve cuántos destruyó.
+ */
+size_t epoca_recolectar(epoca_t *epoca, size_t presupuesto);
+
+// Devuelve la cantidad de datos retirados que todavía no se destruyeron.
+size_t epoca_pendientes(const epoca_t *epoca);
+
+/* Lanza un hilo que recolecta de a presupuesto datos y, cuando no quedan
+ * destruibles, duerme milisegundos antes de volver a mirar. Devuelve false
+ * si no pudo lanzarlo o si ya había uno.
+ */
+bool epoca_recolectar_en_hilo(epoca_t *epoca, size_t presupuesto, unsigned milisegundos);
+
+/* Registra un lector, reusando el de un hilo que ya lo devolvió si hay.
+ * Devuelve NULL si no hubo memoria. Cada lector lo usa un solo hilo.
+ */
+epoca_lector_t *epoca_lector_crear(epoca_t *epoca);
+
+/* Marca el comienzo y el fin de un uso de datos que pueden retirarse. No
+ * se anidan.
+ */
+void epoca_entrar(epoca_lector_t *lector);
+void epoca_salir(epoca_lector_t *lector);
+
+// Devuelve el registro para que lo reuse otro hilo.
+// Pre: el lector está afuera.
+void epoca_lector_destruir(epoca_lector_t *lector);
+
+/* Detiene el hilo recolector, si hay, destruye todos los datos pendientes
+ * y libera el recolector y sus lectores.
+ * Pre: ningún hilo está usando el recolector ni está adentro.
+ */
+void epoca_destruir(epoca_t *epoca);
+
+#endif // EPOCA_H
@@ -0,0 +1,397 @@
+/*
+ * fuzz_hash.c
+ * Prueba diferencial del hash: interpreta una secuencia de bytes como
+ * operaciones (guardar, borrar, obtener, pertenece, iterar, llenar y vaciar
+ * de golpe para forzar redimensiones en los dos sentidos) y compara cada
+ * resultado contra un diccionario de referencia, un arreglo ordenado con
+ * búsqueda binaria. Ante la primera diferencia imprime la operación y
+ * llama a abort(), así los fuzzers la registran como falla. Los datos son
+ * enteros pedidos con malloc que el hash destruye, para que ASan vea tanto
+ * las pérdidas como los datos liberados de más.
+ *
+ * Sin fuzzer (genera operaciones al azar; con archivos, corre cada uno):
+ *   gcc -std=c99 -g -O1 -fsanitize=address,undefined -pthread fuzz_hash.c hash.c indice.c congelado.c epoca.c -lm -o fuzz_hash
+ *   ./fuzz_hash [semilla] [rondas]
+ *   ./fuzz_hash archivo...
+ * Con AFL (lee la entrada de un archivo o de la entrada estándar):
+ *   afl-clang-fast -std=c99 -pthread fuzz_hash.c hash.c indice.c congelado.c epoca.c -lm -o fuzz_hash
+ *   afl-fuzz -i entradas -o hallazgos ./fuzz_hash @@
+ * Con libFuzzer:
+ *   clang -std=c99 -g -DFUZZ_LIBFUZZER -fsanitize=fuzzer,address,undefined -pthread fuzz_hash.c hash.c indice.c congelado.c epoca.c -lm -o fuzz_hash
+ *   ./fuzz_hash
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "hash.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_CLAVE 32
+#define MAX_LLENAR 4096
+#define RONDAS_DEFECTO 2000
+#define LARGO_RONDA 4096
+#define MAX_ENTRADA (1 << 20)
+
+
+/* ******************************************************************
+ *                    DICCIONARIO DE REFERENCIA
+ * *****************************************************************/
+
+typedef struct par {
+    char* clave;
+    int valor;
+} par_t;
+
+typedef struct referencia {
+    par_t* pares; // ordenados por clave
+    size_t cantidad;
+    size_t capacidad;
+} referencia_t;
+
+// Devuelve la posición de la clave o, si no está, dónde habría que insertarla
+static size_t ref_buscar(const referencia_t* ref, const char* clave, bool* esta)
+{
+    size_t desde = 0, hasta = ref->cantidad;
+    while (desde < hasta) {
+        size_t medio = desde + (hasta - desde) / 2;
+        int comparacion = strcmp(clave, ref->pares[medio].clave);
+        if (comparacion == 0) {
+            *esta = true;
+            return medio;
+        }
+        if (comparacion < 0) hasta = medio;
+        else desde = medio + 1;
+    }
+    *esta = false;
+    return desde;
+}
+
+static void ref_guardar(referencia_t* ref, const char* clave, int valor)
+{
+    bool esta;
+    size_t pos = ref_buscar(ref, clave, &esta);
+    if (esta) {
+        ref->pares[pos].valor = valor;
+        return;
+    }
+    if (ref->cantidad == ref->capacidad) {
+        ref->capacidad = ref->capacidad ? 2 * ref->capacidad : 64;
+        ref->pares = realloc(ref->pares, ref->capacidad * sizeof(par_t));
+        if (!ref->pares) abort();
+    }
+    memmove(&ref->pares[pos + 1], &ref->pares[pos], (ref->cantidad - pos) * sizeof(par_t));
+    ref->pares[pos].clave = strdup(clave);
+    ref->pares[pos].valor = valor;
+    ref->cantidad++;
+}
+
+static bool ref_borrar(referencia_t* ref, const char* clave, int* valor)
+{
+    bool esta;
+    size_t pos = ref_buscar(ref, clave, &esta);
+    if (!esta) return false;
+    *valor = ref->pares[pos].valor;
+    free(ref->pares[pos].clave);
+    memmove(&ref->pares[pos], &ref->pares[pos + 1], (ref->cantidad - pos - 1) * sizeof(par_t));
+    ref->cantidad--;
+    return true;
+}
+
+static void ref_destruir(referencia_t* ref)
+{
+    for (size_t i = 0; i < ref->cantidad; i++) free(ref->pares[i].clave);
+    free(ref->pares);
+}
+
+
+/* ******************************************************************
+ *                    INTERPRETE DE OPERACIONES
+ * *****************************************************************/
+
+typedef struct flujo {
+    const uint8_t* datos;
+    size_t largo;
+    size_t pos;
+} flujo_t;
+
+// Pasada la entrada devuelve ceros: toda entrada es válida
+static uint8_t leer_byte(flujo_t* flujo)
+{
+    return flujo->pos < flujo->largo ? flujo->datos[flujo->pos++] : 0;
+}
+
+/* Las claves "c<n>" se repiten mucho, así hay reemplazos y borrados de
+ * claves presentes; las crudas prueban textos arbitrarios, incluida la
+ * clave vacía.
+ */
+static void leer_clave(flujo_t* flujo, char clave[MAX_CLAVE])
+{
+    uint8_t b = leer_byte(flujo);
+    if (!(b & 0x80)) {
+        sprintf(clave, "c%u", (unsigned)(b & 0x7f));
+        return;
+    }
+    size_t largo = b & 0x0f;
+    for (size_t i = 0; i < largo; i++) {
+        uint8_t c = leer_byte(flujo);
+        clave[i] = (char)(c ? c : 1);
+    }
+    clave[largo] = '\0';
+}
+
+static void fallar(const char* operacion, const char* clave, size_t paso)
+{
+    fprintf(stderr, "diferencia en el paso %zu: %s(\"%s\")\n", paso, operacion, clave ? clave : "");
+    abort();
+}
+
+/* Asignador que falla uno de cada cada pedidos, para recorrer los caminos
+ * de falta de memoria (redimensiones a medio hacer, bloques de desborde).
+ */
+typedef struct fallas {
+    size_t cada;
+    size_t pedidos;
+} fallas_t;
+
+static void* pedir_con_fallas(size_t tam, size_t alineacion, void* contexto)
+{
+    fallas_t* fallas = contexto;
+    if (fallas->cada && ++fallas->pedidos % fallas->cada == 0) return NULL;
+    void* memoria;
+    if (alineacion < sizeof(void*)) alineacion = sizeof(void*);
+    return posix_memalign(&memoria, alineacion, tam) == 0 ? memoria : NULL;
+}
+
+static void liberar_con_fallas(void* memoria, size_t tam, void* contexto)
+{
+    (void)tam;
+    (void)contexto;
+    free(memoria);
+}
+
+typedef struct prueba {
+    hash_t* hash;
+    referencia_t ref;
+    bool ordenado;  // el hash se creó con hash_crear_ordenado
+    fallas_t fallas;
+    size_t paso;
+} prueba_t;
+
+static int* nuevo_valor(int valor)
+{
+    int* dato = malloc(sizeof(int));
+    if (!dato) abort();
+    *dato = valor;
+    return dato;
+}
+
+static int comparar_textos(const void* a, const void* b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/* El iterador tiene que dar cada clave de la referencia exactamente una
+ * vez; el ordenado, además, en el orden de la referencia.
+ */
+static void verificar_iteracion(const prueba_t* prueba, bool en_orden)
+{
+    const referencia_t* ref = &prueba->ref;
+    char** vistas = malloc((ref->cantidad + 1) * sizeof(char*));
+    hash_iter_t* iter = en_orden ? hash_iter_crear_ordenado(prueba->hash) : hash_iter_crear(prueba->hash);
+    if (!vistas || !iter) abort();
+    size_t cantidad = 0;
+    for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)) {
+        if (cantidad == ref->cantidad) fallar("iterar (sobran claves)", NULL, prueba->paso);
+        vistas[cantidad++] = (char*)hash_iter_ver_actual(iter);
+    }
+    if (hash_iter_avanzar(iter) || hash_iter_ver_actual(iter)) fallar("iterar (despues del final)", NULL, prueba->paso);
+    if (cantidad != ref->cantidad) fallar("iterar (faltan claves)", NULL, prueba->paso);
+    if (!en_orden) qsort(vistas, cantidad, sizeof(char*), comparar_textos);
+    for (size_t i = 0; i < cantidad; i++) {
+        if (strcmp(vistas[i], ref->pares[i].clave) != 0) fallar("iterar", vistas[i], prueba->paso);
+    }
+    hash_iter_destruir(iter);
+    free(vistas);
+}
+
+// Sin memoria guardar puede fallar, pero entonces el hash queda como estaba
+static void verificar_guardar(prueba_t* prueba, const char* clave, int valor)
+{
+    int* dato = nuevo_valor(valor);
+    if (hash_guardar(prueba->hash, clave, dato)) {
+        ref_guardar(&prueba->ref, clave, valor);
+        return;
+    }
+    if (!prueba->fallas.cada) fallar("guardar", clave, prueba->paso);
+    free(dato);
+}
+
+static void verificar_borrar(prueba_t* prueba, const char* clave)
+{
+    int esperado;
+    bool estaba = ref_borrar(&prueba->ref, clave, &esperado);
+    int* dato = hash_borrar(prueba->hash, clave);
+    if (estaba != (dato != NULL) || (dato && *dato != esperado)) fallar("borrar", clave, prueba->paso);
+    free(dato);
+}
+
+static void verificar_obtener(const prueba_t* prueba, const char* clave)
+{
+    bool esta;
+    size_t pos = ref_buscar(&prueba->ref, clave, &esta);
+    const int* dato = hash_obtener(prueba->hash, clave);
+    if (esta != (dato != NULL) || (dato && *dato != prueba->ref.pares[pos].valor)) fallar("obtener", clave, prueba->paso);
+    if (hash_pertenece(prueba->hash, clave) != esta) fallar("pertenece", clave, prueba->paso);
+}
+
+/* Corre las operaciones de la entrada sobre un hash nuevo. El primer byte
+ * elige el hash: ordenado, con fallas de memoria cada tantos pedidos o
+ * común. Después cada operación es un byte seguido de sus argumentos.
+ */
+static void ejecutar(const uint8_t* datos, size_t largo)
+{
+    flujo_t flujo = {datos, largo, 0};
+    uint8_t modo = leer_byte(&flujo);
+    prueba_t prueba = {.hash = NULL, .ref = {NULL, 0, 0}, .ordenado = modo % 4 == 1};
+    if (prueba.ordenado) {
+        prueba.hash = hash_crear_ordenado(free);
+    } else if (modo % 4 == 2) {
+        hash_asignador_t asignador = {pedir_con_fallas, liberar_con_fallas, &prueba.fallas};
+        prueba.hash = hash_crear_con_asignador(free, &asignador);
+        prueba.fallas.cada = 2 + modo / 4;
+    } else {
+        prueba.hash = hash_crear(free);
+    }
+    if (!prueba.hash) abort();
+    char clave[MAX_CLAVE];
+
+    for (; flujo.pos < flujo.largo; prueba.paso++) {
+        uint8_t operacion = leer_byte(&flujo);
+        switch (operacion % 8) {
+        case 0:
+        case 1:
+            leer_clave(&flujo, clave);
+            verificar_guardar(&prueba, clave, (int)prueba.paso);
+            break;
+        case 2:
+        case 3:
+            leer_clave(&flujo, clave);
+            verificar_borrar(&prueba, clave);
+            break;
+        case 4:
+        case 5:
+            leer_clave(&flujo, clave);
+            verificar_obtener(&prueba, clave);
+            break;
+        case 6:
+            verificar_iteracion(&prueba, prueba.ordenado && (operacion & 0x80));
+            break;
+        default:
+            // llenar o vaciar de golpe: hace crecer o achicar la tabla varias veces
+            if (operacion & 0x80) {
+                size_t cantidad = (size_t)(leer_byte(&flujo) + 1) * MAX_LLENAR / 256;
+                for (size_t i = 0; i < cantidad; i++) {
+                    sprintf(clave, "m%zu", i);
+                    verificar_guardar(&prueba, clave, (int)i);
+                }
+            } else {
+                while (prueba.ref.cantidad > 0) {
+                    char* ultima = strdup(prueba.ref.pares[prueba.ref.cantidad - 1].clave);
+                    verificar_borrar(&prueba, ultima);
+                    free(ultima);
+                }
+            }
+            break;
+        }
+        if (hash_cantidad(prueba.hash) != prueba.ref.cantidad) fallar("cantidad", NULL, prueba.paso);
+    }
+    verificar_iteracion(&prueba, false);
+    if (prueba.ordenado) verificar_iteracion(&prueba, true);
+    for (size_t i = 0; i < prueba.ref.cantidad; i++) {
+        verificar_obtener(&prueba, prueba.ref.pares[i].clave);
+    }
+    hash_destruir(prueba.hash);
+    ref_destruir(&prueba.ref);
+}
+
+
+/* ******************************************************************
+ *                        PROGRAMA PRINCIPAL
+ * *****************************************************************/
+
+int LLVMFuzzerTestOneInput(const uint8_t* datos, size_t largo);
+
+int LLVMFuzzerTestOneInput(const uint8_t* datos, size_t largo)
+{
+    ejecutar(datos, largo);
+    return 0;
+}
+
+#ifndef FUZZ_LIBFUZZER
+static uint64_t siguiente_azar(uint64_t* estado)
+{
+    // xorshift64*
+    *estado ^= *estado >> 12;
+    *estado ^= *estado << 25;
+    *estado ^= *estado >> 27;
+    return *estado * UINT64_C(2685821657736338717);
+}
+
+static bool es_numero(const char* texto)
+{
+    if (!*texto) return false;
+    for (; *texto; texto++) {
+        if (*texto < '0' || *texto > '9') return false;
+    }
+    return true;
+}
+
+static void correr_archivo(FILE* archivo, uint8_t* buffer)
+{
+    size_t largo = fread(buffer, 1, MAX_ENTRADA, archivo);
+    ejecutar(buffer, largo);
+}
+
+int main(int argc, char *argv[])
+{
+    uint8_t* buffer = malloc(MAX_ENTRADA);
+    if (!buffer) return 1;
+
+    // con archivos (o "-" para la entrada estándar) se reproduce cada uno
+    if (argc > 1 && !es_numero(argv[1])) {
+        for (int i = 1; i < argc; i++) {
+            FILE* archivo = strcmp(argv[i], "-") == 0 ? stdin : fopen(argv[i], "rb");
+            if (!archivo) {
+                fprintf(stderr, "no se pudo abrir %s\n", argv[i]);
+                free(buffer);
+                return 1;
+            }
+            correr_archivo(archivo, buffer);
+            if (archivo != stdin) fclose(archivo);
+        }
+        free(buffer);
+        return 0;
+    }
+
+    uint64_t semilla = argc > 1 ? strtoull(argv[1], NULL, 10) : 1;
+    size_t rondas = argc > 2 ? (size_t)strtoull(argv[2], NULL, 10) : RONDAS_DEFECTO;
+    uint64_t estado = semilla ? semilla : 1;
+    for (size_t ronda = 0; ronda < rondas; ronda++) {
+        // rondas de largo variable, con pocas operaciones de llenado
+        size_t largo = 1 + siguiente_azar(&estado) % LARGO_RONDA;
+        for (size_t i = 0; i < largo; i++) {
+            uint8_t byte = (uint8_t)siguiente_azar(&estado);
+            if (byte % 8 == 7 && siguiente_azar(&estado) % 16 != 0) byte--;
+            buffer[i] = byte;
+        }
+        ejecutar(buffer, largo);
+    }
+    printf("%zu rondas sin diferencias (semilla %llu)\n", rondas, (unsigned long long)semilla);
+    free(buffer);
+    return 0;
+}
+#endif
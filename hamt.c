@@ -0,0 +1,560 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hamt.h"
+
+#define BITS_POR_NIVEL 5
+#define MASCARA_NIVEL 0x1f
+#define BITS_HASH 32
+// 7 niveles consumen los 32 bits del hash, el octavo es de colisiones
+#define PROFUNDIDAD_MAX 8
+
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+typedef struct entrada {
+	atomic_size_t refs;
+	char* clave;
+	void* dato;
+	uint32_t hash;
+} entrada_t;
+
+/* Cada nodo tiene dos mapas de bits de 32 posiciones: mapa_datos marca las
+ * posiciones que guardan una entrada y mapa_hijos las que apuntan a un
+ * subnodo. En hijos[] van primero las entradas y después los subnodos, y la
+ * posición de cada uno es la cantidad de bits prendidos a su derecha.
+ * Los nodos de colisión (colisiones > 0) sólo tienen entradas, todas con el
+ * mismo hash. Un nodo es dueño de una referencia a cada cosa que apunta.
+ */
+typedef struct nodo {
+	atomic_size_t refs;
+	uint32_t mapa_datos;
+	uint32_t mapa_hijos;
+	uint32_t colisiones;
+	void* hijos[];
+} nodo_t;
+
+struct hamt {
+	nodo_t* raiz;
+	size_t cantidad;
+	hash_destruir_dato_t destruir_dato;
+};
+
+struct hamt_iter {
+	const hamt_t* hamt;
+	nodo_t* pila[PROFUNDIDAD_MAX];
+	size_t pos[PROFUNDIDAD_MAX];
+	int nivel;
+	entrada_t* actual;
+};
+
+typedef enum {
+	NO_ESTABA,
+	BORRADA,
+	SIN_MEMORIA,
+} resultado_borrar_t;
+
+
+/* ******************************************************************
+ *                      ENTRADAS Y NODOS
+ * *****************************************************************/
+
+static entrada_t* entrada_crear(const char* clave, void* dato, uint32_t hash) {
+	entrada_t* entrada = malloc(sizeof(entrada_t));
+	if (!entrada) {
+		return NULL;
+	}
+	size_t largo = strlen(clave) + 1;
+	entrada->clave = malloc(largo);
+	if (!entrada->clave) {
+		free(entrada);
+		return NULL;
+	}
+	memcpy(entrada->clave, clave, largo);
+	atomic_init(&entrada->refs, 1);
+	entrada->dato = dato;
+	entrada->hash = hash;
+	return entrada;
+}
+
+static entrada_t* entrada_ref(entrada_t* entrada) {
+	atomic_fetch_add(&entrada->refs, 1);
+	return entrada;
+}
+
+static void entrada_liberar(entrada_t* entrada, hash_destruir_dato_t destruir_dato) {
+	if (atomic_fetch_sub(&entrada->refs, 1) != 1) {
+		return;
+	}
+	if (destruir_dato) {
+		destruir_dato(entrada->dato);
+	}
+	free(entrada->clave);
+	free(entrada);
+}
+
+static bool entrada_es(const entrada_t* entrada, const char* clave, uint32_t hash) {
+	return entrada->hash == hash && strcmp(entrada->clave, clave) == 0;
+}
+
+static unsigned contar_bits(uint32_t mapa) {
+	return (unsigned)__builtin_popcount(mapa);
+}
+
+static uint32_t bit_de(uint32_t hash, unsigned desplazamiento) {
+	return (uint32_t)1 << ((hash >> desplazamiento) & MASCARA_NIVEL);
+}
+
+static unsigned indice_de(uint32_t mapa, uint32_t bit) {
+	return contar_bits(mapa & (bit - 1));
+}
+
+static unsigned cantidad_entradas(const nodo_t* nodo) {
+	return nodo->colisiones ? nodo->colisiones : contar_bits(nodo->mapa_datos);
+}
+
+static unsigned cantidad_subnodos(const nodo_t* nodo) {
+	return contar_bits(nodo->mapa_hijos);
+}
+
+static entrada_t** entradas(nodo_t* nodo) {
+	return (entrada_t**)nodo->hijos;
+}
+
+static nodo_t** subnodos(nodo_t* nodo) {
+	return (nodo_t**)(nodo->hijos + cantidad_entradas(nodo));
+}
+
+static nodo_t* nodo_crear(uint32_t mapa_datos, uint32_t mapa_hijos, uint32_t colisiones) {
+	size_t total = (colisiones ? colisiones : contar_bits(mapa_datos)) + contar_bits(mapa_hijos);
+	nodo_t* nodo = malloc(sizeof(nodo_t) + total * sizeof(void*));
+	if (!nodo) {
+		return NULL;
+	}
+	atomic_init(&nodo->refs, 1);
+	nodo->mapa_datos = mapa_datos;
+	nodo->mapa_hijos = mapa_hijos;
+	nodo->colisiones = colisiones;
+	return nodo;
+}
+
+static nodo_t* nodo_ref(nodo_t* nodo) {
+	atomic_fetch_add(&nodo->refs, 1);
+	return nodo;
+}
+
+static void nodo_liberar(nodo_t* nodo, hash_destruir_dato_t destruir_dato) {
+	if (atomic_fetch_sub(&nodo->refs, 1) != 1) {
+		return;
+	}
+	unsigned n_entradas = cantidad_entradas(nodo);
+	unsigned n_subnodos = cantidad_subnodos(nodo);
+	for (unsigned i = 0; i < n_entradas; i++) {
+		entrada_liberar(entradas(nodo)[i], destruir_dato);
+	}
+	for (unsigned i = 0; i < n_subnodos; i++) {
+		nodo_liberar(subnodos(nodo)[i], destruir_dato);
+	}
+	free(nodo);
+}
+
+/* Copia entradas y subnodos de origen a destino salteando las posiciones
+ * saltear_entrada/saltear_subnodo (usar -1 para no saltear) y dejando un hueco
+ * en hueco_entrada/hueco_subnodo. Suma una referencia a todo lo copiado.
+ */
+static void copiar_hijos(nodo_t* destino, nodo_t* origen, int saltear_entrada, int hueco_entrada, int saltear_subnodo, int hueco_subnodo) {
+	unsigned n_entradas = cantidad_entradas(origen);
+	unsigned n_subnodos = cantidad_subnodos(origen);
+	int j = 0;
+	for (int i = 0; i < (int)n_entradas; i++) {
+		if (j == hueco_entrada) {
+			j++;
+		}
+		if (i == saltear_entrada) {
+			continue;
+		}
+		entradas(destino)[j++] = entrada_ref(entradas(origen)[i]);
+	}
+	j = 0;
+	for (int i = 0; i < (int)n_subnodos; i++) {
+		if (j == hueco_subnodo) {
+			j++;
+		}
+		if (i == saltear_subnodo) {
+			continue;
+		}
+		subnodos(destino)[j++] = nodo_ref(subnodos(origen)[i]);
+	}
+}
+
+
+/* ******************************************************************
+ *                      OPERACIONES SOBRE NODOS
+ * *****************************************************************/
+
+// Arma el subárbol mínimo que separa dos entradas con distinta clave
+static nodo_t* fusionar(entrada_t* a, entrada_t* b, unsigned desplazamiento) {
+	if (desplazamiento >= BITS_HASH) {
+		nodo_t* nodo = nodo_crear(0, 0, 2);
+		if (nodo) {
+			entradas(nodo)[0] = entrada_ref(a);
+			entradas(nodo)[1] = entrada_ref(b);
+		}
+		return nodo;
+	}
+	uint32_t bit_a = bit_de(a->hash, desplazamiento);
+	uint32_t bit_b = bit_de(b->hash, desplazamiento);
+	if (bit_a != bit_b) {
+		nodo_t* nodo = nodo_crear(bit_a | bit_b, 0, 0);
+		if (nodo) {
+			entradas(nodo)[bit_a < bit_b ? 0 : 1] = entrada_ref(a);
+			entradas(nodo)[bit_a < bit_b ? 1 : 0] = entrada_ref(b);
+		}
+		return nodo;
+	}
+	nodo_t* hijo = fusionar(a, b, desplazamiento + BITS_POR_NIVEL);
+	if (!hijo) {
+		return NULL;
+	}
+	nodo_t* nodo = nodo_crear(0, bit_a, 0);
+	if (!nodo) {
+		nodo_liberar(hijo, NULL);
+		return NULL;
+	}
+	subnodos(nodo)[0] = hijo;
+	return nodo;
+}
+
+static nodo_t* colision_insertar(nodo_t* nodo, entrada_t* nueva, bool* reemplazo) {
+	int pos = -1;
+	for (unsigned i = 0; i < nodo->colisiones; i++) {
+		if (strcmp(entradas(nodo)[i]->clave, nueva->clave) == 0) {
+			pos = (int)i;
+		}
+	}
+	*reemplazo = pos >= 0;
+	nodo_t* copia = nodo_crear(0, 0, *reemplazo ? nodo->colisiones : nodo->colisiones + 1);
+	if (!copia) {
+		return NULL;
+	}
+	int hueco = *reemplazo ? pos : (int)nodo->colisiones;
+	copiar_hijos(copia, nodo, pos, hueco, -1, -1);
+	entradas(copia)[hueco] = entrada_ref(nueva);
+	return copia;
+}
+
+/* Devuelve una copia de nodo que además contiene la entrada nueva, o NULL
+ * si no hubo memoria. El nodo original no se modifica.
+ */
+static nodo_t* nodo_insertar(nodo_t* nodo, entrada_t* nueva, unsigned desplazamiento, bool* reemplazo, hash_destruir_dato_t destruir_dato) {
+	if (nodo->colisiones) {
+		return colision_insertar(nodo, nueva, reemplazo);
+	}
+	uint32_t bit = bit_de(nueva->hash, desplazamiento);
+	nodo_t* copia;
+
+	if (nodo->mapa_datos & bit) {
+		int i = (int)indice_de(nodo->mapa_datos, bit);
+		entrada_t* vieja = entradas(nodo)[i];
+		if (entrada_es(vieja, nueva->clave, nueva->hash)) {
+			*reemplazo = true;
+			copia = nodo_crear(nodo->mapa_datos, nodo->mapa_hijos, 0);
+			if (!copia) {
+				return NULL;
+			}
+			copiar_hijos(copia, nodo, i, i, -1, -1);
+			entradas(copia)[i] = entrada_ref(nueva);
+			return copia;
+		}
+		// la posición está ocupada por otra clave: se baja un nivel con las dos
+		*reemplazo = false;
+		nodo_t* hijo = fusionar(vieja, nueva, desplazamiento + BITS_POR_NIVEL);
+		if (!hijo) {
+			return NULL;
+		}
+		copia = nodo_crear(nodo->mapa_datos & ~bit, nodo->mapa_hijos | bit, 0);
+		if (!copia) {
+			nodo_liberar(hijo, destruir_dato);
+			return NULL;
+		}
+		int j = (int)indice_de(nodo->mapa_hijos, bit);
+		copiar_hijos(copia, nodo, i, -1, -1, j);
+		subnodos(copia)[j] = hijo;
+		return copia;
+	}
+
+	if (nodo->mapa_hijos & bit) {
+		int j = (int)indice_de(nodo->mapa_hijos, bit);
+		nodo_t* hijo = nodo_insertar(subnodos(nodo)[j], nueva, desplazamiento + BITS_POR_NIVEL, reemplazo, destruir_dato);
+		if (!hijo) {
+			return NULL;
+		}
+		copia = nodo_crear(nodo->mapa_datos, nodo->mapa_hijos, 0);
+		if (!copia) {
+			nodo_liberar(hijo, destruir_dato);
+			return NULL;
+		}
+		copiar_hijos(copia, nodo, -1, -1, j, j);
+		subnodos(copia)[j] = hijo;
+		return copia;
+	}
+
+	*reemplazo = false;
+	copia = nodo_crear(nodo->mapa_datos | bit, nodo->mapa_hijos, 0);
+	if (!copia) {
+		return NULL;
+	}
+	int i = (int)indice_de(nodo->mapa_datos, bit);
+	copiar_hijos(copia, nodo, -1, i, -1, -1);
+	entradas(copia)[i] = entrada_ref(nueva);
+	return copia;
+}
+
+static resultado_borrar_t colision_borrar(nodo_t* nodo, const char* clave, nodo_t** resultado, entrada_t** quitada) {
+	int pos = -1;
+	for (unsigned i = 0; i < nodo->colisiones; i++) {
+		if (strcmp(entradas(nodo)[i]->clave, clave) == 0) {
+			pos = (int)i;
+		}
+	}
+	if (pos < 0) {
+		return NO_ESTABA;
+	}
+	nodo_t* copia = nodo_crear(0, 0, nodo->colisiones - 1);
+	if (!copia) {
+		return SIN_MEMORIA;
+	}
+	copiar_hijos(copia, nodo, pos, -1, -1, -1);
+	*quitada = entradas(nodo)[pos];
+	*resultado = copia;
+	return BORRADA;
+}
+
+/* Si la clave está, deja en resultado una copia del nodo sin ella y en
+ * quitada la entrada borrada. Los subnodos que quedan con una sola entrada
+ * se absorben en el padre, así un subnodo siempre tiene al menos dos claves.
+ */
+static resultado_borrar_t nodo_borrar(nodo_t* nodo, const char* clave, uint32_t hash, unsigned desplazamiento, nodo_t** resultado, entrada_t** quitada, hash_destruir_dato_t destruir_dato) {
+	if (nodo->colisiones) {
+		return colision_borrar(nodo, clave, resultado, quitada);
+	}
+	uint32_t bit = bit_de(hash, desplazamiento);
+	nodo_t* copia;
+
+	if (nodo->mapa_datos & bit) {
+		int i = (int)indice_de(nodo->mapa_datos, bit);
+		if (!entrada_es(entradas(nodo)[i], clave, hash)) {
+			return NO_ESTABA;
+		}
+		copia = nodo_crear(nodo->mapa_datos & ~bit, nodo->mapa_hijos, 0);
+		if (!copia) {
+			return SIN_MEMORIA;
+		}
+		copiar_hijos(copia, nodo, i, -1, -1, -1);
+		*quitada = entradas(nodo)[i];
+		*resultado = copia;
+		return BORRADA;
+	}
+
+	if (!(nodo->mapa_hijos & bit)) {
+		return NO_ESTABA;
+	}
+	int j = (int)indice_de(nodo->mapa_hijos, bit);
+	nodo_t* hijo;
+	resultado_borrar_t estado = nodo_borrar(subnodos(nodo)[j], clave, hash, desplazamiento + BITS_POR_NIVEL, &hijo, quitada, destruir_dato);
+	if (estado != BORRADA) {
+		return estado;
+	}
+
+	if (cantidad_subnodos(hijo) == 0 && cantidad_entradas(hijo) == 1) {
+		copia = nodo_crear(nodo->mapa_datos | bit, nodo->mapa_hijos & ~bit, 0);
+		if (!copia) {
+			nodo_liberar(hijo, destruir_dato);
+			return SIN_MEMORIA;
+		}
+		int i = (int)indice_de(nodo->mapa_datos, bit);
+		copiar_hijos(copia, nodo, -1, i, j, -1);
+		entradas(copia)[i] = entrada_ref(entradas(hijo)[0]);
+		nodo_liberar(hijo, destruir_dato);
+	} else {
+		copia = nodo_crear(nodo->mapa_datos, nodo->mapa_hijos, 0);
+		if (!copia) {
+			nodo_liberar(hijo, destruir_dato);
+			return SIN_MEMORIA;
+		}
+		copiar_hijos(copia, nodo, -1, -1, j, j);
+		subnodos(copia)[j] = hijo;
+	}
+	*resultado = copia;
+	return BORRADA;
+}
+
+static entrada_t* buscar(const hamt_t* hamt, const char* clave) {
+	uint32_t hash = (uint32_t)hash_funcion(clave);
+	nodo_t* nodo = hamt->raiz;
+	for (unsigned desplazamiento = 0; !nodo->colisiones; desplazamiento += BITS_POR_NIVEL) {
+		uint32_t bit = bit_de(hash, desplazamiento);
+		if (nodo->mapa_datos & bit) {
+			entrada_t* entrada = entradas(nodo)[indice_de(nodo->mapa_datos, bit)];
+			return entrada_es(entrada, clave, hash) ? entrada : NULL;
+		}
+		if (!(nodo->mapa_hijos & bit)) {
+			return NULL;
+		}
+		nodo = subnodos(nodo)[indice_de(nodo->mapa_hijos, bit)];
+	}
+	for (unsigned i = 0; i < nodo->colisiones; i++) {
+		if (entrada_es(entradas(nodo)[i], clave, hash)) {
+			return entradas(nodo)[i];
+		}
+	}
+	return NULL;
+}
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL HAMT
+ * *****************************************************************/
+
+hamt_t *hamt_crear(hash_destruir_dato_t destruir_dato) {
+	hamt_t* hamt = malloc(sizeof(hamt_t));
+	if (!hamt) {
+		return NULL;
+	}
+	hamt->raiz = nodo_crear(0, 0, 0);
+	if (!hamt->raiz) {
+		free(hamt);
+		return NULL;
+	}
+	hamt->cantidad = 0;
+	hamt->destruir_dato = destruir_dato;
+	return hamt;
+}
+
+hamt_t *hamt_clonar(const hamt_t *hamt) {
+	hamt_t* clon = malloc(sizeof(hamt_t));
+	if (!clon) {
+		return NULL;
+	}
+	clon->raiz = nodo_ref(hamt->raiz);
+	clon->cantidad = hamt->cantidad;
+	clon->destruir_dato = hamt->destruir_dato;
+	return clon;
+}
+
+bool hamt_guardar(hamt_t *hamt, const char *clave, void *dato) {
+	entrada_t* nueva = entrada_crear(clave, dato, (uint32_t)hash_funcion(clave));
+	if (!nueva) {
+		return false;
+	}
+	bool reemplazo = false;
+	nodo_t* raiz = nodo_insertar(hamt->raiz, nueva, 0, &reemplazo, hamt->destruir_dato);
+	// el árbol nuevo tiene su propia referencia a la entrada
+	entrada_liberar(nueva, NULL);
+	if (!raiz) {
+		return false;
+	}
+	nodo_liberar(hamt->raiz, hamt->destruir_dato);
+	hamt->raiz = raiz;
+	if (!reemplazo) {
+		hamt->cantidad++;
+	}
+	return true;
+}
+
+void *hamt_borrar(hamt_t *hamt, const char *clave) {
+	nodo_t* raiz;
+	entrada_t* quitada;
+	if (nodo_borrar(hamt->raiz, clave, (uint32_t)hash_funcion(clave), 0, &raiz, &quitada, hamt->destruir_dato) != BORRADA) {
+		return NULL;
+	}
+	// se retiene la entrada para que liberar la raíz vieja no destruya el dato
+	entrada_ref(quitada);
+	nodo_liberar(hamt->raiz, hamt->destruir_dato);
+	hamt->raiz = raiz;
+	hamt->cantidad--;
+	void* dato = quitada->dato;
+	entrada_liberar(quitada, NULL);
+	return dato;
+}
+
+void *hamt_obtener(const hamt_t *hamt, const char *clave) {
+	entrada_t* entrada = buscar(hamt, clave);
+	return entrada ? entrada->dato : NULL;
+}
+
+bool hamt_pertenece(const hamt_t *hamt, const char *clave) {
+	return buscar(hamt, clave) != NULL;
+}
+
+size_t hamt_cantidad(const hamt_t *hamt) {
+	return hamt->cantidad;
+}
+
+void hamt_destruir(hamt_t *hamt) {
+	nodo_liberar(hamt->raiz, hamt->destruir_dato);
+	free(hamt);
+}
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL ITERADOR
+ * *****************************************************************/
+
+// Recorre en profundidad hasta la próxima entrada, o deja actual en NULL
+static void iter_buscar_siguiente(hamt_iter_t* iter) {
+	iter->actual = NULL;
+	while (iter->nivel >= 0) {
+		nodo_t* nodo = iter->pila[iter->nivel];
+		size_t pos = iter->pos[iter->nivel]++;
+		size_t n_entradas = cantidad_entradas(nodo);
+		if (pos < n_entradas) {
+			iter->actual = entradas(nodo)[pos];
+			return;
+		}
+		if (pos < n_entradas + cantidad_subnodos(nodo)) {
+			iter->nivel++;
+			iter->pila[iter->nivel] = subnodos(nodo)[pos - n_entradas];
+			iter->pos[iter->nivel] = 0;
+		} else {
+			iter->nivel--;
+		}
+	}
+}
+
+hamt_iter_t *hamt_iter_crear(const hamt_t *hamt) {
+	hamt_iter_t* iter = malloc(sizeof(hamt_iter_t));
+	if (!iter) {
+		return NULL;
+	}
+	iter->hamt = hamt;
+	iter->nivel = 0;
+	iter->pila[0] = hamt->raiz;
+	iter->pos[0] = 0;
+	iter_buscar_siguiente(iter);
+	return iter;
+}
+
+bool hamt_iter_al_final(const hamt_iter_t *iter) {
+	return iter->actual == NULL;
+}
+
+bool hamt_iter_avanzar(hamt_iter_t *iter) {
+	if (hamt_iter_al_final(iter)) {
+		return false;
+	}
+	iter_buscar_siguiente(iter);
+	return !hamt_iter_al_final(iter);
+}
+
+const char *hamt_iter_ver_actual(const hamt_iter_t *iter) {
+	return iter->actual ? iter->actual->clave : NULL;
+}
+
+void hamt_iter_destruir(hamt_iter_t *iter) {
+	free(iter);
+}
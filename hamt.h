@@ -0,0 +1,87 @@
+#ifndef HAMT_H
+#define HAMT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "hash.h"
+
+/* Diccionario persistente implementado como Hash Array Mapped Trie. Ofrece
+ * las mismas operaciones que hash.h y además hamt_clonar en O(1): el clon
+ * comparte todos los nodos con el original y cada modificación posterior
+ * copia sólo el camino desde la raíz hasta la clave tocada.
+ *
+ * Original y clones pueden usarse desde hilos distintos, pero cada hamt_t
+ * en particular no admite modificaciones concurrentes.
+ */
+
+struct hamt;
+struct hamt_iter;
+
+typedef struct hamt hamt_t;
+typedef struct hamt_iter hamt_iter_t;
+
+/* Crea el hamt
+ */
+hamt_t *hamt_crear(hash_destruir_dato_t destruir_dato);
+
+/* Devuelve un clon del hamt en O(1). Original y clon evolucionan de forma
+ * independiente; un dato se destruye cuando ya no lo contiene ninguno.
+ * Pre: el hamt fue creado.
+ * Post: devuelve NULL si no hubo memoria.
+ */
+hamt_t *hamt_clonar(const hamt_t *hamt);
+
+/* Guarda un elemento en el hamt, si la clave ya se encuentra en la
+ * estructura, la reemplaza. De no poder guardarlo devuelve false.
+ * Pre: el hamt fue creado.
+ * Post: Se almacenó el par (clave, dato)
+ */
+bool hamt_guardar(hamt_t *hamt, const char *clave, void *dato);
+
+/* Borra un elemento del hamt y devuelve el dato asociado. Devuelve NULL si
+ * la clave no estaba. Si algún clon todavía contiene el par, el dato sigue
+ * perteneciendo a ese clon y no debe destruirse.
+ * Pre: el hamt fue creado.
+ */
+void *hamt_borrar(hamt_t *hamt, const char *clave);
+
+/* Obtiene el valor de un elemento del hamt, si la clave no se encuentra
+ * devuelve NULL.
+ * Pre: el hamt fue creado.
+ */
+void *hamt_obtener(const hamt_t *hamt, const char *clave);
+
+/* Determina si clave pertenece o no al hamt.
+ * Pre: el hamt fue creado.
+ */
+bool hamt_pertenece(const hamt_t *hamt, const char *clave);
+
+/* Devuelve la cantidad de elementos del hamt.
+ * Pre: el hamt fue creado.
+ */
+size_t hamt_cantidad(const hamt_t *hamt);
+
+/* Destruye el hamt. Los datos que no compartía con ningún clon se destruyen
+ * con la función recibida en hamt_crear.
+ * Pre: el hamt fue creado.
+ */
+void hamt_destruir(hamt_t *hamt);
+
+/* Iterador del hamt */
+
+// Crea iterador
+hamt_iter_t *hamt_iter_crear(const hamt_t *hamt);
+
+// Avanza iterador
+bool hamt_iter_avanzar(hamt_iter_t *iter);
+
+// Devuelve clave actual, esa clave no se puede modificar ni liberar.
+const char *hamt_iter_ver_actual(const hamt_iter_t *iter);
+
+// Comprueba si terminó la iteración
+bool hamt_iter_al_final(const hamt_iter_t *iter);
+
+// Destruye iterador
+void hamt_iter_destruir(hamt_iter_t *iter);
+
+#endif // HAMT_H
@@ -1,251 +1,2048 @@
+#define _POSIX_C_SOURCE 200809L
+#include <math.h>
+#include <pthread.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
-#include "lista.h"
+#include <unistd.h>
+#include "congelado.h"
+#include "epoca.h"
+#include "indice.h"
 #include "hash.h"
 
-#define CAPACIDAD_INICIAL 8
+#define CAPACIDAD_INICIAL 8 // al dejar de estar en línea
 #define MAX_ESPACIO_USADO 2
 #define MIN_ESPACIO_USADO 0.5
+// después de achicar la ocupación se duplica y no puede llegar a la de crecer
+#define MAX_ACHICAR_DEBAJO_DE 1.0
+#define TAM_LINEA_CACHE 64
+#define ENTRADAS_POR_BALDE 6
+// hash_unir reparte el trabajo en hilos sólo a partir de este tamaño
+#define MIN_CLAVES_POR_HILO 16384
+#define MAX_HILOS_UNIR 16
+#define VALORES_INICIALES 2
+#define BYTES_UNO 0x0101010101010101ULL
+#define BYTES_SIETE 0x7F7F7F7F7F7F7F7FULL
 
 
 /* ******************************************************************
  *                DEFINICION DE LOS TIPOS DE DATOS
  * *****************************************************************/
+/* Cada balde ocupa una línea de cache: las etiquetas (8 bits del hash) de
+ * hasta ENTRADAS_POR_BALDE claves, sus nodos y un puntero a un bloque de
+ * desborde con el mismo formato. Revisar un balde compara las etiquetas y
+ * sólo va al nodo cuando coinciden. En una cadena todos los bloques están
+ * llenos salvo el último; un balde vacío tiene cantidad 0.
+ */
+typedef struct balde {
+	uint8_t etiquetas[ENTRADAS_POR_BALDE];
+	uint8_t cantidad;
+	struct nodo* entradas[ENTRADAS_POR_BALDE];
+	struct balde* desborde;
+} balde_t;
+
+/* Un hash nuevo usa como tabla el balde en_linea, dentro del mismo struct:
+ * crearlo es un solo pedido de memoria. Pasa a una tabla aparte de
+ * CAPACIDAD_INICIAL baldes recién cuando ese balde se llena. El struct se
+ * pide alineado a TAM_LINEA_CACHE y en_linea va primero, así el balde
+ * ocupa una sola línea como los de cualquier tabla.
+ */
 struct hash {
-	lista_t** tabla;
+	balde_t en_linea;
+	balde_t* tabla;
 	size_t cantidad;
 	size_t capacidad;
 	hash_destruir_dato_t destruir_dato;
+	indice_t* indice; // NULL salvo en los hash creados con hash_crear_ordenado
+	hash_asignador_t asignador; // de la tabla, los bloques de desborde y los nodos
+	congelado_t* congelado; // NULL salvo después de hash_congelar: no hay tabla
+	hash_politica_t politica;
+	bool multiple; // el dato de cada nodo es un valores_t
+	epoca_t* epoca; // si no es NULL, los datos se retiran en lugar de destruirse
+};
+
+// Los datos de una clave de un hash múltiple, uno detrás de otro
+typedef struct valores {
+	size_t cantidad;
+	size_t capacidad;
+	void* datos[];
+} valores_t;
+
+// El nodo guarda su hash, así redimensionar no vuelve a recorrer las claves
+typedef struct nodo {
+	char* clave;
+	void* dato;
+	unsigned long hash;
+}nodo_t;
+
+struct hash_iter {
+	size_t pos;
+	const hash_t* hash;
+	const balde_t* actual; // bloque de la cadena del balde pos, NULL al final
+	size_t entrada;
+	// iteración en orden: recorre el índice en lugar de los baldes
+	indice_iter_t* ordenado;
+	char* prefijo;
+	size_t largo_prefijo;
 };
 
-typedef struct nodo {
-	const char* clave;
-	void* dato;
-}nodo_t;
 
-struct hash_iter {
-	size_t pos;
-	const hash_t* hash;
-	lista_iter_t* iter_actual;
-};
+/* ******************************************************************
+ *                			HASH FUNCTION
+ * *****************************************************************/
+//One-at-a-time hash
+
+static unsigned mezclar(unsigned h, unsigned char c) {
+	h += c;
+	h += (h << 10);
+	h ^= (h >> 6);
+	return h;
+}
+
+static unsigned long terminar(unsigned h) {
+	h += (h << 3);
+	h ^= (h >> 11);
+	h += (h << 15);
+	return h;
+}
+
+unsigned long hash_funcion(const char* clave) {
+	unsigned h = 0;
+	for (size_t i = 0; clave[i] != '\0'; i++) {
+		h = mezclar(h, (unsigned char)clave[i]);
+	}
+	return terminar(h);
+}
+
+//el estado es el acumulado de one-at-a-time antes del paso final
+void hash_estado_iniciar(hash_estado_t *estado) {
+	estado->acumulado = 0;
+}
+
+void hash_estado_agregar(hash_estado_t *estado, const char *texto, size_t largo) {
+	unsigned h = estado->acumulado;
+	for (size_t i = 0; i < largo; i++) {
+		h = mezclar(h, (unsigned char)texto[i]);
+	}
+	estado->acumulado = h;
+}
+
+unsigned long hash_estado_terminar(const hash_estado_t *estado) {
+	return terminar(estado->acumulado);
+}
+
+uint64_t hash_mezclar(uint64_t x) {
+	x ^= x >> 30;
+	x *= UINT64_C(0xbf58476d1ce4e5b9);
+	x ^= x >> 27;
+	x *= UINT64_C(0x94d049bb133111eb);
+	return x ^ (x >> 31);
+}
+
+//el balde sale de los bits bajos del hash: la etiqueta, de la mezcla del hash entero
+static uint8_t etiqueta(unsigned long hash) {
+	return (uint8_t)(hash_mezclar(hash) >> 56);
+}
+
+
+
+
+/* ******************************************************************
+ *                    MEMORIA
+ * *****************************************************************/
+
+static void* pedir_malloc(size_t tam, size_t alineacion, void* contexto) {
+	(void)contexto;
+	if (alineacion <= sizeof(void*)) {
+		return malloc(tam);
+	}
+	void* memoria;
+	return posix_memalign(&memoria, alineacion, tam) == 0 ? memoria : NULL;
+}
+
+static void liberar_malloc(void* memoria, size_t tam, void* contexto) {
+	(void)tam;
+	(void)contexto;
+	free(memoria);
+}
+
+static const hash_asignador_t ASIGNADOR_MALLOC = {pedir_malloc, liberar_malloc, NULL};
+
+static void* pedir(const hash_t* hash, size_t tam, size_t alineacion) {
+	return hash->asignador.pedir(tam, alineacion, hash->asignador.contexto);
+}
+
+static void devolver(const hash_t* hash, void* memoria, size_t tam) {
+	if (memoria) {
+		hash->asignador.liberar(memoria, tam, hash->asignador.contexto);
+	}
+}
+
+//todo dato que el hash tiene que destruir pasa por acá
+static void descartar_dato(const hash_t* hash, void* dato) {
+	if (!hash->destruir_dato) {
+		return;
+	}
+	if (hash->epoca) {
+		epoca_retirar(hash->epoca, dato, hash->destruir_dato);
+	} else {
+		hash->destruir_dato(dato);
+	}
+}
+
+
+/* ******************************************************************
+ *                    BALDES
+ * *****************************************************************/
+
+static balde_t* crear_bloque(const hash_t* hash) {
+	balde_t* bloque = pedir(hash, sizeof(balde_t), TAM_LINEA_CACHE);
+	if (!bloque) {
+		return NULL;
+	}
+	memset(bloque, 0, sizeof(balde_t));
+	return bloque;
+}
+
+//la capacidad es siempre potencia de 2: el balde sale de los bits bajos del hash
+static balde_t* crear_tabla(hash_t* hash, size_t capacidad) {
+	balde_t* tabla = capacidad == 1 ? &hash->en_linea : pedir(hash, capacidad * sizeof(balde_t), TAM_LINEA_CACHE);
+	if (!tabla) {
+		return NULL;
+	}
+	memset(tabla, 0, capacidad * sizeof(balde_t));
+	return tabla;
+}
+
+static void devolver_tabla(const hash_t* hash, balde_t* tabla, size_t capacidad) {
+	if (tabla != &hash->en_linea) {
+		devolver(hash, tabla, capacidad * sizeof(balde_t));
+	}
+}
+
+/* La capacidad que necesita una tabla de capacidad baldes para claves
+ * claves. La tabla en línea alcanza mientras entren en su único balde.
+ */
+static size_t capacidad_para(size_t capacidad, size_t claves) {
+	if (capacidad == 1) {
+		if (claves <= ENTRADAS_POR_BALDE) {
+			return 1;
+		}
+		capacidad = CAPACIDAD_INICIAL;
+	}
+	while (claves / capacidad > MAX_ESPACIO_USADO) {
+		capacidad *= 2;
+	}
+	return capacidad;
+}
+
+static balde_t* balde_de(const hash_t* hash, unsigned long h) {
+	return &hash->tabla[h & (hash->capacidad - 1)];
+}
+
+//los bloques libres se encadenan por su puntero de desborde
+static void liberar_bloques(const hash_t* hash, balde_t* libres) {
+	while (libres) {
+		balde_t* siguiente = libres->desborde;
+		devolver(hash, libres, sizeof(balde_t));
+		libres = siguiente;
+	}
+}
+
+static bool reservar_bloques(const hash_t* hash, size_t cantidad, balde_t** libres) {
+	for (size_t i = 0; i < cantidad; i++) {
+		balde_t* bloque = crear_bloque(hash);
+		if (!bloque) {
+			return false;
+		}
+		bloque->desborde = *libres;
+		*libres = bloque;
+	}
+	return true;
+}
+
+static size_t desbordes_para(size_t entradas) {
+	return entradas <= ENTRADAS_POR_BALDE ? 0 : (entradas - 1) / ENTRADAS_POR_BALDE;
+}
+
+static size_t largo_cadena(const balde_t* balde) {
+	size_t largo = 0;
+	for (; balde; balde = balde->desborde) {
+		largo += balde->cantidad;
+	}
+	return largo;
+}
+
+/* Compara la etiqueta buscada con las del bloque todas a la vez (SWAR):
+ * devuelve el bit alto del byte i prendido si la entrada i está ocupada y
+ * su etiqueta coincide. Las etiquetas y la cantidad son los primeros 8
+ * bytes del bloque.
+ */
+static uint64_t coincidencias(const balde_t* balde, uint8_t buscada) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	uint64_t etiquetas;
+	memcpy(&etiquetas, balde, sizeof(etiquetas));
+	uint64_t x = etiquetas ^ (BYTES_UNO * buscada);
+	uint64_t iguales = ~(((x & BYTES_SIETE) + BYTES_SIETE) | x | BYTES_SIETE);
+	return iguales & (((uint64_t)1 << (8 * balde->cantidad)) - 1);
+#else
+	uint64_t iguales = 0;
+	for (size_t i = 0; i < balde->cantidad; i++) {
+		if (balde->etiquetas[i] == buscada) {
+			iguales |= (uint64_t)0x80 << (8 * i);
+		}
+	}
+	return iguales;
+#endif
+}
+
+static size_t primera_coincidencia(uint64_t iguales) {
+	return (size_t)__builtin_ctzll(iguales) / 8;
+}
+
+/* Busca la clave en la cadena del balde; si la encuentra deja en bloque y
+ * pos dónde está. Sólo se mira el nodo si coincide la etiqueta.
+ */
+static nodo_t* buscar_en_balde(const balde_t* balde, unsigned long h, const char* clave, const balde_t** bloque, size_t* pos) {
+	uint8_t buscada = etiqueta(h);
+	for (; balde; balde = balde->desborde) {
+		for (uint64_t iguales = coincidencias(balde, buscada); iguales; iguales &= iguales - 1) {
+			size_t i = primera_coincidencia(iguales);
+			nodo_t* nodo = balde->entradas[i];
+			if (nodo->hash == h && strcmp(nodo->clave, clave) == 0) {
+				if (bloque) {
+					*bloque = balde;
+					*pos = i;
+				}
+				return nodo;
+			}
+		}
+	}
+	return NULL;
+}
+
+/* Agrega el nodo al final de la cadena. Si hace falta un bloque nuevo lo
+ * toma de libres (si hay) o lo pide. Devuelve false si no hubo memoria.
+ */
+static bool balde_insertar(const hash_t* hash, balde_t* balde, nodo_t* nodo, balde_t** libres) {
+	while (balde->cantidad == ENTRADAS_POR_BALDE && balde->desborde) {
+		balde = balde->desborde;
+	}
+	if (balde->cantidad == ENTRADAS_POR_BALDE) {
+		balde_t* bloque;
+		if (libres && *libres) {
+			bloque = *libres;
+			*libres = bloque->desborde;
+			memset(bloque, 0, sizeof(balde_t));
+		} else if (!(bloque = crear_bloque(hash))) {
+			return false;
+		}
+		balde->desborde = bloque;
+		balde = bloque;
+	}
+	balde->etiquetas[balde->cantidad] = etiqueta(nodo->hash);
+	balde->entradas[balde->cantidad++] = nodo;
+	return true;
+}
+
+//saca la entrada pos del bloque y pone en su lugar la última de la cadena
+static void balde_quitar(const hash_t* hash, balde_t* balde, balde_t* bloque, size_t pos) {
+	balde_t* anterior = NULL;
+	balde_t* ultimo = balde;
+	while (ultimo->desborde) {
+		anterior = ultimo;
+		ultimo = ultimo->desborde;
+	}
+	size_t fin = --ultimo->cantidad;
+	bloque->etiquetas[pos] = ultimo->etiquetas[fin];
+	bloque->entradas[pos] = ultimo->entradas[fin];
+	if (ultimo->cantidad == 0 && anterior) {
+		anterior->desborde = NULL;
+		devolver(hash, ultimo, sizeof(balde_t));
+	}
+}
+
+/* ******************************************************************
+ *                    VALORES DE UN HASH MULTIPLE
+ * *****************************************************************/
+
+static size_t tam_valores(size_t capacidad) {
+	return sizeof(valores_t) + capacidad * sizeof(void*);
+}
+
+static valores_t* crear_valores(const hash_t* hash, void* dato) {
+	valores_t* valores = pedir(hash, tam_valores(VALORES_INICIALES), sizeof(void*));
+	if (!valores) {
+		return NULL;
+	}
+	valores->cantidad = 1;
+	valores->capacidad = VALORES_INICIALES;
+	valores->datos[0] = dato;
+	return valores;
+}
+
+//el arreglo se duplica cuando se llena, así agregar cuesta O(1) amortizado
+static bool valores_agregar(const hash_t* hash, nodo_t* nodo, void* dato) {
+	valores_t* actual = nodo->dato;
+	if (actual->cantidad == actual->capacidad) {
+		valores_t* nuevo = pedir(hash, tam_valores(2 * actual->capacidad), sizeof(void*));
+		if (!nuevo) {
+			return false;
+		}
+		memcpy(nuevo, actual, tam_valores(actual->cantidad));
+		nuevo->capacidad = 2 * actual->capacidad;
+		devolver(hash, actual, tam_valores(actual->capacidad));
+		nodo->dato = actual = nuevo;
+	}
+	actual->datos[actual->cantidad++] = dato;
+	return true;
+}
+
+static void destruir_valores(const hash_t* hash, valores_t* valores) {
+	for (size_t i = 0; hash->destruir_dato && i < valores->cantidad; i++) {
+		descartar_dato(hash, valores->datos[i]);
+	}
+	devolver(hash, valores, tam_valores(valores->capacidad));
+}
+
+//en un hash múltiple el dato de una clave es el primero que se agregó
+static void* dato_de(const hash_t* hash, const nodo_t* nodo) {
+	return hash->multiple ? ((const valores_t*)nodo->dato)->datos[0] : nodo->dato;
+}
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL HASH
+ * *****************************************************************/
+
+hash_t *hash_crear(hash_destruir_dato_t destruir_dato) {
+	return hash_crear_con_asignador(destruir_dato, &ASIGNADOR_MALLOC);
+}
+
+hash_t *hash_crear_con_asignador(hash_destruir_dato_t destruir_dato, const hash_asignador_t *asignador) {
+
+	hash_t* tabla_hash = asignador->pedir(sizeof(hash_t), TAM_LINEA_CACHE, asignador->contexto);
+
+	if (!tabla_hash) {
+		return NULL;
+	}
+
+	tabla_hash->asignador = *asignador;
+	tabla_hash->tabla = crear_tabla(tabla_hash, 1);
+	tabla_hash->cantidad = 0;
+	tabla_hash->capacidad = 1;
+	tabla_hash->destruir_dato = destruir_dato;
+	tabla_hash->indice = NULL;
+	tabla_hash->congelado = NULL;
+	tabla_hash->politica = HASH_POLITICA_DEFECTO;
+	tabla_hash->multiple = false;
+	tabla_hash->epoca = NULL;
+	
+	return tabla_hash;
+
+}
+
+hash_t *hash_crear_ordenado(hash_destruir_dato_t destruir_dato) {
+	hash_t* hash = hash_crear(destruir_dato);
+	if (!hash) {
+		return NULL;
+	}
+	hash->indice = indice_crear();
+	if (!hash->indice) {
+		hash_destruir(hash);
+		return NULL;
+	}
+	return hash;
+}
+
+hash_t *hash_crear_multiple(hash_destruir_dato_t destruir_dato) {
+	hash_t* hash = hash_crear(destruir_dato);
+	if (hash) {
+		hash->multiple = true;
+	}
+	return hash;
+}
+
+//el nodo guarda una copia de la clave, asi el usuario puede modificar o liberar la suya
+//la copia va en el mismo pedido, justo después del nodo
+static nodo_t* reservar_nodo(const hash_t* hash, size_t largo) {
+	nodo_t* nodo = pedir(hash, sizeof(nodo_t) + largo, sizeof(void*));
+	if (nodo) {
+		nodo->clave = (char*)(nodo + 1);
+	}
+	return nodo;
+}
+
+//recibe el hash ya calculado de la clave, para no recorrerla de nuevo
+static nodo_t* crear_nodo_hasheado(const hash_t* hash, const char* clave, void* dato, unsigned long h){
+	size_t largo = strlen(clave) + 1;
+	nodo_t* nodo = reservar_nodo(hash, largo);
+	if (!nodo){
+		return NULL;
+	}
+	memcpy(nodo->clave, clave, largo);
+	nodo->dato = dato;
+	nodo->hash = h;
+	
+	return nodo;
+}
+
+nodo_t* crear_nodo(const hash_t* hash, const char* clave,void* dato){
+	return crear_nodo_hasheado(hash, clave, dato, hash_funcion(clave));
+}
+
+static void liberar_nodo(const hash_t* hash, nodo_t* nodo) {
+	devolver(hash, nodo, sizeof(nodo_t) + strlen(nodo->clave) + 1);
+}
+
+static nodo_t* buscar_nodo_hasheado(const hash_t* hash, const char* clave, unsigned long h) {
+	return buscar_en_balde(balde_de(hash, h), h, clave, NULL, NULL);
+}
+
+static nodo_t* buscar_nodo(const hash_t* hash, const char* clave) {
+	return buscar_nodo_hasheado(hash, clave, hash_funcion(clave));
+}
+
+/* Mueve los nodos a una tabla de new_tam baldes sin copiarlos. Al crecer,
+ * cada balde se parte en baldes que sólo reciben sus propias entradas, así
+ * que alcanza con reusar sus bloques de desborde. Al achicar, los baldes que
+ * se juntan pueden necesitar más bloques: se piden todos antes de mover nada,
+ * y si no hay memoria la tabla queda como estaba.
+ */
+static bool redimensionar_tabla(hash_t* hash,size_t new_tam){
+	size_t vieja = hash->capacidad;
+	size_t familias = vieja < new_tam ? vieja : new_tam;
+	size_t juntos = vieja > new_tam ? vieja / new_tam : 1;
+
+	size_t faltan = 0;
+	size_t mayor_familia = 0;
+	for (size_t i = 0; i < familias; i++) {
+		size_t entradas = 0;
+		size_t bloques = 0;
+		for (size_t k = 0; k < juntos; k++) {
+			size_t largo = largo_cadena(&hash->tabla[i + k * new_tam]);
+			entradas += largo;
+			bloques += desbordes_para(largo);
+		}
+		if (desbordes_para(entradas) > bloques) {
+			faltan += desbordes_para(entradas) - bloques;
+		}
+		if (entradas > mayor_familia) {
+			mayor_familia = entradas;
+		}
+	}
+
+	balde_t* new_tablas = crear_tabla(hash, new_tam);
+	nodo_t** familia = malloc((mayor_familia ? mayor_familia : 1) * sizeof(nodo_t*));
+	balde_t* libres = NULL;
+	if (!new_tablas || !familia || !reservar_bloques(hash, faltan, &libres)) {
+		devolver_tabla(hash, new_tablas, new_tam);
+		free(familia);
+		liberar_bloques(hash, libres);
+		return false;
+	}
+
+	hash->capacidad = new_tam;
+	for (size_t i = 0; i < familias; i++) {
+		size_t entradas = 0;
+		for (size_t k = 0; k < juntos; k++) {
+			balde_t* balde = &hash->tabla[i + k * new_tam];
+			for (balde_t* bloque = balde; bloque; ) {
+				balde_t* siguiente = bloque->desborde;
+				memcpy(&familia[entradas], bloque->entradas, bloque->cantidad * sizeof(nodo_t*));
+				entradas += bloque->cantidad;
+				if (bloque != balde) {
+					bloque->desborde = libres;
+					libres = bloque;
+				}
+				bloque = siguiente;
+			}
+		}
+		//con los bloques de la familia (y los reservados) no puede faltar memoria
+		for (size_t j = 0; j < entradas; j++) {
+			balde_insertar(hash, &new_tablas[familia[j]->hash & (new_tam - 1)], familia[j], &libres);
+		}
+	}
+	liberar_bloques(hash, libres);
+	free(familia);
+	devolver_tabla(hash, hash->tabla, vieja);
+	hash->tabla = new_tablas;
+	return true;
+}
+
+#ifdef HASH_PERFIL
+static hash_aviso_redimension_t aviso_redimension = NULL;
+static void* extra_redimension = NULL;
+
+void hash_perfil_redimensiones(hash_aviso_redimension_t aviso, void *extra) {
+	aviso_redimension = aviso;
+	extra_redimension = extra;
+}
+#endif
+
+bool hash_redimensionar(hash_t* hash,size_t new_tam){
+#ifdef HASH_PERFIL
+	if (aviso_redimension) {
+		size_t vieja = hash->capacidad;
+		aviso_redimension(vieja, new_tam, false, extra_redimension);
+		bool ok = redimensionar_tabla(hash, new_tam);
+		aviso_redimension(vieja, new_tam, true, extra_redimension);
+		return ok;
+	}
+#endif
+	return redimensionar_tabla(hash, new_tam);
+}
+
+//agrega una clave que no estaba y devuelve su nodo; h es su hash, ya calculado para buscarla
+static nodo_t* insertar_nueva(hash_t* hash, const char* clave, void* dato, unsigned long h) {
+	// Si nos pasamos del limite hay que redimensionarlo
+	size_t capacidad = capacidad_para(hash->capacidad, hash->cantidad + 1);
+	if (capacidad != hash->capacidad && !hash_redimensionar(hash, capacidad)) {
+		return NULL;
+	}
+	nodo_t* nodo = crear_nodo_hasheado(hash, clave, dato, h);
+	if (!nodo) {
+		return NULL;
+	}
+	//el indice apunta a la clave del nodo, no la copia de nuevo
+	if (hash->indice && !indice_guardar(hash->indice, nodo->clave, nodo)) {
+		liberar_nodo(hash, nodo);
+		return NULL;
+	}
+	if (!balde_insertar(hash, balde_de(hash, nodo->hash), nodo, NULL)) {
+		if (hash->indice) {
+			indice_borrar(hash->indice, nodo->clave);
+		}
+		liberar_nodo(hash, nodo);
+		return NULL;
+	}
+	hash->cantidad++;
+	
+	return nodo;
+}
+
+/* Guarda un elemento en el hash, si la clave ya se encuentra en la
+ * estructura, la reemplaza. De no poder guardarlo devuelve false.
+ * Pre: La estructura hash fue inicializada
+ * Post: Se almacenó el par (clave, dato)
+ */
+bool hash_guardar(hash_t *hash, const char *clave, void *dato){
+	if (hash->congelado || hash->multiple) {
+		return false;
+	}
+	unsigned long h = hash_funcion(clave);
+	nodo_t* nodo = buscar_nodo_hasheado(hash, clave, h);
+	if (nodo) {
+		//si ya estaba se reemplaza el dato, destruyendo el anterior
+		descartar_dato(hash, nodo->dato);
+		nodo->dato = dato;
+		return true;
+	}
+	return insertar_nueva(hash, clave, dato, h) != NULL;
+}
+
+void **hash_obtener_o_guardar(hash_t *hash, const char *clave, void *dato, bool *estaba) {
+	if (hash->congelado || hash->multiple) {
+		return NULL;
+	}
+	unsigned long h = hash_funcion(clave);
+	nodo_t* nodo = buscar_nodo_hasheado(hash, clave, h);
+	*estaba = nodo != NULL;
+	if (!nodo) {
+		nodo = insertar_nueva(hash, clave, dato, h);
+	}
+	return nodo ? &nodo->dato : NULL;
+}
+
+bool hash_agregar(hash_t *hash, const char *clave, void *dato) {
+	if (!hash->multiple) {
+		return false;
+	}
+	unsigned long h = hash_funcion(clave);
+	nodo_t* nodo = buscar_nodo_hasheado(hash, clave, h);
+	if (nodo) {
+		return valores_agregar(hash, nodo, dato);
+	}
+	valores_t* valores = crear_valores(hash, dato);
+	if (!valores) {
+		return false;
+	}
+	if (!insertar_nueva(hash, clave, valores, h)) {
+		devolver(hash, valores, tam_valores(valores->capacidad));
+		return false;
+	}
+	return true;
+}
+
+bool hash_obtener_todos(const hash_t *hash, const char *clave, void ***datos, size_t *cantidad) {
+	nodo_t* nodo = hash->multiple ? buscar_nodo(hash, clave) : NULL;
+	valores_t* valores = nodo ? nodo->dato : NULL;
+	*datos = valores ? valores->datos : NULL;
+	*cantidad = valores ? valores->cantidad : 0;
+	return valores != NULL;
+}
+
+typedef struct entrada_lote {
+	unsigned long hash;
+	unsigned long orden; // el hash con los bits invertidos
+	size_t pos;          // posicion en el lote: desempata para respetar el orden
+	const char* clave;
+	void* dato;
+	nodo_t* nuevo;       // creado al preparar, en la primera aparicion de cada clave
+	nodo_t* nodo;        // el que recibe el dato, resuelto al aplicar
+	bool crea;           // el nodo nuevo se enlazo a la tabla
+} entrada_lote_t;
+
+struct hash_lote {
+	hash_asignador_t asignador; // el del hash, para devolver los nodos que sobren
+	entrada_lote_t* entradas;
+	size_t cantidad;
+};
+
+static unsigned long invertir_bits(unsigned long h) {
+	unsigned long invertido = 0;
+	for (size_t i = 0; i < 8 * sizeof(unsigned long); i++) {
+		invertido = (invertido << 1) | (h & 1);
+		h >>= 1;
+	}
+	return invertido;
+}
+
+/* El balde de una clave son los bits bajos de su hash, que este orden mira
+ * primero: las claves de un mismo balde quedan juntas para cualquier
+ * capacidad, y las repeticiones de una clave, juntas y en el orden del lote.
+ */
+static int comparar_por_balde(const void* a, const void* b) {
+	const entrada_lote_t* x = a;
+	const entrada_lote_t* y = b;
+	if (x->orden != y->orden) {
+		return x->orden < y->orden ? -1 : 1;
+	}
+	int comparacion = strcmp(x->clave, y->clave);
+	if (comparacion != 0) {
+		return comparacion;
+	}
+	return (x->pos > y->pos) - (x->pos < y->pos);
+}
+
+//devuelve la posicion de la primera entrada con otra clave despues de i
+static size_t siguiente_clave(const entrada_lote_t* entradas, size_t cantidad, size_t i) {
+	size_t j = i + 1;
+	while (j < cantidad && entradas[j].hash == entradas[i].hash && strcmp(entradas[j].clave, entradas[i].clave) == 0) {
+		j++;
+	}
+	return j;
+}
+
+// Saca del indice los nodos nuevos de las primeras cantidad entradas, que todavia no se enlazaron a la tabla
+static void deshacer_lote(hash_t* hash, entrada_lote_t* entradas, size_t cantidad) {
+	for (size_t i = 0; i < cantidad; i++) {
+		if (!entradas[i].crea) {
+			continue;
+		}
+		if (hash->indice) {
+			indice_borrar(hash->indice, entradas[i].nuevo->clave);
+		}
+		entradas[i].crea = false;
+	}
+}
+
+hash_lote_t *hash_lote_preparar(const hash_t *hash, const char **claves, void **datos, size_t cantidad) {
+	hash_lote_t* lote = malloc(sizeof(hash_lote_t));
+	entrada_lote_t* entradas = malloc((cantidad ? cantidad : 1) * sizeof(entrada_lote_t));
+	if (!lote || !entradas) {
+		free(lote);
+		free(entradas);
+		return NULL;
+	}
+	lote->asignador = hash->asignador;
+	lote->entradas = entradas;
+	lote->cantidad = cantidad;
+	for (size_t i = 0; i < cantidad; i++) {
+		entradas[i].hash = hash_funcion(claves[i]);
+		entradas[i].orden = invertir_bits(entradas[i].hash);
+		entradas[i].pos = i;
+		entradas[i].clave = claves[i];
+		entradas[i].dato = datos[i];
+		entradas[i].nuevo = NULL;
+		entradas[i].nodo = NULL;
+		entradas[i].crea = false;
+	}
+	qsort(entradas, cantidad, sizeof(entrada_lote_t), comparar_por_balde);
+	//cada clave distinta lleva un nodo por si no esta en el hash; al aplicar
+	//se usa o se descarta, pero no hace falta pedir memoria
+	for (size_t i = 0; i < cantidad; i = siguiente_clave(entradas, cantidad, i)) {
+		entradas[i].nuevo = crear_nodo_hasheado(hash, entradas[i].clave, entradas[i].dato, entradas[i].hash);
+		if (!entradas[i].nuevo) {
+			hash_lote_destruir(lote);
+			return NULL;
+		}
+	}
+	return lote;
+}
+
+bool hash_lote_aplicar(hash_t *hash, hash_lote_t *lote, hash_combinar_dato_t combinar) {
+	if (hash->congelado || hash->multiple) {
+		return false;
+	}
+	entrada_lote_t* entradas = lote->entradas;
+	size_t cantidad = lote->cantidad;
+	size_t nuevas = 0;
+	for (size_t i = 0; i < cantidad; ) {
+		size_t j = siguiente_clave(entradas, cantidad, i);
+		nodo_t* nodo = buscar_nodo_hasheado(hash, entradas[i].clave, entradas[i].hash);
+		if (!nodo) {
+			nodo = entradas[i].nuevo;
+			if (hash->indice && !indice_guardar(hash->indice, nodo->clave, nodo)) {
+				deshacer_lote(hash, entradas, i);
+				return false;
+			}
+			entradas[i].crea = true;
+			nuevas++;
+		}
+		for (; i < j; i++) {
+			entradas[i].nodo = nodo;
+		}
+	}
+
+	size_t capacidad = capacidad_para(hash->capacidad, hash->cantidad + nuevas);
+	if (capacidad != hash->capacidad && !hash_redimensionar(hash, capacidad)) {
+		deshacer_lote(hash, entradas, cantidad);
+		return false;
+	}
+
+	//los bloques de desborde que hagan falta tambien se piden antes: despues
+	//ya nada puede fallar
+	size_t faltan = 0;
+	for (size_t i = 0; i < cantidad; ) {
+		balde_t* balde = balde_de(hash, entradas[i].hash);
+		size_t nuevas_balde = 0;
+		for (; i < cantidad && balde_de(hash, entradas[i].hash) == balde; i++) {
+			nuevas_balde += entradas[i].crea;
+		}
+		size_t largo = largo_cadena(balde);
+		faltan += desbordes_para(largo + nuevas_balde) - desbordes_para(largo);
+	}
+	balde_t* libres = NULL;
+	if (!reservar_bloques(hash, faltan, &libres)) {
+		liberar_bloques(hash, libres);
+		deshacer_lote(hash, entradas, cantidad);
+		return false;
+	}
+	//en orden de balde, el lote recorre la tabla una sola vez
+	for (size_t i = 0; i < cantidad; i++) {
+		nodo_t* nodo = entradas[i].nodo;
+		if (entradas[i].crea) {
+			balde_insertar(hash, balde_de(hash, nodo->hash), nodo, &libres);
+			hash->cantidad++;
+		} else if (combinar) {
+			nodo->dato = combinar(nodo->dato, entradas[i].dato);
+		} else {
+			descartar_dato(hash, nodo->dato);
+			nodo->dato = entradas[i].dato;
+		}
+	}
+	liberar_bloques(hash, libres);
+	return true;
+}
+
+void hash_lote_destruir(hash_lote_t *lote) {
+	for (size_t i = 0; i < lote->cantidad; i++) {
+		nodo_t* nodo = lote->entradas[i].nuevo;
+		if (nodo && !lote->entradas[i].crea) {
+			lote->asignador.liberar(nodo, sizeof(nodo_t) + strlen(nodo->clave) + 1, lote->asignador.contexto);
+		}
+	}
+	free(lote->entradas);
+	free(lote);
+}
+
+bool hash_guardar_lote(hash_t *hash, const char **claves, void **datos, size_t cantidad, hash_combinar_dato_t combinar) {
+	if (hash->congelado || hash->multiple) {
+		return false;
+	}
+	if (cantidad == 0) {
+		return true;
+	}
+	hash_lote_t* lote = hash_lote_preparar(hash, claves, datos, cantidad);
+	if (!lote) {
+		return false;
+	}
+	bool ok = hash_lote_aplicar(hash, lote, combinar);
+	hash_lote_destruir(lote);
+	return ok;
+}
+
+/* ******************************************************************
+ *                    FUSION DE VALORES NUMERICOS
+ * *****************************************************************/
+
+// la suma se hace sin signo para que el desborde dé la vuelta en vez de ser indefinido
+static intptr_t fusion_suma(intptr_t actual, intptr_t delta) {
+	return (intptr_t)((uintptr_t)actual + (uintptr_t)delta);
+}
+
+static intptr_t fusion_minimo(intptr_t actual, intptr_t delta) {
+	return delta < actual ? delta : actual;
+}
+
+static intptr_t fusion_maximo(intptr_t actual, intptr_t delta) {
+	return delta > actual ? delta : actual;
+}
+
+/* HyperLogLog dentro del mismo intptr_t: HLL_REGISTROS registros de 4 bits.
+ * El registro lo eligen los bits bajos del hash del elemento y guarda la
+ * mayor cantidad de ceros finales (+1) vista en el resto del hash.
+ */
+#define HLL_REGISTROS (sizeof(intptr_t) * 2)
+#define HLL_BITS_REGISTRO 4
+#define HLL_MAXIMO 15
+
+static unsigned hll_registro(uintptr_t hll, size_t i) {
+	return (unsigned)(hll >> (HLL_BITS_REGISTRO * i)) & HLL_MAXIMO;
+}
+
+static uintptr_t hll_poner(uintptr_t hll, size_t i, unsigned valor) {
+	uintptr_t mascara = (uintptr_t)HLL_MAXIMO << (HLL_BITS_REGISTRO * i);
+	return (hll & ~mascara) | ((uintptr_t)valor << (HLL_BITS_REGISTRO * i));
+}
+
+static intptr_t fusion_hll_agregar(intptr_t actual, intptr_t elemento) {
+	uintptr_t hash = (uintptr_t)elemento;
+	size_t i = hash % HLL_REGISTROS;
+	uintptr_t resto = hash / HLL_REGISTROS;
+	unsigned rango = 1;
+	while (rango < HLL_MAXIMO && !(resto & 1)) {
+		resto >>= 1;
+		rango++;
+	}
+	if (rango > hll_registro((uintptr_t)actual, i)) {
+		return (intptr_t)hll_poner((uintptr_t)actual, i, rango);
+	}
+	return actual;
+}
+
+static intptr_t fusion_hll_union(intptr_t actual, intptr_t otro) {
+	uintptr_t resultado = (uintptr_t)actual;
+	for (size_t i = 0; i < HLL_REGISTROS; i++) {
+		unsigned registro = hll_registro((uintptr_t)otro, i);
+		if (registro > hll_registro(resultado, i)) {
+			resultado = hll_poner(resultado, i, registro);
+		}
+	}
+	return (intptr_t)resultado;
+}
+
+const hash_fusion_t HASH_FUSION_SUMA = {0, fusion_suma};
+const hash_fusion_t HASH_FUSION_MINIMO = {INTPTR_MAX, fusion_minimo};
+const hash_fusion_t HASH_FUSION_MAXIMO = {INTPTR_MIN, fusion_maximo};
+const hash_fusion_t HASH_FUSION_HLL = {0, fusion_hll_agregar};
+const hash_fusion_t HASH_FUSION_HLL_UNION = {0, fusion_hll_union};
+
+double hash_hll_estimar(intptr_t hll) {
+	double m = (double)HLL_REGISTROS;
+	double suma = 0;
+	size_t vacios = 0;
+	for (size_t i = 0; i < HLL_REGISTROS; i++) {
+		unsigned registro = hll_registro((uintptr_t)hll, i);
+		suma += ldexp(1.0, -(int)registro);
+		vacios += registro == 0;
+	}
+	double estimacion = 0.673 * m * m / suma;
+	// con pocos elementos es más precisa la cuenta de registros vacíos
+	if (estimacion <= 2.5 * m && vacios > 0) {
+		estimacion = m * log(m / (double)vacios);
+	}
+	return estimacion;
+}
+
+static void* numero_a_dato(intptr_t numero) {
+	return (void*)numero;
+}
+
+static intptr_t dato_a_numero(const void* dato) {
+	return (intptr_t)dato;
+}
+
+bool hash_fusionar(hash_t *hash, const char *clave, intptr_t delta, const hash_fusion_t *fusion) {
+	if (hash->congelado || hash->multiple) {
+		return false;
+	}
+	unsigned long h = hash_funcion(clave);
+	nodo_t* nodo = buscar_nodo_hasheado(hash, clave, h);
+	if (nodo) {
+		nodo->dato = numero_a_dato(fusion->fusionar(dato_a_numero(nodo->dato), delta));
+		return true;
+	}
+	return insertar_nueva(hash, clave, numero_a_dato(fusion->fusionar(fusion->neutro, delta)), h) != NULL;
+}
+
+typedef struct union_parcial {
+	hash_t* destino;
+	const hash_t* origen;
+	const hash_fusion_t* fusion;
+	size_t desde;     // baldes de origen [desde, hasta)
+	size_t hasta;
+	size_t agregadas;
+	bool ok;
+} union_parcial_t;
+
+/* Une los baldes [desde, hasta) de origen. Como la capacidad del destino es
+ * múltiplo de la del origen, cada balde b de origen sólo vuelca en baldes
+ * del destino congruentes con b: dos hilos con rangos distintos nunca tocan
+ * el mismo balde del destino y no hace falta ningún lock.
+ */
+static void* unir_baldes(void* extra) {
+	union_parcial_t* parcial = extra;
+	hash_t* destino = parcial->destino;
+	const hash_fusion_t* fusion = parcial->fusion;
+	for (size_t i = parcial->desde; i < parcial->hasta; i++) {
+		for (const balde_t* bloque = &parcial->origen->tabla[i]; bloque; bloque = bloque->desborde) {
+			for (size_t j = 0; j < bloque->cantidad; j++) {
+				nodo_t* otro = bloque->entradas[j];
+				intptr_t valor = dato_a_numero(otro->dato);
+				nodo_t* nodo = buscar_en_balde(balde_de(destino, otro->hash), otro->hash, otro->clave, NULL, NULL);
+				if (nodo) {
+					nodo->dato = numero_a_dato(fusion->fusionar(dato_a_numero(nodo->dato), valor));
+					continue;
+				}
+				nodo = crear_nodo_hasheado(destino, otro->clave, numero_a_dato(fusion->fusionar(fusion->neutro, valor)), otro->hash);
+				if (!nodo || !balde_insertar(destino, balde_de(destino, nodo->hash), nodo, NULL)) {
+					if (nodo) {
+						liberar_nodo(destino, nodo);
+					}
+					parcial->ok = false;
+					return NULL;
+				}
+				parcial->agregadas++;
+			}
+		}
+	}
+	return NULL;
+}
+
+/* Corre trabajo sobre cada uno de los cant_hilos parciales (de tam_parcial
+ * bytes cada uno), el primero en este hilo. Si no se puede lanzar un hilo,
+ * su parcial también lo hace este.
+ */
+static void correr_en_hilos(void* (*trabajo)(void*), void* parciales, size_t tam_parcial, size_t cant_hilos) {
+	pthread_t hilos[MAX_HILOS_UNIR];
+	size_t lanzados = 0;
+	char* parcial = parciales;
+	for (size_t i = 1; i < cant_hilos; i++) {
+		if (pthread_create(&hilos[i], NULL, trabajo, parcial + i * tam_parcial) == 0) {
+			lanzados |= (size_t)1 << i;
+		}
+	}
+	for (size_t i = 0; i < cant_hilos; i++) {
+		if (lanzados & ((size_t)1 << i)) {
+			pthread_join(hilos[i], NULL);
+		} else {
+			trabajo(parcial + i * tam_parcial);
+		}
+	}
+}
+
+static size_t hilos_para_unir(size_t claves) {
+	long procesadores = sysconf(_SC_NPROCESSORS_ONLN);
+	size_t hilos = claves / MIN_CLAVES_POR_HILO;
+	if (procesadores > 0 && hilos > (size_t)procesadores) {
+		hilos = (size_t)procesadores;
+	}
+	if (hilos > MAX_HILOS_UNIR) {
+		hilos = MAX_HILOS_UNIR;
+	}
+	return hilos ? hilos : 1;
+}
+
+bool hash_unir(hash_t *destino, const hash_t *origen, const hash_fusion_t *fusion) {
+	if (destino->congelado || origen->congelado || destino->multiple || origen->multiple) {
+		return false;
+	}
+	//el indice ordenado no admite altas concurrentes: se une clave por clave
+	if (destino->indice) {
+		hash_iter_t* iter = hash_iter_crear(origen);
+		bool ok = iter != NULL;
+		for (; ok && !hash_iter_al_final(iter); hash_iter_avanzar(iter)) {
+			const char* clave = hash_iter_ver_actual(iter);
+			ok = hash_fusionar(destino, clave, dato_a_numero(hash_obtener(origen, clave)), fusion);
+		}
+		if (iter) {
+			hash_iter_destruir(iter);
+		}
+		return ok;
+	}
+
+	//se agranda una sola vez para el peor caso (ninguna clave en comun)
+	size_t capacidad = capacidad_para(destino->capacidad, destino->cantidad + origen->cantidad);
+	while (capacidad < origen->capacidad) {
+		capacidad *= 2;
+	}
+	if (capacidad != destino->capacidad && !hash_redimensionar(destino, capacidad)) {
+		return false;
+	}
+
+	union_parcial_t parciales[MAX_HILOS_UNIR];
+	size_t cant_hilos = hilos_para_unir(origen->cantidad);
+	for (size_t i = 0; i < cant_hilos; i++) {
+		parciales[i] = (union_parcial_t){
+			.destino = destino, .origen = origen, .fusion = fusion,
+			.desde = origen->capacidad * i / cant_hilos,
+			.hasta = origen->capacidad * (i + 1) / cant_hilos,
+			.agregadas = 0, .ok = true,
+		};
+	}
+	correr_en_hilos(unir_baldes, parciales, sizeof(union_parcial_t), cant_hilos);
+	bool ok = true;
+	for (size_t i = 0; i < cant_hilos; i++) {
+		destino->cantidad += parciales[i].agregadas;
+		ok &= parciales[i].ok;
+	}
+	return ok;
+}
+
+/* Borra un elemento del hash y devuelve el dato asociado.  Devuelve
+ * NULL si el dato no estaba.
+ * Pre: La estructura hash fue inicializada
+ * Post: El elemento fue borrado de la estructura y se lo devolvió,
+ * en el caso de que estuviera guardado.
+ */
+void *hash_borrar(hash_t *hash, const char *clave){
+	if (hash->congelado) {
+		return NULL;
+	}
+	unsigned long h = hash_funcion(clave);
+	balde_t* balde = balde_de(hash, h);
+	const balde_t* bloque;
+	size_t pos;
+	nodo_t* nodo = buscar_en_balde(balde, h, clave, &bloque, &pos);
+	if (!nodo) {
+		return NULL;
+	}
+	balde_quitar(hash, balde, (balde_t*)bloque, pos);
+	if (hash->indice) {
+		indice_borrar(hash->indice, nodo->clave);
+	}
+	void* dato = nodo->dato;
+	if (hash->multiple) {
+		destruir_valores(hash, dato);
+		dato = NULL;
+	}
+	liberar_nodo(hash, nodo);
+	hash->cantidad--;
+	// achicar sólo ahorra memoria, así que si no hay para la tabla nueva el
+	// borrado vale igual
+	if (hash->politica.achicar_al_borrar) {
+		hash_achicar_paso(hash);
+	}
+	
+	return dato;
+}
+
+/* Obtiene el valor de un elemento del hash, si la clave no se encuentra
+ * devuelve NULL.
+ * Pre: La estructura hash fue inicializada
+ */
+void *hash_obtener(const hash_t *hash, const char *clave){
+	size_t posicion;
+	if (hash->congelado) {
+		return congelado_buscar(hash->congelado, clave, &posicion) ? congelado_dato(hash->congelado, posicion) : NULL;
+	}
+	nodo_t* nodo = buscar_nodo(hash, clave);
+	return nodo ? dato_de(hash, nodo) : NULL;
+}
+
+/* Determina si clave pertenece o no al hash.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_pertenece(const hash_t *hash, const char *clave){
+	size_t posicion;
+	if (hash->congelado) {
+		return congelado_buscar(hash->congelado, clave, &posicion);
+	}
+	return buscar_nodo(hash, clave) != NULL;
+}
+
+/* ******************************************************************
+ *                    POLITICA DE MEMORIA
+ * *****************************************************************/
+
+const hash_politica_t HASH_POLITICA_DEFECTO = {
+	.achicar_debajo_de = MIN_ESPACIO_USADO,
+	.achicar_al_borrar = true,
+};
+
+void hash_politica_memoria(hash_t *hash, const hash_politica_t *politica) {
+	hash->politica = *politica;
+	if (hash->politica.achicar_debajo_de > MAX_ACHICAR_DEBAJO_DE) {
+		hash->politica.achicar_debajo_de = MAX_ACHICAR_DEBAJO_DE;
+	}
+}
+
+/* La comparación es en punto flotante: con la división entera de antes la
+ * ocupación de una tabla con menos claves que baldes daba 0, y la de
+ * cualquier otra al menos 1.
+ */
+static bool sobra_tabla(const hash_t* hash) {
+	return hash->capacidad > CAPACIDAD_INICIAL
+		&& (double)hash->cantidad < hash->politica.achicar_debajo_de * (double)hash->capacidad;
+}
+
+bool hash_achicar_paso(hash_t *hash) {
+	if (hash->congelado || !sobra_tabla(hash)) {
+		return false;
+	}
+	return hash_redimensionar(hash, hash->capacidad / 2);
+}
+
+void hash_liberar_memoria(hash_t *hash) {
+	while (hash_achicar_paso(hash)) {
+	}
+#ifdef __GLIBC__
+	//lo que devuelve el hash vuelve a malloc: que malloc se lo devuelva al sistema
+	if (hash->asignador.pedir == pedir_malloc) {
+		malloc_trim(0);
+	}
+#endif
+}
+
+void hash_diferir_destruccion(hash_t *hash, epoca_t *epoca) {
+	hash->epoca = epoca;
+}
+
+size_t hash_recolectar(hash_t *hash, size_t presupuesto) {
+	return hash->epoca ? epoca_recolectar(hash->epoca, presupuesto) : 0;
+}
+
+size_t hash_cantidad(const hash_t *hash) {
+	return hash->cantidad;
+}
+
+//como buscar_en_balde, pero la clave buscada es prefijo seguido de sufijo
+static nodo_t* buscar_partida(const balde_t* balde, unsigned long h, const char* prefijo, size_t largo_prefijo, const char* sufijo) {
+	uint8_t buscada = etiqueta(h);
+	for (; balde; balde = balde->desborde) {
+		for (uint64_t iguales = coincidencias(balde, buscada); iguales; iguales &= iguales - 1) {
+			nodo_t* nodo = balde->entradas[primera_coincidencia(iguales)];
+			if (nodo->hash == h
+					&& strncmp(nodo->clave, prefijo, largo_prefijo) == 0
+					&& strcmp(nodo->clave + largo_prefijo, sufijo) == 0) {
+				return nodo;
+			}
+		}
+	}
+	return NULL;
+}
+
+/* El congelado hashea la clave entera con su propia función: se arma cada
+ * clave completa en un solo buffer y se busca como cualquier otra.
+ */
+static void obtener_congelado_con_prefijo(const hash_t* hash, const char* prefijo, size_t largo_prefijo, const char** sufijos, size_t cantidad, void** datos) {
+	size_t mayor = 0;
+	for (size_t i = 0; i < cantidad; i++) {
+		size_t largo = strlen(sufijos[i]);
+		mayor = largo > mayor ? largo : mayor;
+	}
+	char* clave = malloc(largo_prefijo + mayor + 1);
+	for (size_t i = 0; i < cantidad; i++) {
+		datos[i] = NULL;
+		if (clave) {
+			memcpy(clave, prefijo, largo_prefijo);
+			strcpy(clave + largo_prefijo, sufijos[i]);
+			datos[i] = hash_obtener(hash, clave);
+		}
+	}
+	free(clave);
+}
+
+void hash_obtener_con_prefijo(const hash_t *hash, const char *prefijo, const char **sufijos, size_t cantidad, void **datos) {
+	size_t largo_prefijo = strlen(prefijo);
+	if (hash->congelado) {
+		obtener_congelado_con_prefijo(hash, prefijo, largo_prefijo, sufijos, cantidad, datos);
+		return;
+	}
+	hash_estado_t comun;
+	hash_estado_iniciar(&comun);
+	hash_estado_agregar(&comun, prefijo, largo_prefijo);
+	for (size_t i = 0; i < cantidad; i++) {
+		hash_estado_t estado = comun;
+		hash_estado_agregar(&estado, sufijos[i], strlen(sufijos[i]));
+		unsigned long h = hash_estado_terminar(&estado);
+		nodo_t* nodo = buscar_partida(balde_de(hash, h), h, prefijo, largo_prefijo, sufijos[i]);
+		datos[i] = nodo ? dato_de(hash, nodo) : NULL;
+	}
+}
+
+void destruir_nodo(const hash_t* hash, nodo_t* nodo){
+	if (hash->multiple) {
+		destruir_valores(hash, nodo->dato);
+	} else {
+		descartar_dato(hash, nodo->dato);
+	}
+	liberar_nodo(hash, nodo);
+}
+
+/* Destruye la estructura liberando la memoria pedida y llamando a la función
+ * destruir para cada par (clave, dato).
+ * Pre: La estructura hash fue inicializada
+ * Post: La estructura hash fue destruida
+ */
+void hash_destruir(hash_t *hash){
+	if (hash->congelado) {
+		for (size_t i = 0; hash->destruir_dato && i < hash->cantidad; i++) {
+			descartar_dato(hash, congelado_dato(hash->congelado, i));
+		}
+		congelado_destruir(hash->congelado);
+		devolver(hash, hash, sizeof(hash_t));
+		return;
+	}
+	for (size_t i = 0; i < hash->capacidad;i++){
+		for (balde_t* bloque = &hash->tabla[i]; bloque; bloque = bloque->desborde) {
+			for (size_t j = 0; j < bloque->cantidad; j++) {
+				destruir_nodo(hash, bloque->entradas[j]);
+			}
+		}
+		liberar_bloques(hash, hash->tabla[i].desborde);
+	}
+	if (hash->indice) {
+		indice_destruir(hash->indice);
+	}
+	devolver_tabla(hash, hash->tabla, hash->capacidad);
+	devolver(hash, hash, sizeof(hash_t));
+}
+
+typedef struct rango_extra {
+	bool (*visitar)(const char*, void*, void*);
+	void* extra;
+} rango_extra_t;
+
+//el indice guarda nodos: se le pasa al usuario el dato del nodo
+static bool visitar_nodo(const char* clave, void* valor, void* extra) {
+	rango_extra_t* rango = extra;
+	nodo_t* nodo = valor;
+	return rango->visitar(clave, nodo->dato, rango->extra);
+}
+
+void hash_rango(const hash_t *hash, const char *desde, const char *hasta,
+		bool visitar(const char *clave, void *dato, void *extra), void *extra) {
+	//un hash sin orden (o congelado) no tiene indice: no visita nada
+	if (!hash->indice) {
+		return;
+	}
+	rango_extra_t rango = {visitar, extra};
+	indice_rango(hash->indice, desde, hasta, visitar_nodo, &rango);
+}
 
 
 /* ******************************************************************
- *                			HASH FUNCTION
+ *                    HASH CONGELADO
  * *****************************************************************/
-//One-at-a-time hash
-
-unsigned long funcion_hash(const char* clave, size_t capacidad) {
-	unsigned h = 0;
 
-	for (int i=0; i<capacidad; i++) {
-		h += (unsigned)clave[i];
-		h += (h << 10);
-		h ^= (h >> 6);
+bool hash_congelar(hash_t *hash) {
+	if (hash->congelado) {
+		return true;
 	}
+	if (hash->indice || hash->multiple) {
+		return false;
+	}
+	const char** claves = malloc((hash->cantidad + 1) * sizeof(char*));
+	void** datos = malloc((hash->cantidad + 1) * sizeof(void*));
+	if (!claves || !datos) {
+		free(claves);
+		free(datos);
+		return false;
+	}
+	size_t cantidad = 0;
+	for (size_t i = 0; i < hash->capacidad; i++) {
+		for (const balde_t* bloque = &hash->tabla[i]; bloque; bloque = bloque->desborde) {
+			for (size_t j = 0; j < bloque->cantidad; j++) {
+				claves[cantidad] = bloque->entradas[j]->clave;
+				datos[cantidad] = bloque->entradas[j]->dato;
+				cantidad++;
+			}
+		}
+	}
+	congelado_t* congelado = congelado_crear(claves, datos, cantidad);
+	free(claves);
+	free(datos);
+	if (!congelado) {
+		return false;
+	}
+	//el congelado tiene su copia de las claves: los nodos y la tabla sobran
+	for (size_t i = 0; i < hash->capacidad; i++) {
+		for (balde_t* bloque = &hash->tabla[i]; bloque; bloque = bloque->desborde) {
+			for (size_t j = 0; j < bloque->cantidad; j++) {
+				liberar_nodo(hash, bloque->entradas[j]);
+			}
+		}
+		liberar_bloques(hash, hash->tabla[i].desborde);
+	}
+	devolver_tabla(hash, hash->tabla, hash->capacidad);
+	hash->tabla = NULL;
+	hash->capacidad = 0;
+	hash->congelado = congelado;
+	return true;
+}
 
-	h += (h << 3);
-	h ^= (h >> 11);
-	h += (h << 15);
-
-	return h%capacidad;
+bool hash_congelado_escribir(const hash_t *hash, const char *ruta) {
+	return hash->congelado && congelado_escribir(hash->congelado, ruta);
 }
 
+hash_t *hash_congelado_mapear(const char *ruta) {
+	hash_t* hash = pedir_malloc(sizeof(hash_t), TAM_LINEA_CACHE, NULL);
+	if (!hash) {
+		return NULL;
+	}
+	hash->asignador = ASIGNADOR_MALLOC;
+	hash->congelado = congelado_mapear(ruta);
+	if (!hash->congelado) {
+		devolver(hash, hash, sizeof(hash_t));
+		return NULL;
+	}
+	hash->tabla = NULL;
+	hash->cantidad = congelado_cantidad(hash->congelado);
+	hash->capacidad = 0;
+	hash->destruir_dato = NULL;
+	hash->indice = NULL;
+	hash->politica = HASH_POLITICA_DEFECTO;
+	hash->multiple = false;
+	hash->epoca = NULL;
+	return hash;
+}
 
 
 
 /* ******************************************************************
- *                    PRIMITIVAS DEL HASH
+ *                    CLONAR Y SERIALIZAR
  * *****************************************************************/
 
-hash_t *hash_crear(hash_destruir_dato_t destruir_dato) {
+#define MAGIA_SERIAL "HASHSERI"
+#define VERSION_SERIAL 1
+#define TAM_BUFFER_SERIAL (64 * 1024)
+// la tabla se crea de entrada para a lo sumo tantas claves; si el flujo
+// trae más crece al leerlas, así una cabecera falsa no reserva gigas
+#define MAX_CLAVES_ANTICIPADAS (1 << 20)
 
-	hash_t* tabla_hash = malloc(sizeof(hash_t));
+typedef struct cabecera_serial {
+	char magia[8];
+	uint32_t version;
+	uint32_t ordenado;
+	uint64_t cantidad;
+	uint64_t capacidad;
+} cabecera_serial_t;
 
-	if (!tabla_hash) {
-		return NULL;
+//copia el nodo con su hash guardado; el dato lo pone quien llama
+static nodo_t* copiar_nodo(const hash_t* hash, const nodo_t* nodo) {
+	size_t largo = strlen(nodo->clave) + 1;
+	nodo_t* copia = reservar_nodo(hash, largo);
+	if (copia) {
+		memcpy(copia->clave, nodo->clave, largo);
+		copia->hash = nodo->hash;
 	}
+	return copia;
+}
 
-	tabla_hash->tabla = malloc(CAPACIDAD_INICIAL * sizeof(lista_t*));
+/* Copia cada bloque de la cadena con sus etiquetas y le va agregando los
+ * nodos de a uno, así si falta memoria el clon queda completo hasta ahí y
+ * se puede destruir.
+ */
+static bool clonar_balde(hash_t* clon, balde_t* destino, const balde_t* balde, hash_copiar_dato_t copiar_dato) {
+	for (const balde_t* bloque = balde; bloque; bloque = bloque->desborde) {
+		if (bloque != balde) {
+			balde_t* nuevo = crear_bloque(clon);
+			if (!nuevo) {
+				return false;
+			}
+			destino->desborde = nuevo;
+			destino = nuevo;
+		}
+		memcpy(destino->etiquetas, bloque->etiquetas, sizeof(bloque->etiquetas));
+		for (size_t j = 0; j < bloque->cantidad; j++) {
+			const nodo_t* nodo = bloque->entradas[j];
+			nodo_t* copia = copiar_nodo(clon, nodo);
+			if (!copia) {
+				return false;
+			}
+			copia->dato = copiar_dato ? copiar_dato(nodo->dato) : nodo->dato;
+			if (copiar_dato && nodo->dato && !copia->dato) {
+				liberar_nodo(clon, copia);
+				return false;
+			}
+			destino->entradas[destino->cantidad++] = copia;
+			clon->cantidad++;
+		}
+	}
+	return true;
+}
 
-	if (!tabla_hash->tabla){
-		free(tabla_hash);
-		return NULL;
+static bool indexar(hash_t* hash) {
+	hash->indice = indice_crear();
+	if (!hash->indice) {
+		return false;
 	}
+	for (size_t i = 0; i < hash->capacidad; i++) {
+		for (const balde_t* bloque = &hash->tabla[i]; bloque; bloque = bloque->desborde) {
+			for (size_t j = 0; j < bloque->cantidad; j++) {
+				if (!indice_guardar(hash->indice, bloque->entradas[j]->clave, bloque->entradas[j])) {
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
 
-	for (int i = 0; i < CAPACIDAD_INICIAL; i++) {
-		tabla_hash->tabla[i] = lista_crear();
+hash_t *hash_clonar(const hash_t *hash, hash_copiar_dato_t copiar_dato) {
+	if (hash->congelado || hash->multiple) {
+		return NULL;
 	}
-	
-	tabla_hash->cantidad = 0;
-	tabla_hash->capacidad = CAPACIDAD_INICIAL;
-	tabla_hash->destruir_dato = destruir_dato;
-	
-	return tabla_hash;
+	hash_t* clon = pedir(hash, sizeof(hash_t), TAM_LINEA_CACHE);
+	if (!clon) {
+		return NULL;
+	}
+	*clon = *hash;
+	clon->destruir_dato = copiar_dato ? hash->destruir_dato : NULL;
+	clon->indice = NULL;
+	clon->cantidad = 0;
+	clon->tabla = crear_tabla(clon, clon->capacidad);
+	if (!clon->tabla) {
+		devolver(clon, clon, sizeof(hash_t));
+		return NULL;
+	}
+	bool ok = true;
+	for (size_t i = 0; ok && i < hash->capacidad; i++) {
+		ok = clonar_balde(clon, &clon->tabla[i], &hash->tabla[i], copiar_dato);
+	}
+	if (!ok || (hash->indice && !indexar(clon))) {
+		hash_destruir(clon);
+		return NULL;
+	}
+	return clon;
+}
+
+//junta lo escrito en bloques de TAM_BUFFER_SERIAL antes de pasárselo al escritor
+typedef struct salida_serial {
+	const hash_escritor_t* destino;
+	size_t usado;
+	char buffer[TAM_BUFFER_SERIAL];
+} salida_serial_t;
 
+static bool vaciar_salida(salida_serial_t* salida) {
+	bool ok = salida->usado == 0 || salida->destino->escribir(salida->buffer, salida->usado, salida->destino->contexto);
+	salida->usado = 0;
+	return ok;
 }
 
-nodo_t* crear_nodo(const char* clave,void* dato){
-	nodo_t* nodo = malloc(sizeof(nodo_t));
-	if (!nodo){
-		return NULL;
+static bool escribir_en_salida(const void* datos, size_t largo, void* contexto) {
+	salida_serial_t* salida = contexto;
+	if (largo > TAM_BUFFER_SERIAL - salida->usado && !vaciar_salida(salida)) {
+		return false;
 	}
-	nodo->clave = clave;
-	nodo->dato = dato;
-	
-	return nodo;
+	if (largo >= TAM_BUFFER_SERIAL) {
+		return salida->destino->escribir(datos, largo, salida->destino->contexto);
+	}
+	memcpy(salida->buffer + salida->usado, datos, largo);
+	salida->usado += largo;
+	return true;
 }
 
-//va a cada elemento y lo rehashe y lo guarda donde corresponde
-bool hash_redimensionar(hash_t* hash,size_t new_tam){
-	nodo_t* nodo;
-	unsigned long clave_hash;
-	lista_t** new_tablas = malloc(new_tam * sizeof(lista_t*));
-	for (int i = 0; i < new_tam; i++) {
-		new_tablas[i] = lista_crear();
+static bool escribir_nodo(const nodo_t* nodo, const hash_escritor_t* escritor, hash_escribir_dato_t escribir_dato) {
+	uint64_t h = nodo->hash;
+	uint32_t largo = (uint32_t)strlen(nodo->clave);
+	uint64_t numero = (uint64_t)(uintptr_t)nodo->dato;
+	return escritor->escribir(&h, sizeof(h), escritor->contexto)
+		&& escritor->escribir(&largo, sizeof(largo), escritor->contexto)
+		&& escritor->escribir(nodo->clave, largo, escritor->contexto)
+		&& (escribir_dato ? escribir_dato(nodo->dato, escritor) : escritor->escribir(&numero, sizeof(numero), escritor->contexto));
+}
+
+bool hash_serializar(const hash_t *hash, const hash_escritor_t *escritor, hash_escribir_dato_t escribir_dato) {
+	if (hash->congelado || hash->multiple) {
+		return false;
+	}
+	salida_serial_t* salida = malloc(sizeof(salida_serial_t));
+	if (!salida) {
+		return false;
+	}
+	salida->destino = escritor;
+	salida->usado = 0;
+	hash_escritor_t intermedio = {escribir_en_salida, salida};
+
+	cabecera_serial_t cabecera;
+	memset(&cabecera, 0, sizeof(cabecera));
+	memcpy(cabecera.magia, MAGIA_SERIAL, sizeof(cabecera.magia));
+	cabecera.version = VERSION_SERIAL;
+	cabecera.ordenado = hash->indice != NULL;
+	cabecera.cantidad = hash->cantidad;
+	cabecera.capacidad = hash->capacidad;
+	bool ok = escribir_en_salida(&cabecera, sizeof(cabecera), salida);
+	for (size_t i = 0; ok && i < hash->capacidad; i++) {
+		for (const balde_t* bloque = &hash->tabla[i]; ok && bloque; bloque = bloque->desborde) {
+			for (size_t j = 0; ok && j < bloque->cantidad; j++) {
+				ok = escribir_nodo(bloque->entradas[j], &intermedio, escribir_dato);
+			}
+		}
 	}
-	for(int i = 0;i < hash->capacidad;i++){
-		while (!lista_esta_vacia(hash->tabla[i])){
-			nodo = lista_borrar_primero(hash->tabla[i]);
-			clave_hash = funcion_hash(nodo->clave,new_tam);
-			lista_insertar_ultimo(new_tablas[clave_hash],nodo);
+	ok = ok && vaciar_salida(salida);
+	free(salida);
+	return ok;
+}
+
+//lee del lector de a bloques de TAM_BUFFER_SERIAL
+typedef struct entrada_serial {
+	const hash_lector_t* origen;
+	size_t inicio;
+	size_t fin;
+	char buffer[TAM_BUFFER_SERIAL];
+} entrada_serial_t;
+
+//completa largo bytes salvo que el origen se termine
+static size_t leer_de_entrada(void* destino, size_t largo, void* contexto) {
+	entrada_serial_t* entrada = contexto;
+	const hash_lector_t* origen = entrada->origen;
+	size_t leidos = 0;
+	while (leidos < largo) {
+		if (entrada->inicio == entrada->fin) {
+			size_t faltan = largo - leidos;
+			if (faltan >= TAM_BUFFER_SERIAL) {
+				size_t directos = origen->leer((char*)destino + leidos, faltan, origen->contexto);
+				if (directos == 0) {
+					break;
+				}
+				leidos += directos;
+				continue;
+			}
+			entrada->inicio = 0;
+			entrada->fin = origen->leer(entrada->buffer, TAM_BUFFER_SERIAL, origen->contexto);
+			if (entrada->fin == 0) {
+				break;
+			}
+		}
+		size_t tramo = entrada->fin - entrada->inicio;
+		if (tramo > largo - leidos) {
+			tramo = largo - leidos;
 		}
-		lista_destruir(hash->tabla[i], NULL);
+		memcpy((char*)destino + leidos, entrada->buffer + entrada->inicio, tramo);
+		entrada->inicio += tramo;
+		leidos += tramo;
 	}
-	hash->capacidad = new_tam;
-	free(hash->tabla);
-	hash->tabla = new_tablas;
-	return true;
+	return leidos;
 }
 
-/* Guarda un elemento en el hash, si la clave ya se encuentra en la
- * estructura, la reemplaza. De no poder guardarlo devuelve false.
- * Pre: La estructura hash fue inicializada
- * Post: Se almacenó el par (clave, dato)
+static bool leer_exacto(const hash_lector_t* lector, void* destino, size_t largo) {
+	return lector->leer(destino, largo, lector->contexto) == largo;
+}
+
+static bool cabecera_valida(const cabecera_serial_t* cabecera) {
+	return memcmp(cabecera->magia, MAGIA_SERIAL, sizeof(cabecera->magia)) == 0
+		&& cabecera->version == VERSION_SERIAL
+		&& cabecera->ordenado <= 1
+		&& cabecera->capacidad > 0
+		&& (cabecera->capacidad & (cabecera->capacidad - 1)) == 0;
+}
+
+/* Lee un nodo y lo pone al final de su balde, en el mismo orden en que
+ * estaba en la cadena original.
  */
-bool hash_guardar(hash_t *hash, const char *clave, void *dato){
-	// Si nos pasamos del limite hay que redimensionarlo
-	if (hash->cantidad/hash->capacidad > MAX_ESPACIO_USADO){
-		if (!hash_redimensionar(hash,hash->capacidad*2)){
-			return false;
-		}
+static bool leer_nodo(hash_t* hash, const hash_lector_t* lector, hash_leer_dato_t leer_dato) {
+	size_t capacidad = capacidad_para(hash->capacidad, hash->cantidad + 1);
+	if (capacidad != hash->capacidad && !hash_redimensionar(hash, capacidad)) {
+		return false;
+	}
+	uint64_t h;
+	uint32_t largo;
+	if (!leer_exacto(lector, &h, sizeof(h)) || !leer_exacto(lector, &largo, sizeof(largo))) {
+		return false;
+	}
+	nodo_t* nodo = reservar_nodo(hash, (size_t)largo + 1);
+	if (!nodo) {
+		return false;
+	}
+	uint64_t numero = 0;
+	// una clave con un '\0' en el medio no puede venir de hash_serializar
+	if (!leer_exacto(lector, nodo->clave, largo) || memchr(nodo->clave, '\0', largo)) {
+		devolver(hash, nodo, sizeof(nodo_t) + (size_t)largo + 1);
+		return false;
+	}
+	nodo->clave[largo] = '\0';
+	nodo->hash = (unsigned long)h;
+	nodo->dato = NULL;
+	// una clave repetida tampoco: quedaría una copia que hash_borrar no saca
+	if (buscar_en_balde(balde_de(hash, nodo->hash), nodo->hash, nodo->clave, NULL, NULL)) {
+		liberar_nodo(hash, nodo);
+		return false;
 	}
-	unsigned long clave_hash = funcion_hash(clave,hash->capacidad);
-	nodo_t* nodo = crear_nodo(clave,dato);
-	if(!lista_insertar_ultimo(hash->tabla[clave_hash],nodo)){
-		//si fallo al insertarlo por algun motivo
+	if (leer_dato ? !leer_dato(lector, &nodo->dato) : !leer_exacto(lector, &numero, sizeof(numero))) {
+		liberar_nodo(hash, nodo);
+		return false;
+	}
+	if (!leer_dato) {
+		nodo->dato = (void*)(uintptr_t)numero;
+	}
+	if (hash->indice && !indice_guardar(hash->indice, nodo->clave, nodo)) {
+		destruir_nodo(hash, nodo);
+		return false;
+	}
+	if (!balde_insertar(hash, balde_de(hash, nodo->hash), nodo, NULL)) {
+		if (hash->indice) {
+			indice_borrar(hash->indice, nodo->clave);
+		}
+		destruir_nodo(hash, nodo);
 		return false;
 	}
 	hash->cantidad++;
-	
 	return true;
 }
 
-/* Borra un elemento del hash y devuelve el dato asociado.  Devuelve
- * NULL si el dato no estaba.
- * Pre: La estructura hash fue inicializada
- * Post: El elemento fue borrado de la estructura y se lo devolvió,
- * en el caso de que estuviera guardado.
+hash_t *hash_deserializar(const hash_lector_t *lector, hash_destruir_dato_t destruir_dato, hash_leer_dato_t leer_dato) {
+	entrada_serial_t* entrada = malloc(sizeof(entrada_serial_t));
+	if (!entrada) {
+		return NULL;
+	}
+	entrada->origen = lector;
+	entrada->inicio = 0;
+	entrada->fin = 0;
+	hash_lector_t intermedio = {leer_de_entrada, entrada};
+
+	cabecera_serial_t cabecera;
+	hash_t* hash = NULL;
+	if (leer_exacto(&intermedio, &cabecera, sizeof(cabecera)) && cabecera_valida(&cabecera)) {
+		hash = cabecera.ordenado ? hash_crear_ordenado(destruir_dato) : hash_crear(destruir_dato);
+	}
+	// la capacidad sale de la cantidad: la de la cabecera no se usa
+	size_t anticipadas = cabecera.cantidad < MAX_CLAVES_ANTICIPADAS ? (size_t)cabecera.cantidad : MAX_CLAVES_ANTICIPADAS;
+	size_t capacidad = hash ? capacidad_para(hash->capacidad, anticipadas) : 0;
+	bool ok = hash && (hash->capacidad == capacidad || hash_redimensionar(hash, capacidad));
+	for (uint64_t i = 0; ok && i < cabecera.cantidad; i++) {
+		ok = leer_nodo(hash, &intermedio, leer_dato);
+	}
+	free(entrada);
+	if (hash && !ok) {
+		hash_destruir(hash);
+		return NULL;
+	}
+	return hash;
+}
+
+
+/* ******************************************************************
+ *                    CONJUNTOS Y JOIN
+ * *****************************************************************/
+
+typedef struct filtro_parcial {
+	hash_t* resultado;
+	const hash_t* recorrido;  // se recorren sus baldes [desde, hasta)
+	const hash_t* otro;       // NULL: pasan todas
+	bool comunes;             // pasan las que están en otro, o las que no
+	size_t desde;
+	size_t hasta;
+	size_t agregadas;
+	bool ok;
+} filtro_parcial_t;
+
+/* Copia al resultado las claves de los baldes [desde, hasta) de recorrido
+ * que pasan el filtro. Usa el hash guardado en cada nodo para buscar en
+ * otro y para el nodo nuevo, así ninguna clave se vuelve a hashear. Como
+ * en unir_baldes, la capacidad del resultado es múltiplo de la de
+ * recorrido y los hilos no se pisan.
  */
-void *hash_borrar(hash_t *hash, const char *clave){
-	// Si nos pasamos del limite hay que redimensionarlo
-	if (hash->cantidad/hash->capacidad < MIN_ESPACIO_USADO && hash->capacidad > CAPACIDAD_INICIAL){
-		if (!hash_redimensionar(hash,hash->capacidad/2)){
-			return NULL;
+static void* filtrar_baldes(void* extra) {
+	filtro_parcial_t* parcial = extra;
+	hash_t* resultado = parcial->resultado;
+	const hash_t* otro = parcial->otro;
+	for (size_t i = parcial->desde; i < parcial->hasta; i++) {
+		for (const balde_t* bloque = &parcial->recorrido->tabla[i]; bloque; bloque = bloque->desborde) {
+			for (size_t j = 0; j < bloque->cantidad; j++) {
+				const nodo_t* nodo = bloque->entradas[j];
+				bool esta = otro && buscar_en_balde(balde_de(otro, nodo->hash), nodo->hash, nodo->clave, NULL, NULL);
+				if (esta != parcial->comunes) {
+					continue;
+				}
+				nodo_t* copia = crear_nodo_hasheado(resultado, nodo->clave, nodo->dato, nodo->hash);
+				if (!copia || !balde_insertar(resultado, balde_de(resultado, copia->hash), copia, NULL)) {
+					if (copia) {
+						liberar_nodo(resultado, copia);
+					}
+					parcial->ok = false;
+					return NULL;
+				}
+				parcial->agregadas++;
+			}
 		}
 	}
-	unsigned long clave_hash = funcion_hash(clave,hash->capacidad);
-	lista_iter_t* iter = lista_iter_crear(hash->tabla[clave_hash]);
-	nodo_t* nodo = lista_iter_ver_actual(iter);
-	while(!lista_iter_al_final(iter) && nodo->clave != clave){
-		//iterar hasta encontrar la clave
-		nodo = lista_iter_ver_actual(iter);
-		lista_iter_avanzar(iter);
+	return NULL;
+}
+
+static bool filtrar(hash_t* resultado, const hash_t* recorrido, const hash_t* otro, bool comunes) {
+	filtro_parcial_t parciales[MAX_HILOS_UNIR];
+	size_t cant_hilos = hilos_para_unir(recorrido->cantidad);
+	for (size_t i = 0; i < cant_hilos; i++) {
+		parciales[i] = (filtro_parcial_t){
+			.resultado = resultado, .recorrido = recorrido, .otro = otro, .comunes = comunes,
+			.desde = recorrido->capacidad * i / cant_hilos,
+			.hasta = recorrido->capacidad * (i + 1) / cant_hilos,
+			.agregadas = 0, .ok = true,
+		};
 	}
-	if(lista_iter_al_final(iter)){
-		return NULL;
+	correr_en_hilos(filtrar_baldes, parciales, sizeof(filtro_parcial_t), cant_hilos);
+	bool ok = true;
+	for (size_t i = 0; i < cant_hilos; i++) {
+		resultado->cantidad += parciales[i].agregadas;
+		ok &= parciales[i].ok;
 	}
-	nodo = lista_iter_borrar(iter);
-	void* dato = nodo->dato;
-	free(nodo);
-	lista_iter_destruir(iter);
-	hash->cantidad--;
-	
-	return dato;
+	return ok;
 }
 
-/* Obtiene el valor de un elemento del hash, si la clave no se encuentra
- * devuelve NULL.
- * Pre: La estructura hash fue inicializada
+/* Crea el resultado ya del tamaño de su peor caso (cantidad claves) y con
+ * capacidad múltiplo de la de a y b, para poder llenarlo en paralelo.
  */
-void *hash_obtener(const hash_t *hash, const char *clave){
-	unsigned long clave_hash = funcion_hash(clave,hash->capacidad);
-	lista_iter_t* iter = lista_iter_crear(hash->tabla[clave_hash]);
-	nodo_t* nodo = lista_iter_ver_actual(iter);
-	while(!lista_iter_al_final(iter) && nodo->clave != clave){
-		//iterar hasta encontrar la clave
-		nodo = lista_iter_ver_actual(iter);
-		lista_iter_avanzar(iter);
+static hash_t* crear_resultado(const hash_t* a, const hash_t* b, size_t cantidad) {
+	if (a->congelado || b->congelado || a->multiple || b->multiple) {
+		return NULL;
+	}
+	hash_t* resultado = hash_crear(NULL);
+	if (!resultado) {
+		return NULL;
 	}
-	if(lista_iter_al_final(iter)){
+	size_t capacidad = capacidad_para(resultado->capacidad, cantidad);
+	while (capacidad < a->capacidad || capacidad < b->capacidad) {
+		capacidad *= 2;
+	}
+	if (capacidad != resultado->capacidad && !hash_redimensionar(resultado, capacidad)) {
+		hash_destruir(resultado);
 		return NULL;
 	}
-	lista_iter_destruir(iter);
-	return nodo->dato;
+	return resultado;
 }
 
-/* Determina si clave pertenece o no al hash.
- * Pre: La estructura hash fue inicializada
- */
-bool hash_pertenece(const hash_t *hash, const char *clave){
-	unsigned long clave_hash = funcion_hash(clave,hash->capacidad);
-	lista_iter_t* iter = lista_iter_crear(hash->tabla[clave_hash]);
-	nodo_t* nodo;
-	while(!lista_iter_al_final(iter)){
-		nodo = lista_iter_ver_actual(iter);
-		if (nodo->clave == clave){
-			return true;
-		}
-		//iterar hasta encontrar la clave
-		lista_iter_avanzar(iter);
+hash_t *hash_interseccion(const hash_t *a, const hash_t *b) {
+	hash_t* resultado = crear_resultado(a, b, a->cantidad < b->cantidad ? a->cantidad : b->cantidad);
+	if (resultado && !filtrar(resultado, a, b, true)) {
+		hash_destruir(resultado);
+		return NULL;
 	}
-	return false;	
+	return resultado;
 }
 
-size_t hash_cantidad(const hash_t *hash) {
-	return hash->cantidad;
+hash_t *hash_union(const hash_t *a, const hash_t *b) {
+	hash_t* resultado = crear_resultado(a, b, a->cantidad + b->cantidad);
+	if (resultado && (!filtrar(resultado, a, NULL, false) || !filtrar(resultado, b, a, false))) {
+		hash_destruir(resultado);
+		return NULL;
+	}
+	return resultado;
 }
 
-void destruir_nodo(void* nodo,void destruir_dato(void*)){
-	nodo_t* nodo_cast = nodo;
-	if (destruir_dato){
-		destruir_dato(nodo_cast->dato);
+hash_t *hash_diferencia(const hash_t *a, const hash_t *b) {
+	hash_t* resultado = crear_resultado(a, b, a->cantidad);
+	if (resultado && !filtrar(resultado, a, b, false)) {
+		hash_destruir(resultado);
+		return NULL;
 	}
-	free(nodo);
+	return resultado;
 }
 
-/* Destruye la estructura liberando la memoria pedida y llamando a la función
- * destruir para cada par (clave, dato).
- * Pre: La estructura hash fue inicializada
- * Post: La estructura hash fue destruida
+/* Join por particiones (radix join): las filas de los dos lados se
+ * reparten según los bits bajos de su hash, de modo que cada partición del
+ * lado de construcción entra en la cache. Después cada partición se cruza
+ * sola: se arma una tabla chica con las filas de construcción y se la
+ * sondea con las filas de la misma partición del otro lado. Las tres
+ * etapas (contar, repartir, cruzar) se hacen en paralelo.
  */
-void hash_destruir(hash_t *hash){
-	for (int i = 0; i < hash->capacidad;i++){
-		while(!lista_esta_vacia(hash->tabla[i])){
-			destruir_nodo(lista_borrar_primero(hash->tabla[i]),hash->destruir_dato);
+typedef struct fila_particion {
+	unsigned long hash;
+	size_t fila;
+} fila_particion_t;
+
+typedef struct lado_join {
+	const hash_filas_t* filas;
+	unsigned long* hashes;
+	fila_particion_t* repartidas; // ordenadas por partición
+	size_t* inicios;              // partición p: [inicios[p], inicios[p + 1])
+} lado_join_t;
+
+typedef struct reparto_parcial {
+	lado_join_t* lado;
+	size_t desde;       // filas [desde, hasta)
+	size_t hasta;
+	size_t particiones;
+	size_t* cuenta;     // filas del tramo por partición; después, dónde escribe cada una
+} reparto_parcial_t;
+
+static void* contar_tramo(void* extra) {
+	reparto_parcial_t* parcial = extra;
+	lado_join_t* lado = parcial->lado;
+	for (size_t i = parcial->desde; i < parcial->hasta; i++) {
+		unsigned long h = hash_funcion(lado->filas->claves[i]);
+		lado->hashes[i] = h;
+		parcial->cuenta[h & (parcial->particiones - 1)]++;
+	}
+	return NULL;
+}
+
+static void* repartir_tramo(void* extra) {
+	reparto_parcial_t* parcial = extra;
+	lado_join_t* lado = parcial->lado;
+	for (size_t i = parcial->desde; i < parcial->hasta; i++) {
+		unsigned long h = lado->hashes[i];
+		lado->repartidas[parcial->cuenta[h & (parcial->particiones - 1)]++] = (fila_particion_t){h, i};
+	}
+	return NULL;
+}
+
+// Reparte las filas de lado; cuentas tiene lugar para cant_hilos * particiones
+static void repartir(lado_join_t* lado, size_t particiones, size_t* cuentas, size_t cant_hilos) {
+	reparto_parcial_t parciales[MAX_HILOS_UNIR];
+	size_t cantidad = lado->filas->cantidad;
+	memset(cuentas, 0, cant_hilos * particiones * sizeof(size_t));
+	for (size_t i = 0; i < cant_hilos; i++) {
+		parciales[i] = (reparto_parcial_t){
+			.lado = lado, .desde = cantidad * i / cant_hilos, .hasta = cantidad * (i + 1) / cant_hilos,
+			.particiones = particiones, .cuenta = cuentas + i * particiones,
+		};
+	}
+	correr_en_hilos(contar_tramo, parciales, sizeof(reparto_parcial_t), cant_hilos);
+	// cada tramo escribe cada partición después de los tramos anteriores
+	size_t posicion = 0;
+	for (size_t p = 0; p < particiones; p++) {
+		lado->inicios[p] = posicion;
+		for (size_t i = 0; i < cant_hilos; i++) {
+			size_t filas = parciales[i].cuenta[p];
+			parciales[i].cuenta[p] = posicion;
+			posicion += filas;
+		}
+	}
+	lado->inicios[particiones] = posicion;
+	correr_en_hilos(repartir_tramo, parciales, sizeof(reparto_parcial_t), cant_hilos);
+}
+
+#define SIN_FILA SIZE_MAX
+#define FILAS_POR_PARTICION 4096
+#define MAX_BITS_PARTICION 12
+
+typedef struct cruce_parcial {
+	const lado_join_t* construccion;
+	const lado_join_t* sondeo;
+	size_t desde;        // particiones [desde, hasta)
+	size_t hasta;
+	unsigned bits;       // bits del hash que eligen la partición
+	size_t* cabezas;     // tabla chica, de capacidad_cabezas
+	size_t capacidad_cabezas;
+	size_t* siguientes;  // cadena de filas de construcción con la misma cabeza
+	hash_visitar_par_t visitar;
+	void* extra;
+} cruce_parcial_t;
+
+static void* cruzar_particiones(void* extra) {
+	cruce_parcial_t* parcial = extra;
+	const lado_join_t* construccion = parcial->construccion;
+	const lado_join_t* sondeo = parcial->sondeo;
+	for (size_t p = parcial->desde; p < parcial->hasta; p++) {
+		const fila_particion_t* filas = construccion->repartidas + construccion->inicios[p];
+		size_t cantidad = construccion->inicios[p + 1] - construccion->inicios[p];
+		if (cantidad == 0) {
+			continue;
+		}
+		size_t capacidad = 1;
+		while (capacidad < cantidad * 2 && capacidad < parcial->capacidad_cabezas) {
+			capacidad *= 2;
+		}
+		size_t mascara = capacidad - 1;
+		for (size_t i = 0; i < capacidad; i++) {
+			parcial->cabezas[i] = SIN_FILA;
+		}
+		for (size_t i = 0; i < cantidad; i++) {
+			size_t cabeza = (filas[i].hash >> parcial->bits) & mascara;
+			parcial->siguientes[i] = parcial->cabezas[cabeza];
+			parcial->cabezas[cabeza] = i;
+		}
+		for (size_t j = sondeo->inicios[p]; j < sondeo->inicios[p + 1]; j++) {
+			const fila_particion_t* buscada = &sondeo->repartidas[j];
+			const char* clave = sondeo->filas->claves[buscada->fila];
+			size_t i = parcial->cabezas[(buscada->hash >> parcial->bits) & mascara];
+			for (; i != SIN_FILA; i = parcial->siguientes[i]) {
+				size_t fila = filas[i].fila;
+				if (filas[i].hash == buscada->hash && strcmp(construccion->filas->claves[fila], clave) == 0) {
+					parcial->visitar(clave, construccion->filas->datos[fila], sondeo->filas->datos[buscada->fila], parcial->extra);
+				}
+			}
 		}
 	}
+	return NULL;
 }
 
+bool hash_join(const hash_filas_t *construccion, const hash_filas_t *sondeo, hash_visitar_par_t visitar, void *extra) {
+	unsigned bits = 0;
+	while (bits < MAX_BITS_PARTICION && (construccion->cantidad >> bits) > FILAS_POR_PARTICION) {
+		bits++;
+	}
+	size_t particiones = (size_t)1 << bits;
+	size_t total = construccion->cantidad + sondeo->cantidad;
+	size_t cant_hilos = hilos_para_unir(total);
+
+	//todo se pide antes de empezar: si falta memoria no se visitó ningún par
+	lado_join_t lados[2] = {{.filas = construccion}, {.filas = sondeo}};
+	bool ok = true;
+	for (size_t l = 0; l < 2; l++) {
+		size_t cantidad = lados[l].filas->cantidad;
+		lados[l].hashes = malloc((cantidad ? cantidad : 1) * sizeof(unsigned long));
+		lados[l].repartidas = malloc((cantidad ? cantidad : 1) * sizeof(fila_particion_t));
+		lados[l].inicios = malloc((particiones + 1) * sizeof(size_t));
+		ok &= lados[l].hashes && lados[l].repartidas && lados[l].inicios;
+	}
+	size_t* cuentas = malloc(cant_hilos * particiones * sizeof(size_t));
+	ok &= cuentas != NULL;
+	if (ok) {
+		repartir(&lados[0], particiones, cuentas, cant_hilos);
+		repartir(&lados[1], particiones, cuentas, cant_hilos);
+	}
+
+	size_t mayor = 0;
+	for (size_t p = 0; ok && p < particiones; p++) {
+		size_t cantidad = lados[0].inicios[p + 1] - lados[0].inicios[p];
+		mayor = cantidad > mayor ? cantidad : mayor;
+	}
+	size_t capacidad_cabezas = 1;
+	while (capacidad_cabezas < mayor * 2) {
+		capacidad_cabezas *= 2;
+	}
+	size_t por_hilo = capacidad_cabezas + (mayor ? mayor : 1);
+	size_t* memoria = ok ? malloc(cant_hilos * por_hilo * sizeof(size_t)) : NULL;
+	if (memoria) {
+		cruce_parcial_t parciales[MAX_HILOS_UNIR];
+		for (size_t i = 0; i < cant_hilos; i++) {
+			parciales[i] = (cruce_parcial_t){
+				.construccion = &lados[0], .sondeo = &lados[1],
+				.desde = particiones * i / cant_hilos, .hasta = particiones * (i + 1) / cant_hilos,
+				.bits = bits,
+				.cabezas = memoria + i * por_hilo, .capacidad_cabezas = capacidad_cabezas,
+				.siguientes = memoria + i * por_hilo + capacidad_cabezas,
+				.visitar = visitar, .extra = extra,
+			};
+		}
+		correr_en_hilos(cruzar_particiones, parciales, sizeof(cruce_parcial_t), cant_hilos);
+	}
+	ok = memoria != NULL;
+	free(memoria);
+	free(cuentas);
+	for (size_t l = 0; l < 2; l++) {
+		free(lados[l].hashes);
+		free(lados[l].repartidas);
+		free(lados[l].inicios);
+	}
+	return ok;
+}
 
 
 /* ******************************************************************
  *                    PRIMITIVAS DEL ITERADOR
  * *****************************************************************/
 size_t siguiente_posicion_con_elementos(const hash_t *hash, size_t pos) {
-	while(pos < hash->capacidad && lista_esta_vacia(hash->tabla[pos])) {
+	while(pos < hash->capacidad && hash->tabla[pos].cantidad == 0) {
 		pos++;
 	}
 
@@ -263,38 +2060,63 @@ hash_iter_t *hash_iter_crear(const hash_t *hash) {
 	}
 
 	iterador->hash = hash;
+	iterador->ordenado = NULL;
+	iterador->prefijo = NULL;
 
-	//si el hash esta vacio el iterador esta al final
-	if(iterador->hash->cantidad == 0){
-		iterador->pos = iterador->hash->capacidad - 1;
-		iterador->iter_actual = NULL;
-	} else {
-		//si tiene elementos busca la primera lista que tenga elementos
-		//le asigna la posicion de esa lista en el haintsh y crea el iterador de esa lista
-		size_t i= 0;
-
-		/*
-			while(lista_esta_vacia(hash->tabla[i]) && i < hash->capacidad) {
-				i++;
-			}
-	
-			iterador->pos = i;
-		*/
-		iterador->pos = siguiente_posicion_con_elementos(hash,i);
-		iterador->iter_actual = lista_iter_crear(hash->tabla[iterador->pos]);
-
+	//busca el primer balde que tenga elementos; si no hay ninguno el iterador queda al final
+	iterador->pos = hash->congelado ? 0 : siguiente_posicion_con_elementos(hash,0);
+	iterador->actual = NULL;
+	iterador->entrada = 0;
+	if (iterador->pos < hash->capacidad) {
+		iterador->actual = &hash->tabla[iterador->pos];
 	}
 
 	return iterador;
 }
 
 
+hash_iter_t *hash_iter_crear_ordenado(const hash_t *hash) {
+	return hash_iter_crear_prefijo(hash, "");
+}
+
+hash_iter_t *hash_iter_crear_prefijo(const hash_t *hash, const char *prefijo) {
+	if (!hash->indice) {
+		return NULL;
+	}
+	hash_iter_t* iterador = malloc(sizeof(hash_iter_t));
+	if (!iterador) {
+		return NULL;
+	}
+	iterador->hash = hash;
+	iterador->pos = 0;
+	iterador->actual = NULL;
+	iterador->entrada = 0;
+	iterador->largo_prefijo = strlen(prefijo);
+	iterador->prefijo = malloc(iterador->largo_prefijo + 1);
+	//las claves con el prefijo son las que siguen a la primera >= prefijo
+	iterador->ordenado = indice_iter_crear(hash->indice, prefijo);
+	if (!iterador->prefijo || !iterador->ordenado) {
+		if (iterador->ordenado) {
+			indice_iter_destruir(iterador->ordenado);
+		}
+		free(iterador->prefijo);
+		free(iterador);
+		return NULL;
+	}
+	memcpy(iterador->prefijo, prefijo, iterador->largo_prefijo + 1);
+	return iterador;
+}
+
 bool hash_iter_al_final(const hash_iter_t *iter){
-	size_t siguiente_lista = siguiente_posicion_con_elementos(iter->hash, iter->pos);
-	if((iter->hash->cantidad == 0) || (iter->pos == siguiente_lista)){
-		return true;
+	if (iter->ordenado) {
+		const char* clave = indice_iter_ver_clave(iter->ordenado);
+		return !clave || strncmp(clave, iter->prefijo, iter->largo_prefijo) != 0;
 	}
-	return false;
+	//congelado: pos recorre las posiciones de sus claves
+	if (iter->hash->congelado) {
+		return iter->pos >= iter->hash->cantidad;
+	}
+	return iter->actual == NULL;
 }
 
 bool hash_iter_avanzar(hash_iter_t *iter) {
@@ -302,23 +2124,25 @@ bool hash_iter_avanzar(hash_iter_t *iter) {
 	if (hash_iter_al_final(iter)){
 		return false;
 	}
+	if (iter->ordenado) {
+		return indice_iter_avanzar(iter->ordenado);
+	}
+	if (iter->hash->congelado) {
+		iter->pos++;
+		return true;
+	}
 
-	//avanza y si el "sub-iterador" de la lista esta al final destruye el "sub-iterador"
-	//y va a la siguiente lista con elementos
-	if(!lista_iter_avanzar(iter->iter_actual)) {
-		lista_iter_destruir(iter->iter_actual);
-
-		//busca la siguiente pos con elementos
-		size_t nueva_posicion = siguiente_posicion_con_elementos(iter->hash, iter->pos);
-
-		//si es la misma posicion que la anterior, entonces no hay listas con elementos y devuelve false
-		if(hash_iter_al_final(iter)){
-			return false;
+	//avanza en la cadena y si se termina va al siguiente balde con elementos
+	if (++iter->entrada < iter->actual->cantidad) {
+		return true;
+	}
+	iter->entrada = 0;
+	iter->actual = iter->actual->desborde;
+	if (!iter->actual) {
+		iter->pos = siguiente_posicion_con_elementos(iter->hash, iter->pos + 1);
+		if (iter->pos < iter->hash->capacidad) {
+			iter->actual = &iter->hash->tabla[iter->pos];
 		}
-
-		//si avanzó bien, se crea el iterador para la siguiente lista con elementos
-		iter->pos = nueva_posicion;
-		iter->iter_actual = lista_iter_crear(iter->hash->tabla[iter->pos]);
 	}
 
 	return true;
@@ -328,15 +2152,19 @@ const char *hash_iter_ver_actual(const hash_iter_t *iter) {
 	if(hash_iter_al_final(iter)){
 		return NULL;
 	}
-	nodo_t* actual = lista_iter_ver_actual(iter->iter_actual);
-
-	return actual->clave;
+	if (iter->ordenado) {
+		return indice_iter_ver_clave(iter->ordenado);
+	}
+	if (iter->hash->congelado) {
+		return congelado_clave(iter->hash->congelado, iter->pos);
+	}
+	return iter->actual->entradas[iter->entrada]->clave;
 }
 
 void hash_iter_destruir(hash_iter_t* iter) {
-	if (iter->iter_actual) {
-		lista_iter_destruir(iter->iter_actual);
+	if (iter->ordenado) {
+		indice_iter_destruir(iter->ordenado);
 	}
-
+	free(iter->prefijo);
 	free(iter);
 }
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 // Los structs deben llamarse "hash" y "hash_iter".
 struct hash;
@@ -14,10 +15,83 @@ typedef struct hash_iter hash_iter_t;
 // tipo de función para destruir dato
 typedef void (*hash_destruir_dato_t)(void *);
 
-/* Crea el hash
+// tipo de función para juntar el dato guardado con uno nuevo de la misma
+// clave; devuelve el dato que queda y se encarga de liberar el otro
+typedef void *(*hash_combinar_dato_t)(void *actual, void *nuevo);
+
+/* Devuelve el hash de la clave completa (one-at-a-time), sin reducirlo a
+ * ninguna capacidad. Lo usan las demás implementaciones de diccionario para
+ * repartir las claves igual que la tabla principal.
+ */
+unsigned long hash_funcion(const char *clave);
+
+/* Estado de hash_funcion a mitad de camino, para hashear una clave por
+ * partes: iniciar, agregar los pedazos en orden y terminar da lo mismo que
+ * hash_funcion de la clave entera. Se puede copiar para seguir desde el
+ * mismo punto con distintos finales.
+ */
+typedef struct hash_estado {
+	unsigned acumulado;
+} hash_estado_t;
+
+void hash_estado_iniciar(hash_estado_t *estado);
+
+// Agrega largo bytes de texto (sin buscar el '\0').
+void hash_estado_agregar(hash_estado_t *estado, const char *texto, size_t largo);
+
+// Devuelve el hash de todo lo agregado; el estado se puede seguir usando.
+unsigned long hash_estado_terminar(const hash_estado_t *estado);
+
+/* Finalizador de splitmix64: cada bit de entrada cambia la mitad de la
+ * salida. Sirve para sacar de un hash bits (etiquetas, huellas) que no
+ * repitan los que ya eligen el balde.
+ */
+uint64_t hash_mezclar(uint64_t x);
+
+/* Crea el hash. Mientras tenga pocas claves (las que entran en un balde)
+ * la tabla vive dentro del mismo hash: crearlo y destruirlo vacío cuesta un
+ * solo pedido de memoria, y cada clave uno más.
  */
 hash_t *hash_crear(hash_destruir_dato_t destruir_dato);
 
+/* De dónde saca el hash la memoria de su propio struct, su tabla, sus
+ * bloques de desborde y sus nodos (con la copia de la clave).
+ * - pedir: devuelve tam bytes alineados a alineacion (potencia de 2), o
+ *   NULL si no hay memoria.
+ * - liberar: recibe lo que devolvió pedir junto con el mismo tam.
+ * - contexto: se pasa tal cual a las dos funciones.
+ * hash_unir puede llamarlas desde varios hilos a la vez.
+ */
+typedef struct hash_asignador {
+	void *(*pedir)(size_t tam, size_t alineacion, void *contexto);
+	void (*liberar)(void *memoria, size_t tam, void *contexto);
+	void *contexto;
+} hash_asignador_t;
+
+/* Crea el hash pidiendo su memoria a asignador, que se copia y tiene que
+ * seguir sirviendo hasta que el hash se destruya. hash_crear usa malloc.
+ */
+hash_t *hash_crear_con_asignador(hash_destruir_dato_t destruir_dato, const hash_asignador_t *asignador);
+
+/* Crea un hash que además mantiene sus claves ordenadas (strcmp), para
+ * poder recorrerlas en orden con hash_iter_crear_ordenado, por prefijo con
+ * hash_iter_crear_prefijo y por rango con hash_rango. Guardar y borrar
+ * pasan a costar O(log n).
+ */
+hash_t *hash_crear_ordenado(hash_destruir_dato_t destruir_dato);
+
+/* Crea un hash múltiple: cada clave tiene una lista de datos, que se
+ * agregan con hash_agregar y se leen con hash_obtener_todos. Los datos de
+ * una clave van uno detrás de otro en un solo arreglo que se duplica al
+ * llenarse, así agregar no pide memoria casi nunca y recorrerlos no sigue
+ * punteros. hash_obtener devuelve el primer dato de la clave y hash_borrar
+ * saca la clave, destruye todos sus datos y devuelve NULL. hash_guardar,
+ * hash_guardar_lote, hash_fusionar, hash_unir, hash_congelar y
+ * hash_serializar devuelven false, y hash_clonar y las operaciones de
+ * conjuntos devuelven NULL.
+ */
+hash_t *hash_crear_multiple(hash_destruir_dato_t destruir_dato);
+
 /* Guarda un elemento en el hash, si la clave ya se encuentra en la
  * estructura, la reemplaza. De no poder guardarlo devuelve false.
  * Pre: La estructura hash fue inicializada
@@ -25,6 +99,166 @@ hash_t *hash_crear(hash_destruir_dato_t destruir_dato);
  */
 bool hash_guardar(hash_t *hash, const char *clave, void *dato);
 
+/* Busca la clave y, si no está, la guarda con dato. Devuelve la dirección
+ * del dato de la clave, para leerlo o cambiarlo sin buscarla otra vez, y
+ * deja en *estaba si la clave ya estaba; si estaba no cambia su dato. La
+ * dirección vale hasta que se borre la clave. Devuelve NULL si no hubo
+ * memoria, y también en un hash congelado o múltiple.
+ * Pre: La estructura hash fue inicializada
+ */
+void **hash_obtener_o_guardar(hash_t *hash, const char *clave, void *dato, bool *estaba);
+
+/* Guarda los cantidad pares (claves[i], datos[i]). Las claves se aplican
+ * agrupadas por balde, así el lote recorre la tabla una sola vez. Si una
+ * clave ya estaba (o se repite en el lote) y combinar no es NULL, el dato
+ * pasa a ser combinar(actual, nuevo); si no, se reemplaza como en
+ * hash_guardar. Las repeticiones se aplican en el orden del lote.
+ * Devuelve false si no hubo memoria, y en ese caso no guarda nada.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_guardar_lote(hash_t *hash, const char **claves, void **datos, size_t cantidad, hash_combinar_dato_t combinar);
+
+/* hash_guardar_lote en dos pasos, para cuando el hash se comparte detrás
+ * de un mutex: hash_lote_preparar hashea y ordena las claves y crea sus
+ * nodos sin tocar la tabla, así que puede hacerse sin el mutex, y
+ * hash_lote_aplicar, con el mutex tomado, sólo recorre los baldes.
+ * hash_lote_preparar devuelve NULL si no hubo memoria, y hash_lote_aplicar
+ * devuelve false sin guardar nada, como hash_guardar_lote.
+ * Pre: el asignador del hash admite pedidos desde varios hilos (el de
+ * hash_crear los admite); un lote se aplica una sola vez y sólo al hash
+ * con el que se preparó.
+ */
+struct hash_lote;
+typedef struct hash_lote hash_lote_t;
+
+hash_lote_t *hash_lote_preparar(const hash_t *hash, const char **claves, void **datos, size_t cantidad);
+bool hash_lote_aplicar(hash_t *hash, hash_lote_t *lote, hash_combinar_dato_t combinar);
+
+// Libera el lote y los nodos que no se usaron; no hace falta el mutex.
+void hash_lote_destruir(hash_lote_t *lote);
+
+/* Operador para fusionar valores numéricos guardados directamente en el
+ * dato (como (void*)valor, sin reservar memoria). Una clave nueva arranca
+ * en fusionar(neutro, delta).
+ */
+typedef struct hash_fusion {
+	intptr_t neutro;
+	intptr_t (*fusionar)(intptr_t actual, intptr_t delta);
+} hash_fusion_t;
+
+extern const hash_fusion_t HASH_FUSION_SUMA;
+extern const hash_fusion_t HASH_FUSION_MINIMO;
+extern const hash_fusion_t HASH_FUSION_MAXIMO;
+// delta es el hash del elemento a contar (por ejemplo hash_funcion)
+extern const hash_fusion_t HASH_FUSION_HLL;
+// para hash_unir de contadores HLL: delta es otro contador
+extern const hash_fusion_t HASH_FUSION_HLL_UNION;
+
+/* Devuelve la cantidad estimada de elementos distintos de un contador
+ * HyperLogLog armado con HASH_FUSION_HLL. Con 16 registros el error típico
+ * ronda el 25%.
+ */
+double hash_hll_estimar(intptr_t hll);
+
+/* Aplica fusion al valor de clave con delta, buscando la clave una sola
+ * vez. Devuelve false si la clave era nueva y no hubo memoria.
+ * Pre: La estructura hash fue inicializada sin destruir_dato y sus datos son
+ * valores numéricos.
+ */
+bool hash_fusionar(hash_t *hash, const char *clave, intptr_t delta, const hash_fusion_t *fusion);
+
+/* Fusiona en destino cada par de origen, como hash_fusionar. Con tablas
+ * grandes reparte los baldes de origen entre varios hilos. Devuelve false
+ * si no hubo memoria; en ese caso destino puede tener parte de origen.
+ * Pre: destino y origen guardan valores numéricos y no se usan desde otros
+ * hilos mientras tanto.
+ */
+bool hash_unir(hash_t *destino, const hash_t *origen, const hash_fusion_t *fusion);
+
+/* Operaciones de conjuntos sobre las claves. Devuelven un hash nuevo, sin
+ * destruir_dato, cuyos datos son los mismos punteros que los de a (o los
+ * de b, para las claves de la unión que sólo están en b). Con tablas
+ * grandes reparten el trabajo entre varios hilos y usan el hash ya
+ * guardado de cada clave. Devuelven NULL si no hubo memoria.
+ * Pre: a y b no se modifican mientras tanto.
+ */
+hash_t *hash_interseccion(const hash_t *a, const hash_t *b);
+hash_t *hash_union(const hash_t *a, const hash_t *b);
+hash_t *hash_diferencia(const hash_t *a, const hash_t *b);
+
+// Filas de una de las entradas de hash_join; las claves se pueden repetir.
+typedef struct hash_filas {
+	const char **claves;
+	void **datos;
+	size_t cantidad;
+} hash_filas_t;
+
+// Recibe cada par de filas con la misma clave.
+typedef void (*hash_visitar_par_t)(const char *clave, void *dato_construccion, void *dato_sondeo, void *extra);
+
+/* Join por igualdad de claves: llama a visitar una vez por cada par de
+ * filas (una de construccion, una de sondeo) con la misma clave. Reparte
+ * las filas en particiones por los bits del hash, para que cada una entre
+ * en la cache, y cruza las particiones en varios hilos: con entradas
+ * grandes visitar se llama desde varios hilos a la vez. Conviene que
+ * construccion sea la entrada más chica. Devuelve false si no hubo
+ * memoria, antes de visitar ningún par.
+ */
+bool hash_join(const hash_filas_t *construccion, const hash_filas_t *sondeo, hash_visitar_par_t visitar, void *extra);
+
+/* Cuándo devuelve memoria el hash. La tabla se duplica al llegar a 3
+ * claves por balde y se achica a la mitad cuando baja de achicar_debajo_de:
+ * con ese margen una tabla que sube y baja alrededor de un tamaño no se
+ * redimensiona en cada operación.
+ * - achicar_debajo_de: claves por balde; se toma como mucho 1.
+ * - achicar_al_borrar: si es false borrar nunca redimensiona, y la tabla se
+ *   achica sólo con hash_achicar_paso o hash_liberar_memoria (por ejemplo
+ *   cuando el programa está ocioso).
+ */
+typedef struct hash_politica {
+	double achicar_debajo_de;
+	bool achicar_al_borrar;
+} hash_politica_t;
+
+// 0.5 claves por balde, achicando al borrar: la de todo hash nuevo
+extern const hash_politica_t HASH_POLITICA_DEFECTO;
+
+/* Cambia la política de memoria del hash.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_politica_memoria(hash_t *hash, const hash_politica_t *politica);
+
+/* Si la política lo pide, achica la tabla a la mitad una vez: cuesta una
+ * pasada sobre las claves, no todo el achique de golpe. Devuelve true si
+ * achicó, así se puede repetir mientras haya tiempo libre.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_achicar_paso(hash_t *hash);
+
+/* Achica la tabla todo lo que permita la política y, si el hash usa malloc,
+ * le pide a malloc que devuelva al sistema las páginas libres.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_liberar_memoria(hash_t *hash);
+
+struct epoca;
+
+/* Hace que el hash no llame a destruir_dato en el momento (al reemplazar un
+ * dato, al borrar de un hash múltiple ni en hash_destruir) sino que retire
+ * los datos en epoca (ver epoca.h), que los destruye más tarde y de a
+ * tandas. Varios hash pueden compartir la misma epoca, que tiene que durar
+ * más que todos ellos. Con NULL vuelve a destruirlos en el momento.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_diferir_destruccion(hash_t *hash, struct epoca *epoca);
+
+/* Destruye hasta presupuesto datos retirados por el hash (o por otro con la
+ * misma epoca) que ya no pueda estar usando ningún lector. Devuelve cuántos
+ * destruyó; 0 si el hash no difiere la destrucción.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_recolectar(hash_t *hash, size_t presupuesto);
+
 /* Borra un elemento del hash y devuelve el dato asociado.  Devuelve
  * NULL si el dato no estaba.
  * Pre: La estructura hash fue inicializada
@@ -33,12 +267,33 @@ bool hash_guardar(hash_t *hash, const char *clave, void *dato);
  */
 void *hash_borrar(hash_t *hash, const char *clave);
 
+/* Agrega dato al final de los datos de clave, creándola si no estaba.
+ * Devuelve false si no hubo memoria o si el hash no es múltiple.
+ * Pre: el hash fue creado con hash_crear_multiple
+ */
+bool hash_agregar(hash_t *hash, const char *clave, void *dato);
+
+/* Deja en datos el arreglo con los datos de clave, en el orden en que se
+ * agregaron, y en cantidad su largo. El arreglo es del hash y vale hasta
+ * que se modifique esa clave. Devuelve false (con datos en NULL y cantidad
+ * en 0) si la clave no está o el hash no es múltiple.
+ */
+bool hash_obtener_todos(const hash_t *hash, const char *clave, void ***datos, size_t *cantidad);
+
 /* Obtiene el valor de un elemento del hash, si la clave no se encuentra
  * devuelve NULL.
  * Pre: La estructura hash fue inicializada
  */
 void *hash_obtener(const hash_t *hash, const char *clave);
 
+/* Busca las claves prefijo + sufijos[i] y deja en datos[i] el dato de cada
+ * una (NULL si no está). El prefijo se hashea una sola vez para todo el
+ * lote, en lugar de una vez por clave.
+ * Pre: La estructura hash fue inicializada; datos tiene lugar para
+ * cantidad.
+ */
+void hash_obtener_con_prefijo(const hash_t *hash, const char *prefijo, const char **sufijos, size_t cantidad, void **datos);
+
 /* Determina si clave pertenece o no al hash.
  * Pre: La estructura hash fue inicializada
  */
@@ -56,11 +311,127 @@ size_t hash_cantidad(const hash_t *hash);
  */
 void hash_destruir(hash_t *hash);
 
+/* Aplica visitar, en orden, a cada par con desde <= clave <= hasta, hasta
+ * que visitar devuelva false. Un extremo NULL no pone límite de ese lado.
+ * Cuesta O(log n + k), con k la cantidad de claves visitadas. En un hash
+ * que no se creó con hash_crear_ordenado no visita nada.
+ * Pre: el hash fue creado.
+ */
+void hash_rango(const hash_t *hash, const char *desde, const char *hasta,
+		bool visitar(const char *clave, void *dato, void *extra), void *extra);
+
+/* Congela el hash: lo pasa a una función de hash perfecta mínima sobre sus
+ * claves actuales, con las claves copiadas una detrás de otra y sin lugares
+ * vacíos. Buscar cuesta un acceso a la tabla de bits por nivel hasta dar con
+ * el de la clave (casi siempre el primero o el segundo) y una comparación.
+ * Desde entonces el hash es de sólo lectura: hash_obtener, hash_pertenece,
+ * hash_obtener_con_prefijo y el iterador siguen andando; hash_guardar,
+ * hash_guardar_lote, hash_fusionar y hash_unir devuelven false, hash_borrar
+ * devuelve NULL y las operaciones de conjuntos devuelven NULL.
+ * Devuelve false si no hubo memoria (el hash queda como estaba) o si el
+ * hash es ordenado, que no se puede congelar.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_congelar(hash_t *hash);
+
+/* Escribe un hash congelado en el archivo ruta, en un formato que
+ * hash_congelado_mapear puede usar sin leerlo. Los datos se guardan tal
+ * cual: sólo tiene sentido si son valores, no punteros. Devuelve false si
+ * no pudo escribirlo o si el hash no estaba congelado; el archivo anterior,
+ * si había, queda intacto.
+ */
+bool hash_congelado_escribir(const hash_t *hash, const char *ruta);
+
+/* Abre el archivo escrito por hash_congelado_escribir sin cargarlo, como un
+ * hash congelado sin destruir_dato. Se cierra con hash_destruir.
+ * Post: devuelve el hash, o NULL si el archivo no existe o no es válido.
+ */
+hash_t *hash_congelado_mapear(const char *ruta);
+
+// tipo de función para copiar un dato al clonar el hash
+typedef void *(*hash_copiar_dato_t)(const void *dato);
+
+/* Devuelve una copia del hash con la misma capacidad, asignador y política.
+ * Copia los baldes tal cual (etiquetas incluidas) y cada nodo junto con su
+ * hash guardado, así no se hashea ni se busca ninguna clave. Si copiar_dato
+ * es NULL el clon comparte los datos y no tiene destruir_dato; si no, cada
+ * dato del clon es copiar_dato(dato) y el clon destruye con el mismo
+ * destruir_dato que el original. Un clon de un hash ordenado también es
+ * ordenado. Devuelve NULL si no hubo memoria (o copiar_dato devolvió NULL
+ * para un dato que no lo era) o si el hash está congelado.
+ * Pre: La estructura hash fue inicializada
+ */
+hash_t *hash_clonar(const hash_t *hash, hash_copiar_dato_t copiar_dato);
+
+/* Destino de hash_serializar: escribir recibe los bytes en orden y devuelve
+ * false si no pudo escribirlos todos.
+ */
+typedef struct hash_escritor {
+	bool (*escribir)(const void *datos, size_t largo, void *contexto);
+	void *contexto;
+} hash_escritor_t;
+
+/* Origen de hash_deserializar: leer deja en destino entre 1 y largo bytes y
+ * devuelve cuántos dejó, o 0 al final o si hubo un error (como read).
+ */
+typedef struct hash_lector {
+	size_t (*leer)(void *destino, size_t largo, void *contexto);
+	void *contexto;
+} hash_lector_t;
+
+/* Escriben y leen un dato en el flujo del hash. El lector que recibe
+ * hash_leer_dato_t siempre devuelve largo salvo al final del flujo.
+ */
+typedef bool (*hash_escribir_dato_t)(const void *dato, const hash_escritor_t *escritor);
+typedef bool (*hash_leer_dato_t)(const hash_lector_t *lector, void **dato);
+
+/* Escribe el hash en un formato binario con versión: una cabecera con la
+ * cantidad y la capacidad y después, balde por balde, el hash guardado, el
+ * largo y los bytes de cada clave seguidos de su dato. Si escribir_dato es
+ * NULL el dato se escribe como número (sólo sirve para valores, no
+ * punteros). Escribe de a bloques grandes, no una vez por clave. Los
+ * números van en el orden de bytes de la máquina. Devuelve false si el
+ * escritor o escribir_dato fallaron, o si el hash está congelado.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_serializar(const hash_t *hash, const hash_escritor_t *escritor, hash_escribir_dato_t escribir_dato);
+
+/* Lee un hash escrito por hash_serializar. Crea la tabla ya con la
+ * capacidad que pide la cantidad de claves (hasta un millón; si trae más
+ * crece al leerlas) y pone cada nodo en su balde con el hash guardado, sin
+ * hashear las claves. Con leer_dato NULL lee los datos como números.
+ * Devuelve NULL si no hubo memoria, si el flujo termina antes de tiempo,
+ * si repite una clave o si no tiene el formato o la versión esperados.
+ */
+hash_t *hash_deserializar(const hash_lector_t *lector, hash_destruir_dato_t destruir_dato, hash_leer_dato_t leer_dato);
+
+#ifdef HASH_PERFIL
+/* Recibe cada redimensión de cualquier hash, una vez antes de mover los
+ * nodos (termino en false) y otra al terminar, con la capacidad vieja y la
+ * nueva. Sirve para medir cada redimensión por separado.
+ */
+typedef void (*hash_aviso_redimension_t)(size_t vieja, size_t nueva, bool termino, void *extra);
+
+/* Instala aviso (NULL lo saca). Vale para todos los hash del programa y no
+ * es seguro con varios hilos redimensionando a la vez. Sólo existe
+ * compilando con -DHASH_PERFIL; sin eso redimensionar no paga nada.
+ */
+void hash_perfil_redimensiones(hash_aviso_redimension_t aviso, void *extra);
+#endif
+
 /* Iterador del hash */
 
 // Crea iterador
 hash_iter_t *hash_iter_crear(const hash_t *hash);
 
+// Crea un iterador que recorre las claves en orden. Devuelve NULL si el
+// hash no fue creado con hash_crear_ordenado.
+hash_iter_t *hash_iter_crear_ordenado(const hash_t *hash);
+
+// Crea un iterador que recorre en orden sólo las claves que empiezan con
+// prefijo. Devuelve NULL si el hash no fue creado con hash_crear_ordenado.
+hash_iter_t *hash_iter_crear_prefijo(const hash_t *hash, const char *prefijo);
+
 // Avanza iterador
 bool hash_iter_avanzar(hash_iter_t *iter);
 
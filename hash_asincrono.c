@@ -0,0 +1,179 @@
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hash_asincrono.h"
+#include "lista.h"
+
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+// Las claves de un lote se copian juntas en un solo bloque
+typedef struct lote {
+	const char** claves;
+	void** datos;
+	size_t cantidad;
+	hash_respuesta_t respuesta;
+	void* extra;
+} lote_t;
+
+struct hash_asincrono {
+	const hash_compacto_t* hash;
+	pthread_t hilo;
+	pthread_mutex_t mutex;
+	pthread_cond_t hay_trabajo;
+	pthread_cond_t sin_pendientes;
+	lista_t* lotes;
+	size_t pendientes; // encolados y todavía no respondidos
+	bool terminar;
+};
+
+
+/* ******************************************************************
+ *                    FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+static lote_t* lote_crear(const char** claves, size_t cantidad, hash_respuesta_t respuesta, void* extra) {
+	size_t texto = 0;
+	for (size_t i = 0; i < cantidad; i++) {
+		texto += strlen(claves[i]) + 1;
+	}
+	lote_t* lote = malloc(sizeof(lote_t));
+	const char** copias = malloc(cantidad * sizeof(char*));
+	void** datos = malloc(cantidad * sizeof(void*));
+	char* bloque = malloc(texto ? texto : 1);
+	if (!lote || !copias || !datos || !bloque) {
+		free(lote);
+		free(copias);
+		free(datos);
+		free(bloque);
+		return NULL;
+	}
+	for (size_t i = 0; i < cantidad; i++) {
+		size_t largo = strlen(claves[i]) + 1;
+		memcpy(bloque, claves[i], largo);
+		copias[i] = bloque;
+		bloque += largo;
+	}
+	lote->claves = copias;
+	lote->datos = datos;
+	lote->cantidad = cantidad;
+	lote->respuesta = respuesta;
+	lote->extra = extra;
+	return lote;
+}
+
+static void lote_destruir(lote_t* lote) {
+	if (lote->cantidad > 0) {
+		free((char*)lote->claves[0]);
+	}
+	free(lote->claves);
+	free(lote->datos);
+	free(lote);
+}
+
+// El hilo toma los lotes de a uno y los responde fuera del mutex
+static void* atender(void* extra) {
+	hash_asincrono_t* asincrono = extra;
+	pthread_mutex_lock(&asincrono->mutex);
+	while (true) {
+		while (lista_esta_vacia(asincrono->lotes) && !asincrono->terminar) {
+			pthread_cond_wait(&asincrono->hay_trabajo, &asincrono->mutex);
+		}
+		if (lista_esta_vacia(asincrono->lotes)) {
+			break;
+		}
+		lote_t* lote = lista_borrar_primero(asincrono->lotes);
+		pthread_mutex_unlock(&asincrono->mutex);
+
+		hash_compacto_obtener_lote(asincrono->hash, lote->claves, lote->cantidad, lote->datos);
+		for (size_t i = 0; i < lote->cantidad; i++) {
+			lote->respuesta(lote->claves[i], lote->datos[i], lote->extra);
+		}
+		lote_destruir(lote);
+
+		pthread_mutex_lock(&asincrono->mutex);
+		if (--asincrono->pendientes == 0) {
+			pthread_cond_broadcast(&asincrono->sin_pendientes);
+		}
+	}
+	pthread_mutex_unlock(&asincrono->mutex);
+	return NULL;
+}
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DE LAS CONSULTAS
+ * *****************************************************************/
+
+hash_asincrono_t *hash_asincrono_crear(const hash_compacto_t *hash) {
+	hash_asincrono_t* asincrono = malloc(sizeof(hash_asincrono_t));
+	if (!asincrono) {
+		return NULL;
+	}
+	asincrono->lotes = lista_crear();
+	if (!asincrono->lotes) {
+		free(asincrono);
+		return NULL;
+	}
+	asincrono->hash = hash;
+	asincrono->pendientes = 0;
+	asincrono->terminar = false;
+	pthread_mutex_init(&asincrono->mutex, NULL);
+	pthread_cond_init(&asincrono->hay_trabajo, NULL);
+	pthread_cond_init(&asincrono->sin_pendientes, NULL);
+	if (pthread_create(&asincrono->hilo, NULL, atender, asincrono) != 0) {
+		pthread_mutex_destroy(&asincrono->mutex);
+		pthread_cond_destroy(&asincrono->hay_trabajo);
+		pthread_cond_destroy(&asincrono->sin_pendientes);
+		lista_destruir(asincrono->lotes, NULL);
+		free(asincrono);
+		return NULL;
+	}
+	return asincrono;
+}
+
+bool hash_asincrono_obtener_lote(hash_asincrono_t *asincrono, const char **claves, size_t cantidad,
+		hash_respuesta_t respuesta, void *extra) {
+	if (cantidad == 0) {
+		return true;
+	}
+	lote_t* lote = lote_crear(claves, cantidad, respuesta, extra);
+	if (!lote) {
+		return false;
+	}
+	pthread_mutex_lock(&asincrono->mutex);
+	bool ok = lista_insertar_ultimo(asincrono->lotes, lote);
+	if (ok) {
+		asincrono->pendientes++;
+		pthread_cond_signal(&asincrono->hay_trabajo);
+	}
+	pthread_mutex_unlock(&asincrono->mutex);
+	if (!ok) {
+		lote_destruir(lote);
+	}
+	return ok;
+}
+
+void hash_asincrono_esperar(hash_asincrono_t *asincrono) {
+	pthread_mutex_lock(&asincrono->mutex);
+	while (asincrono->pendientes > 0) {
+		pthread_cond_wait(&asincrono->sin_pendientes, &asincrono->mutex);
+	}
+	pthread_mutex_unlock(&asincrono->mutex);
+}
+
+void hash_asincrono_destruir(hash_asincrono_t *asincrono) {
+	pthread_mutex_lock(&asincrono->mutex);
+	asincrono->terminar = true;
+	pthread_cond_signal(&asincrono->hay_trabajo);
+	pthread_mutex_unlock(&asincrono->mutex);
+	pthread_join(asincrono->hilo, NULL);
+	pthread_mutex_destroy(&asincrono->mutex);
+	pthread_cond_destroy(&asincrono->hay_trabajo);
+	pthread_cond_destroy(&asincrono->sin_pendientes);
+	lista_destruir(asincrono->lotes, NULL);
+	free(asincrono);
+}
@@ -0,0 +1,50 @@
+#ifndef HASH_ASINCRONO_H
+#define HASH_ASINCRONO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "hash_compacto.h"
+
+/* Consultas asincrónicas sobre un hash compacto, pensadas para uno mapeado
+ * desde un archivo más grande que la memoria. El hilo que consulta encola
+ * un lote y sigue; un hilo propio lo resuelve con hash_compacto_obtener_lote
+ * (que pide por adelantado las páginas del lote) y avisa cada resultado con
+ * una función de respuesta. Así los fallos de página los espera ese hilo y
+ * no el que atiende pedidos.
+ */
+
+struct hash_asincrono;
+typedef struct hash_asincrono hash_asincrono_t;
+
+/* Recibe el resultado de una clave del lote: el dato, o NULL si no está.
+ * Se llama desde el hilo del hash_asincrono, en el orden del lote.
+ */
+typedef void (*hash_respuesta_t)(const char *clave, void *dato, void *extra);
+
+/* Crea las consultas sobre hash y lanza su hilo.
+ * Pre: el hash no se modifica mientras haya consultas pendientes.
+ * Post: devuelve el hash_asincrono, o NULL si no hubo memoria o no pudo
+ * crear el hilo.
+ */
+hash_asincrono_t *hash_asincrono_crear(const hash_compacto_t *hash);
+
+/* Encola la búsqueda de cantidad claves, que se copian. Por cada una se
+ * llamará a respuesta con extra. Devuelve false si no hubo memoria; en ese
+ * caso no se llama a respuesta.
+ * Pre: el hash_asincrono fue creado.
+ */
+bool hash_asincrono_obtener_lote(hash_asincrono_t *asincrono, const char **claves, size_t cantidad,
+		hash_respuesta_t respuesta, void *extra);
+
+/* Espera a que se respondan todos los lotes encolados.
+ * Pre: el hash_asincrono fue creado.
+ */
+void hash_asincrono_esperar(hash_asincrono_t *asincrono);
+
+/* Responde los lotes pendientes, termina el hilo y libera la estructura.
+ * El hash no se destruye.
+ * Pre: el hash_asincrono fue creado.
+ */
+void hash_asincrono_destruir(hash_asincrono_t *asincrono);
+
+#endif // HASH_ASINCRONO_H
@@ -0,0 +1,151 @@
+#define _POSIX_C_SOURCE 200809L
+#include "hash_buffer.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+struct hash_buffer {
+	hash_t* destino;
+	pthread_mutex_t* mutex;
+	hash_destruir_dato_t destruir_dato;
+	hash_combinar_dato_t combinar;
+	hash_t* pendientes; // no es dueña de sus datos: se mudan al destino
+	size_t limite;
+	unsigned intervalo_ms;
+	unsigned long long ultimo_volcado_ms;
+};
+
+static unsigned long long ahora_ms(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (unsigned long long)t.tv_sec * 1000 + (unsigned long long)t.tv_nsec / 1000000;
+}
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL BUFFER
+ * *****************************************************************/
+
+hash_buffer_t *hash_buffer_crear(hash_t *destino, pthread_mutex_t *mutex, hash_destruir_dato_t destruir_dato,
+		hash_combinar_dato_t combinar, size_t limite, unsigned intervalo_ms) {
+	hash_buffer_t* buffer = malloc(sizeof(hash_buffer_t));
+	if (!buffer) {
+		return NULL;
+	}
+	buffer->pendientes = hash_crear(NULL);
+	if (!buffer->pendientes) {
+		free(buffer);
+		return NULL;
+	}
+	buffer->destino = destino;
+	buffer->mutex = mutex;
+	buffer->destruir_dato = destruir_dato;
+	buffer->combinar = combinar;
+	buffer->limite = limite;
+	buffer->intervalo_ms = intervalo_ms;
+	buffer->ultimo_volcado_ms = intervalo_ms ? ahora_ms() : 0;
+	return buffer;
+}
+
+bool hash_buffer_guardar(hash_buffer_t *buffer, const char *clave, void *dato) {
+	bool estaba;
+	void** lugar = hash_obtener_o_guardar(buffer->pendientes, clave, dato, &estaba);
+	if (!lugar) {
+		return false;
+	}
+	if (estaba) {
+		// la clave ya tenía nodo: sólo cambia el dato
+		if (buffer->combinar) {
+			*lugar = buffer->combinar(*lugar, dato);
+		} else {
+			if (buffer->destruir_dato) {
+				buffer->destruir_dato(*lugar);
+			}
+			*lugar = dato;
+		}
+	}
+	bool lleno = hash_cantidad(buffer->pendientes) >= buffer->limite;
+	bool vencido = buffer->intervalo_ms && ahora_ms() - buffer->ultimo_volcado_ms >= buffer->intervalo_ms;
+	if (lleno || vencido) {
+		// si falla, el buffer sigue lleno y se reintenta en el próximo guardar
+		hash_buffer_vaciar(buffer);
+	}
+	return true;
+}
+
+bool hash_buffer_vaciar(hash_buffer_t *buffer) {
+	size_t cantidad = hash_cantidad(buffer->pendientes);
+	if (cantidad == 0) {
+		return true;
+	}
+	const char** claves = malloc(cantidad * sizeof(char*));
+	void** datos = malloc(cantidad * sizeof(void*));
+	hash_t* vacio = hash_crear(NULL);
+	hash_iter_t* iter = hash_iter_crear(buffer->pendientes);
+	if (!claves || !datos || !vacio || !iter) {
+		free(claves);
+		free(datos);
+		if (vacio) {
+			hash_destruir(vacio);
+		}
+		if (iter) {
+			hash_iter_destruir(iter);
+		}
+		return false;
+	}
+	for (size_t i = 0; !hash_iter_al_final(iter); hash_iter_avanzar(iter), i++) {
+		claves[i] = hash_iter_ver_actual(iter);
+		datos[i] = hash_obtener(buffer->pendientes, claves[i]);
+	}
+	hash_iter_destruir(iter);
+
+	// hashear, ordenar y crear los nodos no toca la tabla compartida: con el
+	// mutex tomado sólo se recorren los baldes
+	hash_lote_t* lote = hash_lote_preparar(buffer->destino, claves, datos, cantidad);
+	bool ok = lote != NULL;
+	if (lote) {
+		pthread_mutex_lock(buffer->mutex);
+		ok = hash_lote_aplicar(buffer->destino, lote, buffer->combinar);
+		pthread_mutex_unlock(buffer->mutex);
+		hash_lote_destruir(lote);
+	}
+
+	free(claves);
+	free(datos);
+	if (!ok) {
+		hash_destruir(vacio);
+		return false;
+	}
+	// los datos ya son del destino: la tabla vieja se destruye sin tocarlos
+	hash_destruir(buffer->pendientes);
+	buffer->pendientes = vacio;
+	if (buffer->intervalo_ms) {
+		buffer->ultimo_volcado_ms = ahora_ms();
+	}
+	return true;
+}
+
+size_t hash_buffer_cantidad(const hash_buffer_t *buffer) {
+	return hash_cantidad(buffer->pendientes);
+}
+
+bool hash_buffer_destruir(hash_buffer_t *buffer) {
+	bool ok = hash_buffer_vaciar(buffer);
+	if (!ok && buffer->destruir_dato) {
+		hash_iter_t* iter = hash_iter_crear(buffer->pendientes);
+		for (; iter && !hash_iter_al_final(iter); hash_iter_avanzar(iter)) {
+			buffer->destruir_dato(hash_obtener(buffer->pendientes, hash_iter_ver_actual(iter)));
+		}
+		if (iter) {
+			hash_iter_destruir(iter);
+		}
+	}
+	hash_destruir(buffer->pendientes);
+	free(buffer);
+	return ok;
+}
@@ -0,0 +1,60 @@
+#ifndef HASH_BUFFER_H
+#define HASH_BUFFER_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "hash.h"
+
+/* Buffer de escritura privado de un hilo sobre un hash compartido. Las
+ * escrituras van a una tabla chica del hilo, que junta las repeticiones de
+ * una misma clave, y se vuelcan al hash compartido como un lote (ver
+ * hash_lote_preparar): en orden de balde y tomando el mutex una vez por
+ * lote en lugar de una vez por clave, y sólo para recorrer los baldes.
+ * Por eso el asignador del destino tiene que admitir pedidos desde varios
+ * hilos.
+ *
+ * Cada hilo crea su propio buffer; un buffer no admite uso concurrente. Lo
+ * que está en el buffer no se ve en el hash compartido hasta que se vuelca.
+ */
+
+struct hash_buffer;
+typedef struct hash_buffer hash_buffer_t;
+
+/* Crea un buffer que vuelca en destino, tomando mutex para hacerlo.
+ * - destruir_dato: la del hash destino, para el dato reemplazado de una
+ *   clave repetida cuando combinar es NULL.
+ * - combinar: cómo juntar dos datos de la misma clave (ver hash.h). Se usa
+ *   tanto dentro del buffer como al volcar.
+ * - limite: con esta cantidad de claves distintas el buffer se vuelca solo.
+ * - intervalo_ms: si no es 0, también se vuelca al guardar si pasó ese
+ *   tiempo desde el último volcado.
+ * Post: devuelve el buffer vacío, o NULL si no hubo memoria.
+ */
+hash_buffer_t *hash_buffer_crear(hash_t *destino, pthread_mutex_t *mutex, hash_destruir_dato_t destruir_dato,
+		hash_combinar_dato_t combinar, size_t limite, unsigned intervalo_ms);
+
+/* Guarda el par en el buffer, juntándolo con el dato que ya tuviera la
+ * clave. Devuelve false si no hubo memoria para guardarlo. Si el volcado
+ * que dispara falla, el par queda en el buffer y se reintenta al próximo
+ * guardar.
+ * Pre: el buffer fue creado.
+ */
+bool hash_buffer_guardar(hash_buffer_t *buffer, const char *clave, void *dato);
+
+/* Vuelca todo el contenido del buffer al hash compartido. Devuelve false si
+ * no hubo memoria; el buffer queda como estaba.
+ * Pre: el buffer fue creado.
+ */
+bool hash_buffer_vaciar(hash_buffer_t *buffer);
+
+// Devuelve la cantidad de claves distintas que esperan en el buffer.
+size_t hash_buffer_cantidad(const hash_buffer_t *buffer);
+
+/* Vuelca lo que quede y destruye el buffer. Devuelve false si no pudo
+ * volcarlo; en ese caso los datos pendientes se destruyen con destruir_dato.
+ * Pre: el buffer fue creado.
+ */
+bool hash_buffer_destruir(hash_buffer_t *buffer);
+
+#endif // HASH_BUFFER_H
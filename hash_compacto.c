@@ -0,0 +1,612 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "hash_compacto.h"
+
+#define CAPACIDAD_INICIAL 16 // ranuras, siempre potencia de 2
+#define ENTRADAS_INICIALES 8
+#define ARENA_INICIAL 128
+// se agranda cuando las ranuras ocupadas pasan los 4/5
+#define MAX_OCUPACION_NUM 4
+#define MAX_OCUPACION_DEN 5
+#define LIBRE 0
+#define MAX_ENTRADAS (UINT32_MAX - 1)
+#define MAX_ARENA ((size_t)UINT32_MAX)
+#define MAGIA_ARCHIVO "HCOMPACT"
+#define VERSION_ARCHIVO 1
+// en obtener_lote se anticipan las páginas de tantas claves juntas
+#define CLAVES_POR_TANDA 32
+
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+/* ranuras[i] es el índice de la entrada más uno (LIBRE si no hay) y
+ * huellas[i] 16 bits de su hash. Las entradas están juntas en
+ * [0, cantidad): al borrar, la última pasa al hueco.
+ */
+struct hash_compacto {
+	uint32_t* ranuras;
+	uint16_t* huellas;
+	size_t capacidad;
+	uint32_t* claves; // desplazamiento de cada clave en la arena
+	void** datos;
+	size_t cantidad;
+	size_t capacidad_entradas;
+	char* arena;
+	size_t largo_arena;
+	size_t capacidad_arena;
+	size_t basura; // bytes de claves borradas que siguen en la arena
+	hash_destruir_dato_t destruir_dato;
+	// si se abrió con hash_compacto_mapear, los arreglos apuntan al mapeo
+	void* mapa;
+	size_t largo_mapa;
+};
+
+/* Encabezado del archivo. Lo siguen, cada uno alineado a 8 bytes:
+ * ranuras[capacidad], huellas[capacidad], claves[cantidad],
+ * datos[cantidad] y la arena. Todo en el formato de la máquina que lo
+ * escribió, para poder usarlo mapeado sin convertir nada.
+ */
+typedef struct encabezado {
+	char magia[8];
+	uint32_t version;
+	uint32_t tam_dato;
+	uint64_t capacidad;
+	uint64_t cantidad;
+	uint64_t largo_arena;
+} encabezado_t;
+
+struct hash_compacto_iter {
+	const hash_compacto_t* hash;
+	size_t actual;
+};
+
+
+/* ******************************************************************
+ *                    FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+/* La ranura sale de los bits bajos del hash. La huella no puede tomar
+ * bits fijos: con más de 2^16 ranuras se pisarían con los de la ranura, y
+ * las claves que se cruzan en un grupo tendrían casi la misma huella. Se
+ * toma de la mezcla del hash entero.
+ */
+static uint16_t huella_de(unsigned long h) {
+	return (uint16_t)(hash_mezclar(h) >> 48);
+}
+
+static const char* clave_de(const hash_compacto_t* hash, size_t entrada) {
+	return hash->arena + hash->claves[entrada];
+}
+
+/* Busca la clave probando ranuras consecutivas desde la suya. Deja en pos
+ * la ranura de la clave, o la primera libre si no está.
+ */
+static bool buscar(const hash_compacto_t* hash, const char* clave, unsigned long h, size_t* pos) {
+	uint16_t huella = huella_de(h);
+	size_t mascara = hash->capacidad - 1;
+	for (size_t i = h & mascara; ; i = (i + 1) & mascara) {
+		if (hash->ranuras[i] == LIBRE) {
+			*pos = i;
+			return false;
+		}
+		if (hash->huellas[i] == huella && strcmp(clave_de(hash, hash->ranuras[i] - 1), clave) == 0) {
+			*pos = i;
+			return true;
+		}
+	}
+}
+
+// Ranura que apunta a la entrada; la entrada tiene que estar en la tabla
+static size_t ranura_de_entrada(const hash_compacto_t* hash, size_t entrada) {
+	size_t mascara = hash->capacidad - 1;
+	size_t i = hash_funcion(clave_de(hash, entrada)) & mascara;
+	while (hash->ranuras[i] != entrada + 1) {
+		i = (i + 1) & mascara;
+	}
+	return i;
+}
+
+static bool hash_compacto_redimensionar(hash_compacto_t* hash, size_t capacidad) {
+	uint32_t* ranuras = calloc(capacidad, sizeof(uint32_t));
+	uint16_t* huellas = malloc(capacidad * sizeof(uint16_t));
+	if (!ranuras || !huellas) {
+		free(ranuras);
+		free(huellas);
+		return false;
+	}
+	size_t mascara = capacidad - 1;
+	for (size_t e = 0; e < hash->cantidad; e++) {
+		unsigned long h = hash_funcion(clave_de(hash, e));
+		size_t i = h & mascara;
+		while (ranuras[i] != LIBRE) {
+			i = (i + 1) & mascara;
+		}
+		ranuras[i] = (uint32_t)(e + 1);
+		huellas[i] = huella_de(h);
+	}
+	free(hash->ranuras);
+	free(hash->huellas);
+	hash->ranuras = ranuras;
+	hash->huellas = huellas;
+	hash->capacidad = capacidad;
+	return true;
+}
+
+static bool reservar_entradas(hash_compacto_t* hash) {
+	if (hash->cantidad < hash->capacidad_entradas) {
+		return true;
+	}
+	size_t capacidad = hash->capacidad_entradas * 2;
+	uint32_t* claves = realloc(hash->claves, capacidad * sizeof(uint32_t));
+	if (!claves) {
+		return false;
+	}
+	hash->claves = claves;
+	void** datos = realloc(hash->datos, capacidad * sizeof(void*));
+	if (!datos) {
+		return false;
+	}
+	hash->datos = datos;
+	hash->capacidad_entradas = capacidad;
+	return true;
+}
+
+static bool reservar_arena(hash_compacto_t* hash, size_t largo) {
+	if (largo > MAX_ARENA - hash->largo_arena) {
+		return false;
+	}
+	size_t capacidad = hash->capacidad_arena;
+	while (capacidad - hash->largo_arena < largo) {
+		capacidad *= 2;
+	}
+	if (capacidad == hash->capacidad_arena) {
+		return true;
+	}
+	char* arena = realloc(hash->arena, capacidad);
+	if (!arena) {
+		return false;
+	}
+	hash->arena = arena;
+	hash->capacidad_arena = capacidad;
+	return true;
+}
+
+/* Copia las claves vivas a una arena nueva, en orden de entrada. Si no hay
+ * memoria se deja la basura donde está.
+ */
+static void compactar_arena(hash_compacto_t* hash) {
+	size_t capacidad = ARENA_INICIAL;
+	while (capacidad < hash->largo_arena - hash->basura) {
+		capacidad *= 2;
+	}
+	char* arena = malloc(capacidad);
+	if (!arena) {
+		return;
+	}
+	size_t largo = 0;
+	for (size_t e = 0; e < hash->cantidad; e++) {
+		size_t largo_clave = strlen(clave_de(hash, e)) + 1;
+		memcpy(arena + largo, clave_de(hash, e), largo_clave);
+		hash->claves[e] = (uint32_t)largo;
+		largo += largo_clave;
+	}
+	free(hash->arena);
+	hash->arena = arena;
+	hash->largo_arena = largo;
+	hash->capacidad_arena = capacidad;
+	hash->basura = 0;
+}
+
+/* Vacía la ranura pos corriendo hacia atrás las claves que siguen en el
+ * mismo grupo, para que ninguna búsqueda se corte en el hueco. Así la
+ * tabla nunca tiene marcas de borrado.
+ */
+static void vaciar_ranura(hash_compacto_t* hash, size_t pos) {
+	size_t mascara = hash->capacidad - 1;
+	size_t hueco = pos;
+	for (size_t i = (pos + 1) & mascara; hash->ranuras[i] != LIBRE; i = (i + 1) & mascara) {
+		size_t propia = hash_funcion(clave_de(hash, hash->ranuras[i] - 1)) & mascara;
+		// se mueve si su ranura propia no está entre el hueco y ella
+		if (((i - propia) & mascara) >= ((i - hueco) & mascara)) {
+			hash->ranuras[hueco] = hash->ranuras[i];
+			hash->huellas[hueco] = hash->huellas[i];
+			hueco = i;
+		}
+	}
+	hash->ranuras[hueco] = LIBRE;
+}
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL HASH
+ * *****************************************************************/
+
+hash_compacto_t *hash_compacto_crear(hash_destruir_dato_t destruir_dato) {
+	hash_compacto_t* hash = malloc(sizeof(hash_compacto_t));
+	if (!hash) {
+		return NULL;
+	}
+	hash->ranuras = calloc(CAPACIDAD_INICIAL, sizeof(uint32_t));
+	hash->huellas = malloc(CAPACIDAD_INICIAL * sizeof(uint16_t));
+	hash->claves = malloc(ENTRADAS_INICIALES * sizeof(uint32_t));
+	hash->datos = malloc(ENTRADAS_INICIALES * sizeof(void*));
+	hash->arena = malloc(ARENA_INICIAL);
+	if (!hash->ranuras || !hash->huellas || !hash->claves || !hash->datos || !hash->arena) {
+		free(hash->ranuras);
+		free(hash->huellas);
+		free(hash->claves);
+		free(hash->datos);
+		free(hash->arena);
+		free(hash);
+		return NULL;
+	}
+	hash->capacidad = CAPACIDAD_INICIAL;
+	hash->cantidad = 0;
+	hash->capacidad_entradas = ENTRADAS_INICIALES;
+	hash->largo_arena = 0;
+	hash->capacidad_arena = ARENA_INICIAL;
+	hash->basura = 0;
+	hash->destruir_dato = destruir_dato;
+	hash->mapa = NULL;
+	hash->largo_mapa = 0;
+	return hash;
+}
+
+bool hash_compacto_guardar(hash_compacto_t *hash, const char *clave, void *dato) {
+	if (hash->mapa) {
+		return false;
+	}
+	unsigned long h = hash_funcion(clave);
+	size_t pos;
+	if (buscar(hash, clave, h, &pos)) {
+		size_t entrada = hash->ranuras[pos] - 1;
+		if (hash->destruir_dato) {
+			hash->destruir_dato(hash->datos[entrada]);
+		}
+		hash->datos[entrada] = dato;
+		return true;
+	}
+	size_t largo = strlen(clave) + 1;
+	if (hash->cantidad == MAX_ENTRADAS || !reservar_entradas(hash) || !reservar_arena(hash, largo)) {
+		return false;
+	}
+	if ((hash->cantidad + 1) * MAX_OCUPACION_DEN > hash->capacidad * MAX_OCUPACION_NUM) {
+		if (!hash_compacto_redimensionar(hash, hash->capacidad * 2)) {
+			return false;
+		}
+		buscar(hash, clave, h, &pos);
+	}
+	memcpy(hash->arena + hash->largo_arena, clave, largo);
+	hash->claves[hash->cantidad] = (uint32_t)hash->largo_arena;
+	hash->datos[hash->cantidad] = dato;
+	hash->largo_arena += largo;
+	hash->ranuras[pos] = (uint32_t)(hash->cantidad + 1);
+	hash->huellas[pos] = huella_de(h);
+	hash->cantidad++;
+	return true;
+}
+
+void *hash_compacto_borrar(hash_compacto_t *hash, const char *clave) {
+	size_t pos;
+	if (hash->mapa || !buscar(hash, clave, hash_funcion(clave), &pos)) {
+		return NULL;
+	}
+	size_t entrada = hash->ranuras[pos] - 1;
+	void* dato = hash->datos[entrada];
+	hash->basura += strlen(clave_de(hash, entrada)) + 1;
+	vaciar_ranura(hash, pos);
+
+	// la última entrada pasa al hueco y su ranura se actualiza
+	size_t ultima = --hash->cantidad;
+	if (entrada != ultima) {
+		size_t ranura = ranura_de_entrada(hash, ultima);
+		hash->claves[entrada] = hash->claves[ultima];
+		hash->datos[entrada] = hash->datos[ultima];
+		hash->ranuras[ranura] = (uint32_t)(entrada + 1);
+	}
+	if (hash->basura > ARENA_INICIAL && hash->basura * 2 > hash->largo_arena) {
+		compactar_arena(hash);
+	}
+	return dato;
+}
+
+void *hash_compacto_obtener(const hash_compacto_t *hash, const char *clave) {
+	size_t pos;
+	if (!buscar(hash, clave, hash_funcion(clave), &pos)) {
+		return NULL;
+	}
+	return hash->datos[hash->ranuras[pos] - 1];
+}
+
+bool hash_compacto_pertenece(const hash_compacto_t *hash, const char *clave) {
+	size_t pos;
+	return buscar(hash, clave, hash_funcion(clave), &pos);
+}
+
+size_t hash_compacto_cantidad(const hash_compacto_t *hash) {
+	return hash->cantidad;
+}
+
+void hash_compacto_estadisticas(const hash_compacto_t *hash, hash_compacto_estadisticas_t *estadisticas) {
+	estadisticas->cantidad = hash->cantidad;
+	estadisticas->ranuras = hash->capacidad;
+	estadisticas->bytes_tabla = hash->capacidad * (sizeof(uint32_t) + sizeof(uint16_t));
+	estadisticas->bytes_entradas = hash->capacidad_entradas * (sizeof(uint32_t) + sizeof(void*));
+	estadisticas->bytes_claves = hash->capacidad_arena;
+	estadisticas->bytes_totales = sizeof(hash_compacto_t) + estadisticas->bytes_tabla
+		+ estadisticas->bytes_entradas + estadisticas->bytes_claves;
+	size_t texto = hash->largo_arena - hash->basura;
+	size_t cantidad = hash->cantidad ? hash->cantidad : 1;
+	estadisticas->bytes_por_entrada = (double)estadisticas->bytes_totales / (double)cantidad;
+	estadisticas->sobrecarga_por_entrada = (double)(estadisticas->bytes_totales - texto) / (double)cantidad;
+}
+
+void hash_compacto_destruir(hash_compacto_t *hash) {
+	if (hash->mapa) {
+		munmap(hash->mapa, hash->largo_mapa);
+		free(hash);
+		return;
+	}
+	if (hash->destruir_dato) {
+		for (size_t e = 0; e < hash->cantidad; e++) {
+			hash->destruir_dato(hash->datos[e]);
+		}
+	}
+	free(hash->ranuras);
+	free(hash->huellas);
+	free(hash->claves);
+	free(hash->datos);
+	free(hash->arena);
+	free(hash);
+}
+
+
+/* ******************************************************************
+ *                    CONSULTAS POR LOTES
+ * *****************************************************************/
+
+/* Pide al kernel que empiece a leer la página de direccion sin esperarla.
+ * En una tabla en memoria no hace nada: todo ya está ahí.
+ */
+static void anticipar(const hash_compacto_t* hash, const void* direccion) {
+	if (!hash->mapa) {
+		return;
+	}
+	uintptr_t pagina = (uintptr_t)sysconf(_SC_PAGESIZE);
+	uintptr_t inicio = (uintptr_t)direccion & ~(pagina - 1);
+	posix_madvise((void*)inicio, pagina, POSIX_MADV_WILLNEED);
+}
+
+/* Cada búsqueda toca tres zonas que dependen una de la otra: la ranura, el
+ * desplazamiento de la clave y la clave. Por tandas, se anticipa una zona
+ * para todas las claves antes de leerla en cualquiera, así las lecturas
+ * del disco de la tanda se superponen en lugar de hacerse de a una.
+ */
+void hash_compacto_obtener_lote(const hash_compacto_t *hash, const char **claves, size_t cantidad, void **datos) {
+	size_t mascara = hash->capacidad - 1;
+	for (size_t base = 0; base < cantidad; base += CLAVES_POR_TANDA) {
+		size_t tanda = cantidad - base < CLAVES_POR_TANDA ? cantidad - base : CLAVES_POR_TANDA;
+		unsigned long hashes[CLAVES_POR_TANDA];
+		for (size_t j = 0; j < tanda; j++) {
+			hashes[j] = hash_funcion(claves[base + j]);
+			anticipar(hash, &hash->ranuras[hashes[j] & mascara]);
+			anticipar(hash, &hash->huellas[hashes[j] & mascara]);
+		}
+		for (size_t j = 0; j < tanda; j++) {
+			uint32_t entrada = hash->ranuras[hashes[j] & mascara];
+			if (entrada != LIBRE) {
+				anticipar(hash, &hash->claves[entrada - 1]);
+				anticipar(hash, &hash->datos[entrada - 1]);
+			}
+		}
+		for (size_t j = 0; j < tanda; j++) {
+			uint32_t entrada = hash->ranuras[hashes[j] & mascara];
+			if (entrada != LIBRE) {
+				anticipar(hash, clave_de(hash, entrada - 1));
+			}
+		}
+		for (size_t j = 0; j < tanda; j++) {
+			size_t pos;
+			bool esta = buscar(hash, claves[base + j], hashes[j], &pos);
+			datos[base + j] = esta ? hash->datos[hash->ranuras[pos] - 1] : NULL;
+		}
+	}
+}
+
+
+/* ******************************************************************
+ *                    ARCHIVO MAPEADO
+ * *****************************************************************/
+
+static size_t alinear(size_t largo) {
+	return (largo + 7) & ~(size_t)7;
+}
+
+// Escribe largo bytes y rellena con ceros hasta alinear a 8
+static bool escribir_seccion(FILE* archivo, const void* datos, size_t largo) {
+	static const char ceros[8] = {0};
+	return fwrite(datos, 1, largo, archivo) == largo
+		&& fwrite(ceros, 1, alinear(largo) - largo, archivo) == alinear(largo) - largo;
+}
+
+bool hash_compacto_escribir(const hash_compacto_t *hash, const char *ruta) {
+	char* temporal = malloc(strlen(ruta) + sizeof(".tmp"));
+	if (!temporal) {
+		return false;
+	}
+	sprintf(temporal, "%s.tmp", ruta);
+	FILE* archivo = fopen(temporal, "wb");
+	if (!archivo) {
+		free(temporal);
+		return false;
+	}
+	encabezado_t encabezado;
+	memset(&encabezado, 0, sizeof(encabezado));
+	memcpy(encabezado.magia, MAGIA_ARCHIVO, sizeof(encabezado.magia));
+	encabezado.version = VERSION_ARCHIVO;
+	encabezado.tam_dato = sizeof(void*);
+	encabezado.capacidad = hash->capacidad;
+	encabezado.cantidad = hash->cantidad;
+	encabezado.largo_arena = hash->largo_arena;
+	bool ok = escribir_seccion(archivo, &encabezado, sizeof(encabezado))
+		&& escribir_seccion(archivo, hash->ranuras, hash->capacidad * sizeof(uint32_t))
+		&& escribir_seccion(archivo, hash->huellas, hash->capacidad * sizeof(uint16_t))
+		&& escribir_seccion(archivo, hash->claves, hash->cantidad * sizeof(uint32_t))
+		&& escribir_seccion(archivo, hash->datos, hash->cantidad * sizeof(void*))
+		&& escribir_seccion(archivo, hash->arena, hash->largo_arena);
+	ok = fclose(archivo) == 0 && ok;
+	// el archivo anterior sigue valiendo hasta que el nuevo está completo
+	ok = ok && rename(temporal, ruta) == 0;
+	if (!ok) {
+		remove(temporal);
+	}
+	free(temporal);
+	return ok;
+}
+
+/* Lo que las búsquedas dan por cierto sin mirar: cada ranura apunta a una
+ * entrada que existe, queda al menos una libre (si no, buscar una clave que
+ * no está no termina), cada clave empieza dentro de la arena y la arena
+ * termina en '\0'.
+ */
+static bool secciones_validas(const hash_compacto_t* hash) {
+	if (hash->cantidad > 0 && (hash->largo_arena == 0 || hash->arena[hash->largo_arena - 1] != '\0')) {
+		return false;
+	}
+	size_t ocupadas = 0;
+	for (size_t i = 0; i < hash->capacidad; i++) {
+		if (hash->ranuras[i] > hash->cantidad) {
+			return false;
+		}
+		ocupadas += hash->ranuras[i] != LIBRE;
+	}
+	if (ocupadas == hash->capacidad) {
+		return false;
+	}
+	for (size_t e = 0; e < hash->cantidad; e++) {
+		if (hash->claves[e] >= hash->largo_arena) {
+			return false;
+		}
+	}
+	return true;
+}
+
+hash_compacto_t *hash_compacto_mapear(const char *ruta) {
+	int fd = open(ruta, O_RDONLY);
+	if (fd < 0) {
+		return NULL;
+	}
+	struct stat estado;
+	if (fstat(fd, &estado) != 0 || (size_t)estado.st_size < sizeof(encabezado_t)) {
+		close(fd);
+		return NULL;
+	}
+	size_t largo = (size_t)estado.st_size;
+	char* mapa = mmap(NULL, largo, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapa == MAP_FAILED) {
+		return NULL;
+	}
+	// validarlo lo recorre de punta a punta; después se lee salteado
+	posix_madvise(mapa, largo, POSIX_MADV_SEQUENTIAL);
+
+	const encabezado_t* encabezado = (const encabezado_t*)mapa;
+	size_t capacidad = encabezado->capacidad;
+	size_t cantidad = encabezado->cantidad;
+	size_t secciones[] = {
+		alinear(sizeof(encabezado_t)),
+		alinear(capacidad * sizeof(uint32_t)),
+		alinear(capacidad * sizeof(uint16_t)),
+		alinear(cantidad * sizeof(uint32_t)),
+		alinear(cantidad * sizeof(void*)),
+		alinear(encabezado->largo_arena),
+	};
+	size_t total = 0;
+	for (size_t i = 0; i < sizeof(secciones) / sizeof(secciones[0]); i++) {
+		total += secciones[i];
+	}
+	hash_compacto_t* hash = malloc(sizeof(hash_compacto_t));
+	bool valido = memcmp(encabezado->magia, MAGIA_ARCHIVO, sizeof(encabezado->magia)) == 0
+		&& encabezado->version == VERSION_ARCHIVO && encabezado->tam_dato == sizeof(void*)
+		&& capacidad >= CAPACIDAD_INICIAL && (capacidad & (capacidad - 1)) == 0 && cantidad < capacidad
+		&& capacidad <= largo && encabezado->largo_arena <= MAX_ARENA && total == largo;
+	if (!hash || !valido) {
+		free(hash);
+		munmap(mapa, largo);
+		return NULL;
+	}
+	char* actual = mapa + secciones[0];
+	hash->ranuras = (uint32_t*)actual;
+	actual += secciones[1];
+	hash->huellas = (uint16_t*)actual;
+	actual += secciones[2];
+	hash->claves = (uint32_t*)actual;
+	actual += secciones[3];
+	hash->datos = (void**)actual;
+	actual += secciones[4];
+	hash->arena = actual;
+	hash->capacidad = capacidad;
+	hash->cantidad = cantidad;
+	hash->capacidad_entradas = cantidad;
+	hash->largo_arena = encabezado->largo_arena;
+	hash->capacidad_arena = encabezado->largo_arena;
+	hash->basura = 0;
+	hash->destruir_dato = NULL;
+	hash->mapa = mapa;
+	hash->largo_mapa = largo;
+	if (!secciones_validas(hash)) {
+		free(hash);
+		munmap(mapa, largo);
+		return NULL;
+	}
+	// las búsquedas saltan por todo el archivo: leer de más no sirve
+	posix_madvise(mapa, largo, POSIX_MADV_RANDOM);
+	return hash;
+}
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL ITERADOR
+ * *****************************************************************/
+
+hash_compacto_iter_t *hash_compacto_iter_crear(const hash_compacto_t *hash) {
+	hash_compacto_iter_t* iter = malloc(sizeof(hash_compacto_iter_t));
+	if (!iter) {
+		return NULL;
+	}
+	iter->hash = hash;
+	iter->actual = 0;
+	return iter;
+}
+
+bool hash_compacto_iter_avanzar(hash_compacto_iter_t *iter) {
+	if (hash_compacto_iter_al_final(iter)) {
+		return false;
+	}
+	iter->actual++;
+	return true;
+}
+
+const char *hash_compacto_iter_ver_actual(const hash_compacto_iter_t *iter) {
+	if (hash_compacto_iter_al_final(iter)) {
+		return NULL;
+	}
+	return clave_de(iter->hash, iter->actual);
+}
+
+bool hash_compacto_iter_al_final(const hash_compacto_iter_t *iter) {
+	return iter->actual >= iter->hash->cantidad;
+}
+
+void hash_compacto_iter_destruir(hash_compacto_iter_t *iter) {
+	free(iter);
+}
@@ -0,0 +1,130 @@
+#ifndef HASH_COMPACTO_H
+#define HASH_COMPACTO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "hash.h"
+
+/* Diccionario para cuando la memoria es lo que escasea. No hay nodos ni
+ * punteros por clave:
+ * - la tabla es de direccionamiento abierto, y cada ranura guarda el
+ *   índice de 32 bits de la entrada y una huella de 16 bits del hash, que
+ *   descarta casi todas las comparaciones de claves sin salir de la tabla;
+ * - las entradas viven en dos arreglos densos: el desplazamiento de la
+ *   clave y el dato, que va en el arreglo mismo (un entero chico se guarda
+ *   como puntero, sin memoria aparte);
+ * - las claves se copian una detrás de otra en una sola arena.
+ * Cuesta unos 20 bytes por clave más el texto de la clave, contra los ~100
+ * de hash_t. A cambio no guarda el hash de cada clave: redimensionar y
+ * borrar lo vuelven a calcular.
+ *
+ * Admite hasta 2^32 - 2 claves y 4 GB de texto de claves.
+ */
+
+struct hash_compacto;
+struct hash_compacto_iter;
+
+typedef struct hash_compacto hash_compacto_t;
+typedef struct hash_compacto_iter hash_compacto_iter_t;
+
+// Lo que ocupa el hash, en bytes pedidos (sin contar lo que agrega malloc).
+typedef struct hash_compacto_estadisticas {
+	size_t cantidad;
+	size_t ranuras;
+	size_t bytes_tabla;       // ranuras y huellas
+	size_t bytes_entradas;    // desplazamientos y datos, con la capacidad de sobra
+	size_t bytes_claves;      // arena, incluidas las claves borradas sin compactar
+	size_t bytes_totales;
+	double bytes_por_entrada;
+	double sobrecarga_por_entrada; // sin contar el texto de las claves vivas
+} hash_compacto_estadisticas_t;
+
+/* Crea el hash
+ */
+hash_compacto_t *hash_compacto_crear(hash_destruir_dato_t destruir_dato);
+
+/* Guarda un elemento en el hash, si la clave ya se encuentra en la
+ * estructura, la reemplaza. De no poder guardarlo (sin memoria o pasado
+ * el límite) devuelve false.
+ * Pre: el hash fue creado.
+ * Post: Se almacenó el par (clave, dato)
+ */
+bool hash_compacto_guardar(hash_compacto_t *hash, const char *clave, void *dato);
+
+/* Borra un elemento del hash y devuelve el dato asociado. Devuelve NULL si
+ * la clave no estaba.
+ * Pre: el hash fue creado.
+ */
+void *hash_compacto_borrar(hash_compacto_t *hash, const char *clave);
+
+/* Obtiene el valor de un elemento del hash, si la clave no se encuentra
+ * devuelve NULL.
+ * Pre: el hash fue creado.
+ */
+void *hash_compacto_obtener(const hash_compacto_t *hash, const char *clave);
+
+/* Determina si clave pertenece o no al hash.
+ * Pre: el hash fue creado.
+ */
+bool hash_compacto_pertenece(const hash_compacto_t *hash, const char *clave);
+
+/* Devuelve la cantidad de elementos del hash.
+ * Pre: el hash fue creado.
+ */
+size_t hash_compacto_cantidad(const hash_compacto_t *hash);
+
+/* Completa estadisticas con lo que ocupa el hash.
+ * Pre: el hash fue creado.
+ */
+void hash_compacto_estadisticas(const hash_compacto_t *hash, hash_compacto_estadisticas_t *estadisticas);
+
+/* Busca las cantidad claves y deja en datos[i] el dato de claves[i] (NULL
+ * si no está). En un hash mapeado pide por adelantado las páginas que va a
+ * leer para todo el lote, así las lecturas del disco se superponen en vez
+ * de esperarse de a una.
+ * Pre: el hash fue creado o mapeado; datos tiene lugar para cantidad.
+ */
+void hash_compacto_obtener_lote(const hash_compacto_t *hash, const char **claves, size_t cantidad, void **datos);
+
+/* Escribe el hash en el archivo ruta, en un formato que hash_compacto_mapear
+ * puede usar sin leerlo. Los datos se guardan tal cual: sólo tiene sentido
+ * si son valores (enteros empaquetados), no punteros. Devuelve false si no
+ * pudo escribirlo; el archivo anterior, si había, queda intacto.
+ * Pre: el hash fue creado.
+ */
+bool hash_compacto_escribir(const hash_compacto_t *hash, const char *ruta);
+
+/* Abre el archivo escrito por hash_compacto_escribir sin cargarlo: la tabla
+ * se lee del disco a medida que se consulta, así que puede ser más grande
+ * que la memoria. El hash devuelto es de sólo lectura (guardar y borrar
+ * fallan) y se cierra con hash_compacto_destruir. Al abrirlo se recorren
+ * una vez las ranuras y las entradas para validarlas: un archivo dañado
+ * no hace leer fuera del mapeo ni deja búsquedas sin terminar.
+ * Post: devuelve el hash, o NULL si el archivo no existe o no es válido.
+ */
+hash_compacto_t *hash_compacto_mapear(const char *ruta);
+
+/* Destruye la estructura liberando la memoria pedida y llamando a la función
+ * destruir para cada par (clave, dato).
+ * Pre: el hash fue creado o mapeado.
+ */
+void hash_compacto_destruir(hash_compacto_t *hash);
+
+/* Iterador del hash: recorre las entradas en el orden de sus arreglos. */
+
+// Crea iterador
+hash_compacto_iter_t *hash_compacto_iter_crear(const hash_compacto_t *hash);
+
+// Avanza iterador
+bool hash_compacto_iter_avanzar(hash_compacto_iter_t *iter);
+
+// Devuelve clave actual, esa clave no se puede modificar ni liberar.
+const char *hash_compacto_iter_ver_actual(const hash_compacto_iter_t *iter);
+
+// Comprueba si terminó la iteración
+bool hash_compacto_iter_al_final(const hash_compacto_iter_t *iter);
+
+// Destruye iterador
+void hash_compacto_iter_destruir(hash_compacto_iter_t *iter);
+
+#endif // HASH_COMPACTO_H
@@ -0,0 +1,640 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+#include "epoca.h"
+#include "hash_cuco.h"
+
+#define CAPACIDAD_INICIAL 16 // en baldes, siempre potencia de 2
+#define VIAS 4
+#define TAM_LINEA_CACHE 64
+#define MAX_LARGO_CAMINO 5
+#define MAX_NODOS_CAMINO 512
+#define MAX_ESPACIO_USADO 0.9 // de los lugares, antes de que el BFS se alargue
+#define MAX_RETIRADAS 256
+#define MEZCLA_ETIQUETA 0x5bd1e995u
+
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+// La clave y el hash de una entrada no cambian mientras está en la tabla;
+// el dato sí (al reemplazar), por eso es atómico.
+typedef struct entrada {
+	char* clave;
+	_Atomic(void*) dato;
+	unsigned long hash;
+} entrada_t;
+
+/* Un balde por línea de cache. version es impar mientras el escritor lo
+ * está modificando. etiquetas guarda 8 bits del hash de cada vía (0 marca
+ * la vía libre) para descartar vías sin tocar la entrada.
+ */
+typedef struct balde {
+	atomic_uint version;
+	atomic_uint etiquetas;
+	_Atomic(entrada_t*) entradas[VIAS];
+	char relleno[TAM_LINEA_CACHE - 2 * sizeof(atomic_uint) - VIAS * sizeof(entrada_t*)];
+} balde_t;
+
+typedef struct tabla {
+	balde_t* baldes;
+	size_t mascara;
+} tabla_t;
+
+/* Los lectores se anotan en lectores[paridad] mientras recorren la tabla.
+ * Las entradas borradas y las tablas viejas no se liberan hasta que el
+ * escritor espera a que se vayan todos los que podían verlas.
+ */
+struct hash_cuco {
+	_Atomic(tabla_t*) tabla;
+	atomic_size_t cantidad;
+	hash_destruir_dato_t destruir_dato;
+	epoca_t* epoca; // si no es NULL, los datos se retiran en lugar de destruirse
+	pthread_mutex_t escritura;
+	atomic_size_t lectores[2];
+	atomic_uint paridad;
+	entrada_t* retiradas[MAX_RETIRADAS];
+	size_t cantidad_retiradas;
+};
+
+struct hash_cuco_iter {
+	const hash_cuco_t* hash;
+	size_t balde;
+	size_t via;
+};
+
+// Un paso del BFS: el balde al que se llega y desde qué vía del padre.
+typedef struct paso {
+	size_t balde;
+	int padre;
+	int via;
+	int largo;
+} paso_t;
+
+
+/* ******************************************************************
+ *                    FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+/* El balde primario son los bits bajos del hash. La etiqueta sale de la
+ * mezcla del hash entero: con bits fijos, pasados los 2^24 baldes se
+ * pisarían con los del balde, y todas las claves de un balde tendrían casi
+ * los mismos alternativos.
+ */
+static uint8_t etiqueta_de(unsigned long h) {
+	uint8_t etiqueta = (uint8_t)(hash_mezclar(h) >> 56);
+	return etiqueta ? etiqueta : 1;
+}
+
+/* El segundo balde se deriva del primero y la etiqueta (cuco de clave
+ * parcial): con el XOR, el alternativo de cualquiera de los dos es el otro,
+ * así que una entrada se puede mover sin volver a leer su clave.
+ */
+static size_t alternativo(size_t balde, uint8_t etiqueta, size_t mascara) {
+	return (balde ^ (etiqueta * MEZCLA_ETIQUETA)) & mascara;
+}
+
+static uint8_t etiqueta_en(unsigned etiquetas, int via) {
+	return (uint8_t)(etiquetas >> (8 * via));
+}
+
+static unsigned con_etiqueta(unsigned etiquetas, int via, uint8_t etiqueta) {
+	etiquetas &= ~(0xFFu << (8 * via));
+	return etiquetas | ((unsigned)etiqueta << (8 * via));
+}
+
+static tabla_t* crear_tabla(size_t capacidad) {
+	tabla_t* tabla = malloc(sizeof(tabla_t));
+	if (!tabla) {
+		return NULL;
+	}
+	void* baldes;
+	if (posix_memalign(&baldes, TAM_LINEA_CACHE, capacidad * sizeof(balde_t)) != 0) {
+		free(tabla);
+		return NULL;
+	}
+	tabla->baldes = baldes;
+	tabla->mascara = capacidad - 1;
+	for (size_t i = 0; i < capacidad; i++) {
+		atomic_init(&tabla->baldes[i].version, 0);
+		atomic_init(&tabla->baldes[i].etiquetas, 0);
+		for (int v = 0; v < VIAS; v++) {
+			atomic_init(&tabla->baldes[i].entradas[v], NULL);
+		}
+	}
+	return tabla;
+}
+
+static void liberar_tabla(tabla_t* tabla) {
+	free(tabla->baldes);
+	free(tabla);
+}
+
+static void descartar_dato(const hash_cuco_t* hash, void* dato) {
+	if (!hash->destruir_dato) {
+		return;
+	}
+	if (hash->epoca) {
+		epoca_retirar(hash->epoca, dato, hash->destruir_dato);
+	} else {
+		hash->destruir_dato(dato);
+	}
+}
+
+static void liberar_entrada(entrada_t* entrada) {
+	free(entrada->clave);
+	free(entrada);
+}
+
+
+/* ******************************************************************
+ *                    ESCRITURA DE LOS BALDES
+ * *****************************************************************/
+
+/* Sólo el escritor (con el mutex tomado) llama a estas funciones. Entre
+ * abrir y cerrar un balde su versión es impar y los lectores que lo leyeron
+ * reintentan.
+ */
+static void balde_abrir(balde_t* balde) {
+	unsigned version = atomic_load_explicit(&balde->version, memory_order_relaxed);
+	atomic_store_explicit(&balde->version, version + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+}
+
+static void balde_cerrar(balde_t* balde) {
+	unsigned version = atomic_load_explicit(&balde->version, memory_order_relaxed);
+	atomic_store_explicit(&balde->version, version + 1, memory_order_release);
+}
+
+static void balde_poner(balde_t* balde, int via, entrada_t* entrada, uint8_t etiqueta) {
+	unsigned etiquetas = atomic_load_explicit(&balde->etiquetas, memory_order_relaxed);
+	atomic_store_explicit(&balde->entradas[via], entrada, memory_order_relaxed);
+	atomic_store_explicit(&balde->etiquetas, con_etiqueta(etiquetas, via, etiqueta), memory_order_relaxed);
+}
+
+static int via_libre(const balde_t* balde) {
+	unsigned etiquetas = atomic_load_explicit(&balde->etiquetas, memory_order_relaxed);
+	for (int v = 0; v < VIAS; v++) {
+		if (etiqueta_en(etiquetas, v) == 0) {
+			return v;
+		}
+	}
+	return -1;
+}
+
+// Mueve la entrada de (origen, via_origen) al lugar libre (destino, via_destino).
+static void mover(tabla_t* tabla, size_t origen, int via_origen, size_t destino, int via_destino) {
+	balde_t* desde = &tabla->baldes[origen];
+	balde_t* hasta = &tabla->baldes[destino];
+	entrada_t* entrada = atomic_load_explicit(&desde->entradas[via_origen], memory_order_relaxed);
+	uint8_t etiqueta = etiqueta_en(atomic_load_explicit(&desde->etiquetas, memory_order_relaxed), via_origen);
+	balde_abrir(desde);
+	if (hasta != desde) {
+		balde_abrir(hasta);
+	}
+	balde_poner(hasta, via_destino, entrada, etiqueta);
+	balde_poner(desde, via_origen, NULL, 0);
+	if (hasta != desde) {
+		balde_cerrar(hasta);
+	}
+	balde_cerrar(desde);
+}
+
+/* Un camino no pasa dos veces por el mismo balde: así cada movimiento vacía
+ * una vía que ningún movimiento anterior del camino tocó.
+ */
+static bool en_camino(const paso_t* pasos, int paso, size_t balde) {
+	for (; paso >= 0; paso = pasos[paso].padre) {
+		if (pasos[paso].balde == balde) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Busca a lo ancho, desde los dos baldes de la entrada, el camino de
+ * desplazamientos más corto que termina en un balde con lugar, y lo
+ * recorre de atrás para adelante: cada movimiento deja un hueco donde cae
+ * el anterior, así que la entrada desplazada nunca deja de estar en la
+ * tabla. Devuelve false si no hay camino de a lo sumo MAX_LARGO_CAMINO.
+ */
+static bool insertar_entrada(tabla_t* tabla, entrada_t* entrada) {
+	uint8_t etiqueta = etiqueta_de(entrada->hash);
+	size_t primero = entrada->hash & tabla->mascara;
+	size_t segundo = alternativo(primero, etiqueta, tabla->mascara);
+
+	paso_t pasos[MAX_NODOS_CAMINO];
+	int cantidad = 0;
+	pasos[cantidad++] = (paso_t){primero, -1, -1, 0};
+	if (segundo != primero) {
+		pasos[cantidad++] = (paso_t){segundo, -1, -1, 0};
+	}
+	for (int i = 0; i < cantidad; i++) {
+		int via = via_libre(&tabla->baldes[pasos[i].balde]);
+		if (via >= 0) {
+			// hay lugar en uno de los baldes propios: no hace falta mover nada
+			balde_t* balde = &tabla->baldes[pasos[i].balde];
+			balde_abrir(balde);
+			balde_poner(balde, via, entrada, etiqueta);
+			balde_cerrar(balde);
+			return true;
+		}
+	}
+
+	for (int i = 0; i < cantidad; i++) {
+		const balde_t* balde = &tabla->baldes[pasos[i].balde];
+		unsigned etiquetas = atomic_load_explicit(&balde->etiquetas, memory_order_relaxed);
+		for (int v = 0; v < VIAS; v++) {
+			size_t destino = alternativo(pasos[i].balde, etiqueta_en(etiquetas, v), tabla->mascara);
+			int libre = via_libre(&tabla->baldes[destino]);
+			if (libre >= 0) {
+				// se mueve la vía v al lugar libre y se sube por el camino
+				size_t hueco = pasos[i].balde;
+				int via_hueco = v;
+				mover(tabla, hueco, via_hueco, destino, libre);
+				for (int j = i; pasos[j].padre >= 0; j = pasos[j].padre) {
+					const paso_t* padre = &pasos[pasos[j].padre];
+					mover(tabla, padre->balde, pasos[j].via, hueco, via_hueco);
+					hueco = padre->balde;
+					via_hueco = pasos[j].via;
+				}
+				balde_t* raiz = &tabla->baldes[hueco];
+				balde_abrir(raiz);
+				balde_poner(raiz, via_hueco, entrada, etiqueta);
+				balde_cerrar(raiz);
+				return true;
+			}
+			if (pasos[i].largo + 1 < MAX_LARGO_CAMINO && cantidad < MAX_NODOS_CAMINO && !en_camino(pasos, i, destino)) {
+				pasos[cantidad++] = (paso_t){destino, i, v, pasos[i].largo + 1};
+			}
+		}
+	}
+	return false;
+}
+
+/* Menor cantidad de baldes en la que entradas no superan el espacio usado
+ * máximo.
+ */
+static size_t capacidad_necesaria(size_t entradas) {
+	size_t capacidad = CAPACIDAD_INICIAL;
+	while ((double)entradas > (double)capacidad * VIAS * MAX_ESPACIO_USADO) {
+		capacidad *= 2;
+	}
+	return capacidad;
+}
+
+/* Pasa todas las entradas a una tabla nueva del doble de baldes y la
+ * publica. Si en la nueva no entran todas devuelve false y deja la vieja:
+ * seguir duplicando no ayuda cuando el problema son claves con el mismo
+ * hash. La tabla vieja no se toca, así que los lectores que la están
+ * recorriendo siguen viendo algo consistente hasta que el escritor los
+ * espera y la libera.
+ */
+static void esperar_lectores(hash_cuco_t* hash);
+
+static bool hash_cuco_agrandar(hash_cuco_t* hash) {
+	tabla_t* vieja = atomic_load_explicit(&hash->tabla, memory_order_relaxed);
+	tabla_t* nueva = crear_tabla((vieja->mascara + 1) * 2);
+	if (!nueva) {
+		return false;
+	}
+	for (size_t i = 0; i <= vieja->mascara; i++) {
+		for (int v = 0; v < VIAS; v++) {
+			entrada_t* entrada = atomic_load_explicit(&vieja->baldes[i].entradas[v], memory_order_relaxed);
+			if (entrada && !insertar_entrada(nueva, entrada)) {
+				liberar_tabla(nueva);
+				return false;
+			}
+		}
+	}
+	atomic_store_explicit(&hash->tabla, nueva, memory_order_release);
+	esperar_lectores(hash);
+	liberar_tabla(vieja);
+	return true;
+}
+
+
+/* ******************************************************************
+ *                    LECTURA DE LOS BALDES
+ * *****************************************************************/
+
+/* Lee los dos baldes de la clave como una foto: toma las versiones, junta
+ * las entradas cuya etiqueta coincide y vuelve a mirar las versiones. Las
+ * entradas sólo se mueven entre sus dos baldes, así que si ninguno cambió
+ * la foto no puede perder una clave que se estaba desplazando.
+ */
+static entrada_t* buscar(const tabla_t* tabla, const char* clave) {
+	unsigned long h = hash_funcion(clave);
+	uint8_t etiqueta = etiqueta_de(h);
+	size_t indices[2];
+	indices[0] = h & tabla->mascara;
+	indices[1] = alternativo(indices[0], etiqueta, tabla->mascara);
+
+	while (true) {
+		unsigned versiones[2];
+		entrada_t* candidatas[2 * VIAS];
+		size_t cantidad = 0;
+		bool abierto = false;
+		for (int b = 0; b < 2; b++) {
+			versiones[b] = atomic_load_explicit(&tabla->baldes[indices[b]].version, memory_order_acquire);
+			abierto = abierto || versiones[b] % 2 == 1;
+		}
+		if (abierto) {
+			sched_yield();
+			continue;
+		}
+		for (int b = 0; b < 2; b++) {
+			const balde_t* balde = &tabla->baldes[indices[b]];
+			unsigned etiquetas = atomic_load_explicit(&balde->etiquetas, memory_order_relaxed);
+			for (int v = 0; v < VIAS; v++) {
+				if (etiqueta_en(etiquetas, v) == etiqueta) {
+					candidatas[cantidad++] = atomic_load_explicit(&balde->entradas[v], memory_order_relaxed);
+				}
+			}
+		}
+		atomic_thread_fence(memory_order_acquire);
+		bool cambio = false;
+		for (int b = 0; b < 2; b++) {
+			unsigned version = atomic_load_explicit(&tabla->baldes[indices[b]].version, memory_order_relaxed);
+			cambio = cambio || version != versiones[b];
+		}
+		if (cambio) {
+			continue;
+		}
+		// la clave y el hash de una entrada publicada no cambian
+		for (size_t i = 0; i < cantidad; i++) {
+			if (candidatas[i] && candidatas[i]->hash == h && strcmp(candidatas[i]->clave, clave) == 0) {
+				return candidatas[i];
+			}
+		}
+		return NULL;
+	}
+}
+
+// Devuelve el balde y la vía de la clave; sólo para el escritor.
+static bool ubicar(const tabla_t* tabla, const char* clave, size_t* balde, int* via) {
+	unsigned long h = hash_funcion(clave);
+	uint8_t etiqueta = etiqueta_de(h);
+	size_t indices[2] = {h & tabla->mascara, 0};
+	indices[1] = alternativo(indices[0], etiqueta, tabla->mascara);
+	for (int b = 0; b < 2; b++) {
+		const balde_t* actual = &tabla->baldes[indices[b]];
+		unsigned etiquetas = atomic_load_explicit(&actual->etiquetas, memory_order_relaxed);
+		for (int v = 0; v < VIAS; v++) {
+			if (etiqueta_en(etiquetas, v) != etiqueta) {
+				continue;
+			}
+			entrada_t* entrada = atomic_load_explicit(&actual->entradas[v], memory_order_relaxed);
+			if (entrada->hash == h && strcmp(entrada->clave, clave) == 0) {
+				*balde = indices[b];
+				*via = v;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+
+/* ******************************************************************
+ *                    LECTORES CONCURRENTES
+ * *****************************************************************/
+
+/* Se cambia la paridad dos veces: los lectores nuevos se anotan en el
+ * contador que no se está esperando, así que la espera es acotada por lo
+ * que tarda una búsqueda.
+ */
+static void esperar_lectores(hash_cuco_t* hash) {
+	for (int i = 0; i < 2; i++) {
+		unsigned paridad = atomic_load(&hash->paridad);
+		atomic_store(&hash->paridad, paridad ^ 1);
+		while (atomic_load(&hash->lectores[paridad]) != 0) {
+			sched_yield();
+		}
+	}
+}
+
+static void vaciar_retiradas(hash_cuco_t* hash) {
+	esperar_lectores(hash);
+	for (size_t i = 0; i < hash->cantidad_retiradas; i++) {
+		liberar_entrada(hash->retiradas[i]);
+	}
+	hash->cantidad_retiradas = 0;
+}
+
+// Los lectores no modifican el hash: sólo se anotan en los contadores.
+static entrada_t* buscar_anotado(const hash_cuco_t* hash, const char* clave, void** dato) {
+	hash_cuco_t* anotado = (hash_cuco_t*)hash;
+	unsigned paridad = atomic_load(&anotado->paridad);
+	atomic_fetch_add(&anotado->lectores[paridad], 1);
+	entrada_t* entrada = buscar(atomic_load_explicit(&anotado->tabla, memory_order_acquire), clave);
+	if (entrada && dato) {
+		*dato = atomic_load_explicit(&entrada->dato, memory_order_acquire);
+	}
+	atomic_fetch_sub(&anotado->lectores[paridad], 1);
+	return entrada;
+}
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL HASH
+ * *****************************************************************/
+
+hash_cuco_t *hash_cuco_crear(hash_destruir_dato_t destruir_dato) {
+	hash_cuco_t* hash = malloc(sizeof(hash_cuco_t));
+	if (!hash) {
+		return NULL;
+	}
+	tabla_t* tabla = crear_tabla(CAPACIDAD_INICIAL);
+	if (!tabla) {
+		free(hash);
+		return NULL;
+	}
+	atomic_init(&hash->tabla, tabla);
+	atomic_init(&hash->cantidad, 0);
+	hash->destruir_dato = destruir_dato;
+	hash->epoca = NULL;
+	pthread_mutex_init(&hash->escritura, NULL);
+	atomic_init(&hash->lectores[0], 0);
+	atomic_init(&hash->lectores[1], 0);
+	atomic_init(&hash->paridad, 0);
+	hash->cantidad_retiradas = 0;
+	return hash;
+}
+
+bool hash_cuco_guardar(hash_cuco_t *hash, const char *clave, void *dato) {
+	pthread_mutex_lock(&hash->escritura);
+	tabla_t* tabla = atomic_load_explicit(&hash->tabla, memory_order_relaxed);
+	size_t balde;
+	int via;
+	if (ubicar(tabla, clave, &balde, &via)) {
+		entrada_t* entrada = atomic_load_explicit(&tabla->baldes[balde].entradas[via], memory_order_relaxed);
+		void* anterior = atomic_exchange_explicit(&entrada->dato, dato, memory_order_acq_rel);
+		pthread_mutex_unlock(&hash->escritura);
+		descartar_dato(hash, anterior);
+		return true;
+	}
+
+	entrada_t* entrada = malloc(sizeof(entrada_t));
+	char* copia = malloc(strlen(clave) + 1);
+	if (!entrada || !copia) {
+		free(entrada);
+		free(copia);
+		pthread_mutex_unlock(&hash->escritura);
+		return false;
+	}
+	strcpy(copia, clave);
+	entrada->clave = copia;
+	atomic_init(&entrada->dato, dato);
+	entrada->hash = hash_funcion(clave);
+
+	// Con la tabla casi llena los caminos se alargan: conviene agrandar antes
+	if (atomic_load_explicit(&hash->cantidad, memory_order_relaxed) + 1 > (double)(tabla->mascara + 1) * VIAS * MAX_ESPACIO_USADO) {
+		hash_cuco_agrandar(hash);
+	}
+	// Un camino fallido con poca carga puede ser mala suerte y se admite
+	// duplicar una vez más allá de lo que pide la carga; si tampoco alcanza,
+	// la clave choca con otras que ya llenaron sus dos baldes.
+	size_t limite = capacidad_necesaria(atomic_load_explicit(&hash->cantidad, memory_order_relaxed) + 1) * 2;
+	while (!insertar_entrada(atomic_load_explicit(&hash->tabla, memory_order_relaxed), entrada)) {
+		tabla_t* tabla_actual = atomic_load_explicit(&hash->tabla, memory_order_relaxed);
+		if ((tabla_actual->mascara + 1) * 2 > limite || !hash_cuco_agrandar(hash)) {
+			free(copia);
+			free(entrada);
+			pthread_mutex_unlock(&hash->escritura);
+			return false;
+		}
+	}
+	atomic_fetch_add_explicit(&hash->cantidad, 1, memory_order_relaxed);
+	pthread_mutex_unlock(&hash->escritura);
+	return true;
+}
+
+void *hash_cuco_borrar(hash_cuco_t *hash, const char *clave) {
+	pthread_mutex_lock(&hash->escritura);
+	tabla_t* tabla = atomic_load_explicit(&hash->tabla, memory_order_relaxed);
+	size_t indice;
+	int via;
+	if (!ubicar(tabla, clave, &indice, &via)) {
+		pthread_mutex_unlock(&hash->escritura);
+		return NULL;
+	}
+	balde_t* balde = &tabla->baldes[indice];
+	entrada_t* entrada = atomic_load_explicit(&balde->entradas[via], memory_order_relaxed);
+	balde_abrir(balde);
+	balde_poner(balde, via, NULL, 0);
+	balde_cerrar(balde);
+	atomic_fetch_sub_explicit(&hash->cantidad, 1, memory_order_relaxed);
+
+	// Un lector puede estar comparando la clave: se libera más tarde
+	void* dato = atomic_load_explicit(&entrada->dato, memory_order_relaxed);
+	if (hash->cantidad_retiradas == MAX_RETIRADAS) {
+		vaciar_retiradas(hash);
+	}
+	hash->retiradas[hash->cantidad_retiradas++] = entrada;
+	pthread_mutex_unlock(&hash->escritura);
+	return dato;
+}
+
+void *hash_cuco_obtener(const hash_cuco_t *hash, const char *clave) {
+	void* dato = NULL;
+	buscar_anotado(hash, clave, &dato);
+	return dato;
+}
+
+bool hash_cuco_pertenece(const hash_cuco_t *hash, const char *clave) {
+	return buscar_anotado(hash, clave, NULL) != NULL;
+}
+
+size_t hash_cuco_cantidad(const hash_cuco_t *hash) {
+	return atomic_load_explicit(&hash->cantidad, memory_order_relaxed);
+}
+
+void hash_cuco_diferir_destruccion(hash_cuco_t *hash, epoca_t *epoca) {
+	hash->epoca = epoca;
+}
+
+void hash_cuco_destruir(hash_cuco_t *hash) {
+	tabla_t* tabla = atomic_load(&hash->tabla);
+	for (size_t i = 0; i <= tabla->mascara; i++) {
+		for (int v = 0; v < VIAS; v++) {
+			entrada_t* entrada = atomic_load_explicit(&tabla->baldes[i].entradas[v], memory_order_relaxed);
+			if (entrada) {
+				descartar_dato(hash, atomic_load_explicit(&entrada->dato, memory_order_relaxed));
+				liberar_entrada(entrada);
+			}
+		}
+	}
+	for (size_t i = 0; i < hash->cantidad_retiradas; i++) {
+		liberar_entrada(hash->retiradas[i]);
+	}
+	liberar_tabla(tabla);
+	pthread_mutex_destroy(&hash->escritura);
+	free(hash);
+}
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL ITERADOR
+ * *****************************************************************/
+
+static const entrada_t* iter_entrada(const hash_cuco_iter_t* iter) {
+	const tabla_t* tabla = atomic_load_explicit(&iter->hash->tabla, memory_order_relaxed);
+	return atomic_load_explicit(&tabla->baldes[iter->balde].entradas[iter->via], memory_order_relaxed);
+}
+
+// Deja el iterador en la primera vía ocupada desde la posición actual.
+static void iter_acomodar(hash_cuco_iter_t* iter) {
+	const tabla_t* tabla = atomic_load_explicit(&iter->hash->tabla, memory_order_relaxed);
+	while (iter->balde <= tabla->mascara && !iter_entrada(iter)) {
+		if (++iter->via == VIAS) {
+			iter->via = 0;
+			iter->balde++;
+		}
+	}
+}
+
+hash_cuco_iter_t *hash_cuco_iter_crear(const hash_cuco_t *hash) {
+	hash_cuco_iter_t* iter = malloc(sizeof(hash_cuco_iter_t));
+	if (!iter) {
+		return NULL;
+	}
+	iter->hash = hash;
+	iter->balde = 0;
+	iter->via = 0;
+	iter_acomodar(iter);
+	return iter;
+}
+
+bool hash_cuco_iter_avanzar(hash_cuco_iter_t *iter) {
+	if (hash_cuco_iter_al_final(iter)) {
+		return false;
+	}
+	if (++iter->via == VIAS) {
+		iter->via = 0;
+		iter->balde++;
+	}
+	iter_acomodar(iter);
+	return true;
+}
+
+const char *hash_cuco_iter_ver_actual(const hash_cuco_iter_t *iter) {
+	if (hash_cuco_iter_al_final(iter)) {
+		return NULL;
+	}
+	return iter_entrada(iter)->clave;
+}
+
+bool hash_cuco_iter_al_final(const hash_cuco_iter_t *iter) {
+	const tabla_t* tabla = atomic_load_explicit(&iter->hash->tabla, memory_order_relaxed);
+	return iter->balde > tabla->mascara;
+}
+
+void hash_cuco_iter_destruir(hash_cuco_iter_t *iter) {
+	free(iter);
+}
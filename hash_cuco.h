@@ -0,0 +1,99 @@
+#ifndef HASH_CUCO_H
+#define HASH_CUCO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "hash.h"
+
+/* Diccionario con hashing cuco por baldes: cada clave puede estar sólo en
+ * dos baldes de 4 entradas, y cada balde ocupa una línea de cache. Buscar
+ * lee como mucho esas dos líneas (más la entrada cuya etiqueta coincide),
+ * así que el peor caso está acotado sin importar cómo caigan las claves.
+ * Al insertar en dos baldes llenos se busca a lo ancho (BFS) el camino más
+ * corto de desplazamientos que libera un lugar.
+ *
+ * hash_cuco_obtener y hash_cuco_pertenece pueden llamarse desde cualquier
+ * hilo mientras otro modifica el hash: leen los baldes de forma optimista
+ * con un contador de versión por balde y reintentan si cambió en el medio.
+ * Las modificaciones se serializan entre sí. El iterador no admite
+ * modificaciones concurrentes.
+ */
+
+struct hash_cuco;
+struct hash_cuco_iter;
+struct epoca;
+
+typedef struct hash_cuco hash_cuco_t;
+typedef struct hash_cuco_iter hash_cuco_iter_t;
+
+/* Crea el hash
+ */
+hash_cuco_t *hash_cuco_crear(hash_destruir_dato_t destruir_dato);
+
+/* Guarda un elemento en el hash, si la clave ya se encuentra en la
+ * estructura, la reemplaza y destruye el dato anterior. De no poder
+ * guardarlo devuelve false; pasa también si ya hay 8 claves con el mismo
+ * hash_funcion, que llenan los dos baldes posibles en cualquier tamaño.
+ * Pre: el hash fue creado.
+ * Post: Se almacenó el par (clave, dato)
+ */
+bool hash_cuco_guardar(hash_cuco_t *hash, const char *clave, void *dato);
+
+/* Borra un elemento del hash y devuelve el dato asociado. Devuelve NULL si
+ * la clave no estaba. Un lector concurrente puede haber obtenido el dato
+ * justo antes de que se borrara.
+ * Pre: el hash fue creado.
+ */
+void *hash_cuco_borrar(hash_cuco_t *hash, const char *clave);
+
+/* Obtiene el valor de un elemento del hash, si la clave no se encuentra
+ * devuelve NULL. Puede usarse en paralelo con las modificaciones.
+ * Pre: el hash fue creado.
+ */
+void *hash_cuco_obtener(const hash_cuco_t *hash, const char *clave);
+
+/* Determina si clave pertenece o no al hash. Puede usarse en paralelo con
+ * las modificaciones.
+ * Pre: el hash fue creado.
+ */
+bool hash_cuco_pertenece(const hash_cuco_t *hash, const char *clave);
+
+/* Devuelve la cantidad de elementos del hash.
+ * Pre: el hash fue creado.
+ */
+size_t hash_cuco_cantidad(const hash_cuco_t *hash);
+
+/* Hace que los datos reemplazados por hash_cuco_guardar y los que quedan
+ * en hash_cuco_destruir se retiren en epoca (ver epoca.h) en lugar de
+ * destruirse en el momento. Un lector que encierra entre epoca_entrar y
+ * epoca_salir el hash_cuco_obtener y el uso del dato no ve destruirse el
+ * dato mientras lo usa, aunque otro hilo lo reemplace. Con NULL vuelve a
+ * destruirlos en el momento.
+ * Pre: el hash fue creado y ningún hilo lo está modificando.
+ */
+void hash_cuco_diferir_destruccion(hash_cuco_t *hash, struct epoca *epoca);
+
+/* Destruye la estructura liberando la memoria pedida y llamando a la función
+ * destruir para cada par (clave, dato).
+ * Pre: el hash fue creado y ningún hilo lo está usando.
+ */
+void hash_cuco_destruir(hash_cuco_t *hash);
+
+/* Iterador del hash */
+
+// Crea iterador
+hash_cuco_iter_t *hash_cuco_iter_crear(const hash_cuco_t *hash);
+
+// Avanza iterador
+bool hash_cuco_iter_avanzar(hash_cuco_iter_t *iter);
+
+// Devuelve clave actual, esa clave no se puede modificar ni liberar.
+const char *hash_cuco_iter_ver_actual(const hash_cuco_iter_t *iter);
+
+// Comprueba si terminó la iteración
+bool hash_cuco_iter_al_final(const hash_cuco_iter_t *iter);
+
+// Destruye iterador
+void hash_cuco_iter_destruir(hash_cuco_iter_t *iter);
+
+#endif // HASH_CUCO_H
@@ -0,0 +1,667 @@
+#define _POSIX_C_SOURCE 200809L
+#include "hash_durable.h"
+#include "hash.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Un lote se confirma solo al llegar a este tamaño
+#define TAM_LOTE (1 << 20)
+
+#define REGISTRO_GUARDAR 'G'
+#define REGISTRO_BORRAR 'B'
+#define REGISTRO_FIN 'F'
+// tipo (1 byte), largo de la clave y largo del valor (4 bytes cada uno)
+#define TAM_CABECERA 9
+#define TAM_SUMA 4
+
+#define MAGIA_INSTANTANEA "HDURINST"
+#define TAM_MAGIA 8
+#define VERSION_FORMATO 1
+#define TAM_ENCABEZADO_INSTANTANEA (TAM_MAGIA + 4 + 8)
+
+#define NOMBRE_INSTANTANEA "instantanea"
+#define NOMBRE_TEMPORAL "instantanea.tmp"
+#define NOMBRE_SEGMENTO "log.%llu"
+
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+typedef struct valor {
+	size_t largo;
+	char bytes[];
+} valor_t;
+
+// Lo que necesita el hilo compactador; no comparte nada más con el hash
+typedef struct compactacion {
+	char* ruta;
+	unsigned long long hasta; // último segmento cerrado a incluir
+	bool ok;
+} compactacion_t;
+
+struct hash_durable {
+	hash_t* tabla;
+	char* ruta;
+	int log;                     // segmento activo, abierto para agregar
+	unsigned long long segmento; // número del segmento activo
+	off_t largo_log;             // bytes ya confirmados del segmento activo
+	char* lote;
+	size_t usado;
+	size_t capacidad;
+	compactacion_t* compactacion; // NULL si no hay una en curso
+	pthread_t compactador;
+	bool ultima_compactacion_ok;
+};
+
+typedef struct registro {
+	char tipo;
+	const char* clave;
+	const void* valor;
+	size_t largo_valor;
+} registro_t;
+
+typedef enum lectura {
+	LEIDO,
+	FIN_ARCHIVO, // terminó justo en el límite de un registro
+	CORTADO,     // registro incompleto o con suma inválida
+	ERROR_LECTURA,
+} lectura_t;
+
+
+/* ******************************************************************
+ *                    FORMATO DE LOS REGISTROS
+ * *****************************************************************/
+
+// Los enteros se guardan en little endian, sin depender de la máquina
+static void escribir_u32(unsigned char* destino, uint32_t valor) {
+	for (size_t i = 0; i < 4; i++) {
+		destino[i] = (unsigned char)(valor >> (8 * i));
+	}
+}
+
+static uint32_t leer_u32(const unsigned char* origen) {
+	uint32_t valor = 0;
+	for (size_t i = 0; i < 4; i++) {
+		valor |= (uint32_t)origen[i] << (8 * i);
+	}
+	return valor;
+}
+
+static void escribir_u64(unsigned char* destino, uint64_t valor) {
+	escribir_u32(destino, (uint32_t)valor);
+	escribir_u32(destino + 4, (uint32_t)(valor >> 32));
+}
+
+static uint64_t leer_u64(const unsigned char* origen) {
+	return leer_u32(origen) | (uint64_t)leer_u32(origen + 4) << 32;
+}
+
+// FNV-1a, alcanza para detectar registros cortados o pisados
+static uint32_t suma_control(uint32_t suma, const void* datos, size_t largo) {
+	const unsigned char* bytes = datos;
+	for (size_t i = 0; i < largo; i++) {
+		suma ^= bytes[i];
+		suma *= 16777619u;
+	}
+	return suma;
+}
+
+#define SUMA_INICIAL 2166136261u
+
+static size_t largo_registro(const registro_t* registro) {
+	return TAM_CABECERA + strlen(registro->clave) + registro->largo_valor + TAM_SUMA;
+}
+
+// Serializa el registro en destino, que tiene lugar para largo_registro bytes
+static void codificar_registro(unsigned char* destino, const registro_t* registro) {
+	size_t largo_clave = strlen(registro->clave);
+	destino[0] = (unsigned char)registro->tipo;
+	escribir_u32(destino + 1, (uint32_t)largo_clave);
+	escribir_u32(destino + 5, (uint32_t)registro->largo_valor);
+	memcpy(destino + TAM_CABECERA, registro->clave, largo_clave);
+	if (registro->largo_valor) {
+		memcpy(destino + TAM_CABECERA + largo_clave, registro->valor, registro->largo_valor);
+	}
+	size_t largo = TAM_CABECERA + largo_clave + registro->largo_valor;
+	escribir_u32(destino + largo, suma_control(SUMA_INICIAL, destino, largo));
+}
+
+/* Lee el próximo registro de archivo. La clave y el valor quedan en buffer,
+ * que crece si hace falta, y valen hasta la próxima lectura.
+ */
+static lectura_t leer_registro(FILE* archivo, registro_t* registro, unsigned char** buffer, size_t* capacidad) {
+	unsigned char cabecera[TAM_CABECERA];
+	size_t leidos = fread(cabecera, 1, TAM_CABECERA, archivo);
+	if (leidos == 0) {
+		return ferror(archivo) ? ERROR_LECTURA : FIN_ARCHIVO;
+	}
+	if (leidos < TAM_CABECERA) {
+		return ferror(archivo) ? ERROR_LECTURA : CORTADO;
+	}
+	size_t largo_clave = leer_u32(cabecera + 1);
+	size_t largo_valor = leer_u32(cabecera + 5);
+	// la clave se termina con '\0' en el buffer, detrás va el valor y la suma
+	size_t necesario = largo_clave + 1 + largo_valor + TAM_SUMA;
+	if (necesario > *capacidad) {
+		unsigned char* nuevo = realloc(*buffer, necesario);
+		if (!nuevo) {
+			return ERROR_LECTURA;
+		}
+		*buffer = nuevo;
+		*capacidad = necesario;
+	}
+	unsigned char* clave = *buffer;
+	unsigned char* valor = clave + largo_clave + 1;
+	if (fread(clave, 1, largo_clave, archivo) < largo_clave
+			|| fread(valor, 1, largo_valor + TAM_SUMA, archivo) < largo_valor + TAM_SUMA) {
+		return ferror(archivo) ? ERROR_LECTURA : CORTADO;
+	}
+	uint32_t suma = suma_control(SUMA_INICIAL, cabecera, TAM_CABECERA);
+	suma = suma_control(suma, clave, largo_clave);
+	suma = suma_control(suma, valor, largo_valor);
+	if (suma != leer_u32(valor + largo_valor) || memchr(clave, '\0', largo_clave)) {
+		return CORTADO;
+	}
+	clave[largo_clave] = '\0';
+	registro->tipo = (char)cabecera[0];
+	registro->clave = (const char*)clave;
+	registro->valor = valor;
+	registro->largo_valor = largo_valor;
+	return LEIDO;
+}
+
+
+/* ******************************************************************
+ *                    APLICAR REGISTROS A LA TABLA
+ * *****************************************************************/
+
+static valor_t* valor_crear(const void* bytes, size_t largo) {
+	valor_t* valor = malloc(sizeof(valor_t) + largo);
+	if (!valor) {
+		return NULL;
+	}
+	valor->largo = largo;
+	if (largo) {
+		memcpy(valor->bytes, bytes, largo);
+	}
+	return valor;
+}
+
+static bool aplicar_registro(hash_t* tabla, const registro_t* registro) {
+	if (registro->tipo == REGISTRO_BORRAR) {
+		free(hash_borrar(tabla, registro->clave));
+		return true;
+	}
+	valor_t* valor = valor_crear(registro->valor, registro->largo_valor);
+	if (!valor || !hash_guardar(tabla, registro->clave, valor)) {
+		free(valor);
+		return false;
+	}
+	return true;
+}
+
+static bool tipo_valido_en_log(char tipo) {
+	return tipo == REGISTRO_GUARDAR || tipo == REGISTRO_BORRAR;
+}
+
+
+/* ******************************************************************
+ *                    ARCHIVOS
+ * *****************************************************************/
+
+static char* ruta_segmento(const char* directorio, unsigned long long segmento) {
+	size_t largo = strlen(directorio) + 32;
+	char* ruta = malloc(largo);
+	if (ruta) {
+		int escrito = snprintf(ruta, largo, "%s/", directorio);
+		snprintf(ruta + escrito, largo - (size_t)escrito, NOMBRE_SEGMENTO, segmento);
+	}
+	return ruta;
+}
+
+static char* ruta_archivo(const char* directorio, const char* nombre) {
+	size_t largo = strlen(directorio) + strlen(nombre) + 2;
+	char* ruta = malloc(largo);
+	if (ruta) {
+		snprintf(ruta, largo, "%s/%s", directorio, nombre);
+	}
+	return ruta;
+}
+
+// Sincroniza el directorio, para que las altas, bajas y renombres sobrevivan
+static bool sincronizar_directorio(const char* directorio) {
+	int fd = open(directorio, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	bool ok = fsync(fd) == 0;
+	close(fd);
+	return ok;
+}
+
+/* Reproduce un segmento del log sobre la tabla. En largo queda hasta dónde
+ * era válido y en completo si no había un registro cortado al final.
+ * Devuelve false si no existe o no pudo leerse (errno dice cuál).
+ */
+static bool reproducir_segmento(const char* ruta, hash_t* tabla, off_t* largo, bool* completo) {
+	FILE* archivo = fopen(ruta, "rb");
+	if (!archivo) {
+		return false;
+	}
+	unsigned char* buffer = NULL;
+	size_t capacidad = 0;
+	registro_t registro;
+	lectura_t lectura;
+	bool ok = true;
+	*largo = 0;
+	while ((lectura = leer_registro(archivo, &registro, &buffer, &capacidad)) == LEIDO) {
+		if (!tipo_valido_en_log(registro.tipo)) {
+			lectura = CORTADO;
+			break;
+		}
+		if (!aplicar_registro(tabla, &registro)) {
+			errno = ENOMEM;
+			ok = false;
+			break;
+		}
+		*largo += (off_t)largo_registro(&registro);
+	}
+	if (lectura == ERROR_LECTURA) {
+		errno = EIO;
+		ok = false;
+	}
+	*completo = lectura != CORTADO;
+	free(buffer);
+	fclose(archivo);
+	return ok;
+}
+
+/* Carga la instantánea del directorio en la tabla y deja en base el primer
+ * segmento que no incluye. Sin instantánea la base es 0.
+ */
+static bool leer_instantanea(const char* directorio, hash_t* tabla, unsigned long long* base) {
+	*base = 0;
+	char* ruta = ruta_archivo(directorio, NOMBRE_INSTANTANEA);
+	if (!ruta) {
+		return false;
+	}
+	FILE* archivo = fopen(ruta, "rb");
+	free(ruta);
+	if (!archivo) {
+		return errno == ENOENT;
+	}
+	unsigned char encabezado[TAM_ENCABEZADO_INSTANTANEA];
+	bool ok = fread(encabezado, 1, sizeof(encabezado), archivo) == sizeof(encabezado)
+		&& memcmp(encabezado, MAGIA_INSTANTANEA, TAM_MAGIA) == 0
+		&& leer_u32(encabezado + TAM_MAGIA) == VERSION_FORMATO;
+	if (ok) {
+		*base = leer_u64(encabezado + TAM_MAGIA + 4);
+	}
+	unsigned char* buffer = NULL;
+	size_t capacidad = 0;
+	registro_t registro;
+	lectura_t lectura = LEIDO;
+	while (ok && (lectura = leer_registro(archivo, &registro, &buffer, &capacidad)) == LEIDO) {
+		if (registro.tipo == REGISTRO_FIN) {
+			break;
+		}
+		ok = registro.tipo == REGISTRO_GUARDAR && aplicar_registro(tabla, &registro);
+	}
+	// una instantánea sin registro de fin está incompleta
+	ok = ok && lectura == LEIDO;
+	free(buffer);
+	fclose(archivo);
+	return ok;
+}
+
+static bool escribir_registro(FILE* archivo, const registro_t* registro, unsigned char** buffer, size_t* capacidad) {
+	size_t largo = largo_registro(registro);
+	if (largo > *capacidad) {
+		unsigned char* nuevo = realloc(*buffer, largo);
+		if (!nuevo) {
+			return false;
+		}
+		*buffer = nuevo;
+		*capacidad = largo;
+	}
+	codificar_registro(*buffer, registro);
+	return fwrite(*buffer, 1, largo, archivo) == largo;
+}
+
+/* Escribe la tabla como instantánea con la base dada. Se escribe a un
+ * temporal y se renombra, así una caída deja la instantánea anterior.
+ */
+static bool escribir_instantanea(const char* directorio, const hash_t* tabla, unsigned long long base) {
+	char* temporal = ruta_archivo(directorio, NOMBRE_TEMPORAL);
+	char* definitiva = ruta_archivo(directorio, NOMBRE_INSTANTANEA);
+	FILE* archivo = temporal && definitiva ? fopen(temporal, "wb") : NULL;
+	hash_iter_t* iter = archivo ? hash_iter_crear(tabla) : NULL;
+	bool ok = iter != NULL;
+
+	unsigned char encabezado[TAM_ENCABEZADO_INSTANTANEA];
+	memcpy(encabezado, MAGIA_INSTANTANEA, TAM_MAGIA);
+	escribir_u32(encabezado + TAM_MAGIA, VERSION_FORMATO);
+	escribir_u64(encabezado + TAM_MAGIA + 4, base);
+	ok = ok && fwrite(encabezado, 1, sizeof(encabezado), archivo) == sizeof(encabezado);
+
+	unsigned char* buffer = NULL;
+	size_t capacidad = 0;
+	for (; ok && !hash_iter_al_final(iter); hash_iter_avanzar(iter)) {
+		const char* clave = hash_iter_ver_actual(iter);
+		const valor_t* valor = hash_obtener(tabla, clave);
+		registro_t registro = {REGISTRO_GUARDAR, clave, valor->bytes, valor->largo};
+		ok = escribir_registro(archivo, &registro, &buffer, &capacidad);
+	}
+	registro_t fin = {REGISTRO_FIN, "", NULL, 0};
+	ok = ok && escribir_registro(archivo, &fin, &buffer, &capacidad);
+	ok = ok && fflush(archivo) == 0 && fsync(fileno(archivo)) == 0;
+	free(buffer);
+	if (iter) {
+		hash_iter_destruir(iter);
+	}
+	if (archivo) {
+		ok = fclose(archivo) == 0 && ok;
+		if (!ok) {
+			unlink(temporal);
+		}
+	}
+	ok = ok && rename(temporal, definitiva) == 0 && sincronizar_directorio(directorio);
+	free(temporal);
+	free(definitiva);
+	return ok;
+}
+
+// Borra los segmentos anteriores a base que haya dejado una compactación cortada
+static void borrar_segmentos_viejos(const char* directorio, unsigned long long base) {
+	while (base-- > 0) {
+		char* ruta = ruta_segmento(directorio, base);
+		bool borrado = ruta && unlink(ruta) == 0;
+		free(ruta);
+		if (!borrado) {
+			return;
+		}
+	}
+}
+
+
+/* ******************************************************************
+ *                    COMPACTACION
+ * *****************************************************************/
+
+/* Rearma la tabla hasta el último segmento cerrado a partir de los archivos
+ * (no toca la tabla en uso), la escribe como instantánea y borra los
+ * segmentos que quedaron incluidos.
+ */
+static void* compactar(void* extra) {
+	compactacion_t* compactacion = extra;
+	hash_t* tabla = hash_crear(free);
+	unsigned long long base;
+	bool ok = tabla && leer_instantanea(compactacion->ruta, tabla, &base);
+	for (unsigned long long segmento = base; ok && segmento <= compactacion->hasta; segmento++) {
+		char* ruta = ruta_segmento(compactacion->ruta, segmento);
+		off_t largo;
+		bool completo;
+		ok = ruta && reproducir_segmento(ruta, tabla, &largo, &completo) && completo;
+		free(ruta);
+	}
+	ok = ok && escribir_instantanea(compactacion->ruta, tabla, compactacion->hasta + 1);
+	if (ok) {
+		borrar_segmentos_viejos(compactacion->ruta, compactacion->hasta + 1);
+	}
+	if (tabla) {
+		hash_destruir(tabla);
+	}
+	compactacion->ok = ok;
+	return NULL;
+}
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL HASH DURABLE
+ * *****************************************************************/
+
+static bool abrir_segmento(hash_durable_t* hash, unsigned long long segmento, off_t largo) {
+	char* ruta = ruta_segmento(hash->ruta, segmento);
+	if (!ruta) {
+		return false;
+	}
+	int fd = open(ruta, O_WRONLY | O_CREAT, 0644);
+	free(ruta);
+	if (fd < 0) {
+		return false;
+	}
+	// se descarta lo que haya después del último registro válido
+	if (ftruncate(fd, largo) != 0 || lseek(fd, largo, SEEK_SET) < 0 || !sincronizar_directorio(hash->ruta)) {
+		close(fd);
+		return false;
+	}
+	hash->log = fd;
+	hash->segmento = segmento;
+	hash->largo_log = largo;
+	return true;
+}
+
+// Reconstruye la tabla con la instantánea y los segmentos, y abre el último
+static bool recuperar(hash_durable_t* hash) {
+	unsigned long long base;
+	if (!leer_instantanea(hash->ruta, hash->tabla, &base)) {
+		return false;
+	}
+	borrar_segmentos_viejos(hash->ruta, base);
+
+	unsigned long long ultimo = base;
+	off_t largo_ultimo = 0;
+	bool ultimo_completo = true;
+	for (unsigned long long segmento = base; ; segmento++) {
+		char* ruta = ruta_segmento(hash->ruta, segmento);
+		if (!ruta) {
+			return false;
+		}
+		off_t largo;
+		bool completo;
+		bool leido = reproducir_segmento(ruta, hash->tabla, &largo, &completo);
+		free(ruta);
+		if (!leido) {
+			if (errno != ENOENT) {
+				return false;
+			}
+			break;
+		}
+		// sólo el último segmento puede terminar en un registro cortado
+		if (!ultimo_completo) {
+			return false;
+		}
+		ultimo = segmento;
+		largo_ultimo = largo;
+		ultimo_completo = completo;
+	}
+	return abrir_segmento(hash, ultimo, largo_ultimo);
+}
+
+static void liberar(hash_durable_t* hash) {
+	if (hash->tabla) {
+		hash_destruir(hash->tabla);
+	}
+	free(hash->ruta);
+	free(hash->lote);
+	free(hash);
+}
+
+hash_durable_t *hash_durable_abrir(const char *ruta) {
+	if (mkdir(ruta, 0755) != 0 && errno != EEXIST) {
+		return NULL;
+	}
+	hash_durable_t* hash = malloc(sizeof(hash_durable_t));
+	if (!hash) {
+		return NULL;
+	}
+	hash->tabla = hash_crear(free);
+	hash->ruta = malloc(strlen(ruta) + 1);
+	hash->lote = malloc(TAM_LOTE);
+	if (!hash->tabla || !hash->ruta || !hash->lote) {
+		liberar(hash);
+		return NULL;
+	}
+	strcpy(hash->ruta, ruta);
+	hash->usado = 0;
+	hash->capacidad = TAM_LOTE;
+	hash->compactacion = NULL;
+	hash->ultima_compactacion_ok = true;
+	if (!recuperar(hash)) {
+		liberar(hash);
+		return NULL;
+	}
+	return hash;
+}
+
+// Agrega el registro al lote en memoria
+static bool anotar(hash_durable_t* hash, const registro_t* registro) {
+	size_t largo = largo_registro(registro);
+	if (hash->usado + largo > hash->capacidad) {
+		size_t capacidad = hash->capacidad;
+		while (hash->usado + largo > capacidad) {
+			capacidad *= 2;
+		}
+		char* lote = realloc(hash->lote, capacidad);
+		if (!lote) {
+			return false;
+		}
+		hash->lote = lote;
+		hash->capacidad = capacidad;
+	}
+	codificar_registro((unsigned char*)hash->lote + hash->usado, registro);
+	hash->usado += largo;
+	return true;
+}
+
+// Anota el registro y lo aplica a la tabla; si el lote se llenó lo confirma
+static bool registrar(hash_durable_t* hash, const registro_t* registro) {
+	size_t usado = hash->usado;
+	if (!anotar(hash, registro)) {
+		return false;
+	}
+	if (!aplicar_registro(hash->tabla, registro)) {
+		hash->usado = usado;
+		return false;
+	}
+	return hash->usado < TAM_LOTE || hash_durable_confirmar(hash);
+}
+
+bool hash_durable_guardar(hash_durable_t *hash, const char *clave, const void *valor, size_t largo) {
+	registro_t registro = {REGISTRO_GUARDAR, clave, valor, largo};
+	return registrar(hash, &registro);
+}
+
+bool hash_durable_borrar(hash_durable_t *hash, const char *clave) {
+	if (!hash_pertenece(hash->tabla, clave)) {
+		return false;
+	}
+	registro_t registro = {REGISTRO_BORRAR, clave, NULL, 0};
+	return registrar(hash, &registro);
+}
+
+const void *hash_durable_obtener(const hash_durable_t *hash, const char *clave, size_t *largo) {
+	const valor_t* valor = hash_obtener(hash->tabla, clave);
+	if (!valor) {
+		return NULL;
+	}
+	if (largo) {
+		*largo = valor->largo;
+	}
+	return valor->bytes;
+}
+
+bool hash_durable_pertenece(const hash_durable_t *hash, const char *clave) {
+	return hash_pertenece(hash->tabla, clave);
+}
+
+size_t hash_durable_cantidad(const hash_durable_t *hash) {
+	return hash_cantidad(hash->tabla);
+}
+
+bool hash_durable_confirmar(hash_durable_t *hash) {
+	size_t escrito = 0;
+	while (escrito < hash->usado) {
+		ssize_t n = write(hash->log, hash->lote + escrito, hash->usado - escrito);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			break;
+		}
+		escrito += (size_t)n;
+	}
+	if (escrito < hash->usado || fdatasync(hash->log) != 0) {
+		// se vuelve al último lote confirmado para reintentar entero
+		if (ftruncate(hash->log, hash->largo_log) == 0) {
+			lseek(hash->log, hash->largo_log, SEEK_SET);
+		}
+		return false;
+	}
+	hash->largo_log += (off_t)escrito;
+	hash->usado = 0;
+	return true;
+}
+
+bool hash_durable_esperar_compactacion(hash_durable_t *hash) {
+	if (hash->compactacion) {
+		pthread_join(hash->compactador, NULL);
+		hash->ultima_compactacion_ok = hash->compactacion->ok;
+		free(hash->compactacion->ruta);
+		free(hash->compactacion);
+		hash->compactacion = NULL;
+	}
+	return hash->ultima_compactacion_ok;
+}
+
+bool hash_durable_compactar(hash_durable_t *hash) {
+	hash_durable_esperar_compactacion(hash);
+	if (!hash_durable_confirmar(hash)) {
+		return false;
+	}
+	compactacion_t* compactacion = malloc(sizeof(compactacion_t));
+	char* ruta = malloc(strlen(hash->ruta) + 1);
+	if (!compactacion || !ruta) {
+		free(compactacion);
+		free(ruta);
+		return false;
+	}
+	strcpy(ruta, hash->ruta);
+	compactacion->ruta = ruta;
+	compactacion->hasta = hash->segmento;
+	compactacion->ok = false;
+
+	// el segmento actual queda cerrado; lo que sigue va al próximo
+	int anterior = hash->log;
+	if (!abrir_segmento(hash, hash->segmento + 1, 0)) {
+		free(ruta);
+		free(compactacion);
+		return false;
+	}
+	close(anterior);
+	if (pthread_create(&hash->compactador, NULL, compactar, compactacion) != 0) {
+		// los segmentos quedan como están; se compactarán la próxima vez
+		free(ruta);
+		free(compactacion);
+		return false;
+	}
+	hash->compactacion = compactacion;
+	return true;
+}
+
+bool hash_durable_cerrar(hash_durable_t *hash) {
+	bool ok = hash_durable_confirmar(hash);
+	hash_durable_esperar_compactacion(hash);
+	close(hash->log);
+	liberar(hash);
+	return ok;
+}
@@ -0,0 +1,87 @@
+#ifndef HASH_DURABLE_H
+#define HASH_DURABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Hash persistente en disco. Cada hash_durable_guardar y hash_durable_borrar
+ * agrega un registro binario a un log de escritura anticipada (WAL) que se
+ * escribe por lotes: los registros se juntan en memoria y un solo write +
+ * fdatasync confirma todo el lote (group commit). Una operación es durable
+ * cuando retorna el hash_durable_confirmar siguiente, o cuando el lote se
+ * llena y se confirma solo.
+ *
+ * Al abrir, la tabla se reconstruye leyendo la última instantánea y
+ * reproduciendo los segmentos del log posteriores. Un registro cortado al
+ * final del log (caída en medio de una escritura) se descarta.
+ *
+ * Los archivos viven en el directorio ruta:
+ *   instantanea   todos los pares hasta cierto segmento del log
+ *   log.<n>       segmentos del log, se reproducen en orden
+ *
+ * Los valores son bytes que el hash copia. No admite uso concurrente.
+ */
+
+struct hash_durable;
+typedef struct hash_durable hash_durable_t;
+
+/* Abre (o crea, si no existe) el hash guardado en el directorio ruta.
+ * Post: devuelve el hash con el contenido recuperado, o NULL si no pudo
+ * leerse o hay un segmento del log dañado antes del último.
+ */
+hash_durable_t *hash_durable_abrir(const char *ruta);
+
+/* Guarda una copia de los largo bytes de valor bajo clave, reemplazando el
+ * valor anterior si lo había. Devuelve false si no hubo memoria o si falló
+ * la confirmación del lote, en cuyo caso el registro queda pendiente.
+ * Pre: el hash fue abierto.
+ */
+bool hash_durable_guardar(hash_durable_t *hash, const char *clave, const void *valor, size_t largo);
+
+/* Borra la clave. Devuelve false si no estaba o si no pudo registrarse.
+ * Pre: el hash fue abierto.
+ */
+bool hash_durable_borrar(hash_durable_t *hash, const char *clave);
+
+/* Devuelve el valor guardado bajo clave y deja su largo en largo (si no es
+ * NULL), o NULL si la clave no está. El puntero vale hasta la próxima
+ * modificación de esa clave.
+ * Pre: el hash fue abierto.
+ */
+const void *hash_durable_obtener(const hash_durable_t *hash, const char *clave, size_t *largo);
+
+// Determina si clave pertenece o no al hash.
+bool hash_durable_pertenece(const hash_durable_t *hash, const char *clave);
+
+// Devuelve la cantidad de elementos del hash.
+size_t hash_durable_cantidad(const hash_durable_t *hash);
+
+/* Escribe y sincroniza con el disco los registros pendientes.
+ * Devuelve false si falló la escritura; los registros quedan pendientes y
+ * el log queda como estaba antes de intentarlo.
+ * Pre: el hash fue abierto.
+ */
+bool hash_durable_confirmar(hash_durable_t *hash);
+
+/* Cierra el segmento actual del log y lanza un hilo que escribe una nueva
+ * instantánea con los segmentos cerrados y después los borra. Las
+ * operaciones siguen yendo a un segmento nuevo mientras tanto. Si había una
+ * compactación en curso, primero la espera.
+ * Devuelve false si no pudo empezar.
+ * Pre: el hash fue abierto.
+ */
+bool hash_durable_compactar(hash_durable_t *hash);
+
+/* Espera a que termine la compactación en curso, si hay una. Devuelve false
+ * si la última compactación falló (el log sigue siendo válido igual).
+ * Pre: el hash fue abierto.
+ */
+bool hash_durable_esperar_compactacion(hash_durable_t *hash);
+
+/* Confirma lo pendiente, espera la compactación en curso y libera el hash.
+ * Devuelve false si no pudo confirmar los registros pendientes.
+ * Pre: el hash fue abierto.
+ */
+bool hash_durable_cerrar(hash_durable_t *hash);
+
+#endif // HASH_DURABLE_H
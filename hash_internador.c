@@ -0,0 +1,393 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "hash.h"
+#include "hash_internador.h"
+
+#define CAPACIDAD_INICIAL 64 // ranuras, siempre potencia de 2
+#define TEXTOS_INICIALES 64
+#define MAX_OCUPACION_NUM 3
+#define MAX_OCUPACION_DEN 4
+#define TAM_BLOQUE (1 << 20) // de los bloques de texto
+#define MAX_IDS (UINT32_MAX - 1)
+#define TEXTOS_POR_LOTE 16
+#define TAM_LINEA_CACHE 64
+#define BITS_FRAGMENTOS 6
+#define FRAGMENTOS (1 << BITS_FRAGMENTOS)
+#define BITS_TROZO 16 // ids por trozo del directorio concurrente
+#define IDS_POR_TROZO ((size_t)1 << BITS_TROZO)
+#define TROZOS (((size_t)MAX_IDS >> BITS_TROZO) + 1)
+
+#if defined(__GNUC__)
+#define PEDIR_ANTES(direccion) __builtin_prefetch(direccion)
+#else
+#define PEDIR_ANTES(direccion) ((void)(direccion))
+#endif
+
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+// Bloque de textos copiados uno detrás de otro
+typedef struct bloque {
+	struct bloque* anterior;
+	size_t usado;
+	size_t tam;
+	char textos[];
+} bloque_t;
+
+// texto NULL: ranura libre
+typedef struct ranura {
+	const char* texto;
+	uint32_t hash;
+	uint32_t id;
+} ranura_t;
+
+typedef struct tabla {
+	ranura_t* ranuras;
+	size_t capacidad;
+	size_t cantidad;
+} tabla_t;
+
+struct hash_internador {
+	tabla_t tabla;
+	bloque_t* bloques;
+	const char** textos; // por id
+	size_t capacidad_textos;
+};
+
+typedef _Atomic(const char*) texto_atomico_t;
+
+typedef struct fragmento {
+	pthread_mutex_t mutex;
+	tabla_t tabla;
+	bloque_t* bloques;
+	char relleno[TAM_LINEA_CACHE]; // que dos fragmentos no compartan línea de cache
+} fragmento_t;
+
+struct hash_internador_concurrente {
+	fragmento_t fragmentos[FRAGMENTOS];
+	atomic_size_t siguiente_id;
+	// textos por id en trozos de IDS_POR_TROZO que se piden al primer uso
+	_Atomic(texto_atomico_t*)* directorio;
+};
+
+
+/* ******************************************************************
+ *                    FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+/* Copia texto (con su '\0') al bloque actual, o a uno nuevo si no entra.
+ * Devuelve la copia, o NULL si no hubo memoria.
+ */
+static const char* copiar_texto(bloque_t** bloques, const char* texto, size_t largo) {
+	bloque_t* bloque = *bloques;
+	if (!bloque || bloque->tam - bloque->usado < largo) {
+		size_t tam = largo > TAM_BLOQUE ? largo : TAM_BLOQUE;
+		bloque = malloc(sizeof(bloque_t) + tam);
+		if (!bloque) {
+			return NULL;
+		}
+		bloque->anterior = *bloques;
+		bloque->usado = 0;
+		bloque->tam = tam;
+		*bloques = bloque;
+	}
+	char* copia = bloque->textos + bloque->usado;
+	memcpy(copia, texto, largo);
+	bloque->usado += largo;
+	return copia;
+}
+
+static void liberar_bloques(bloque_t* bloque) {
+	while (bloque) {
+		bloque_t* anterior = bloque->anterior;
+		free(bloque);
+		bloque = anterior;
+	}
+}
+
+static bool tabla_crear(tabla_t* tabla) {
+	tabla->ranuras = calloc(CAPACIDAD_INICIAL, sizeof(ranura_t));
+	tabla->capacidad = CAPACIDAD_INICIAL;
+	tabla->cantidad = 0;
+	return tabla->ranuras != NULL;
+}
+
+/* Busca el texto probando ranuras consecutivas desde la suya. Devuelve la
+ * ranura del texto, o la primera libre si no está.
+ */
+static ranura_t* tabla_buscar(const tabla_t* tabla, const char* texto, uint32_t h) {
+	size_t mascara = tabla->capacidad - 1;
+	for (size_t i = h & mascara; ; i = (i + 1) & mascara) {
+		ranura_t* ranura = &tabla->ranuras[i];
+		if (!ranura->texto || (ranura->hash == h && strcmp(ranura->texto, texto) == 0)) {
+			return ranura;
+		}
+	}
+}
+
+// Con el hash guardado en cada ranura, crecer no vuelve a leer los textos
+static bool tabla_crecer(tabla_t* tabla) {
+	size_t capacidad = tabla->capacidad * 2;
+	ranura_t* ranuras = calloc(capacidad, sizeof(ranura_t));
+	if (!ranuras) {
+		return false;
+	}
+	size_t mascara = capacidad - 1;
+	for (size_t r = 0; r < tabla->capacidad; r++) {
+		if (!tabla->ranuras[r].texto) {
+			continue;
+		}
+		size_t i = tabla->ranuras[r].hash & mascara;
+		while (ranuras[i].texto) {
+			i = (i + 1) & mascara;
+		}
+		ranuras[i] = tabla->ranuras[r];
+	}
+	free(tabla->ranuras);
+	tabla->ranuras = ranuras;
+	tabla->capacidad = capacidad;
+	return true;
+}
+
+/* Deja lugar para un texto más y devuelve su ranura libre, o NULL si no
+ * hubo memoria.
+ */
+static ranura_t* tabla_lugar(tabla_t* tabla, ranura_t* libre, const char* texto, uint32_t h) {
+	if ((tabla->cantidad + 1) * MAX_OCUPACION_DEN <= tabla->capacidad * MAX_OCUPACION_NUM) {
+		return libre;
+	}
+	return tabla_crecer(tabla) ? tabla_buscar(tabla, texto, h) : NULL;
+}
+
+static uint32_t hash_de(const char* texto) {
+	return (uint32_t)hash_funcion(texto);
+}
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL INTERNADOR
+ * *****************************************************************/
+
+hash_internador_t *hash_internador_crear(void) {
+	hash_internador_t* internador = malloc(sizeof(hash_internador_t));
+	if (!internador) {
+		return NULL;
+	}
+	internador->textos = malloc(TEXTOS_INICIALES * sizeof(char*));
+	if (!internador->textos || !tabla_crear(&internador->tabla)) {
+		free(internador->textos);
+		free(internador);
+		return NULL;
+	}
+	internador->capacidad_textos = TEXTOS_INICIALES;
+	internador->bloques = NULL;
+	return internador;
+}
+
+static uint32_t id_hasheado(hash_internador_t* internador, const char* texto, uint32_t h) {
+	tabla_t* tabla = &internador->tabla;
+	ranura_t* ranura = tabla_buscar(tabla, texto, h);
+	if (ranura->texto) {
+		return ranura->id;
+	}
+	if (tabla->cantidad == MAX_IDS) {
+		return HASH_INTERNADOR_SIN_ID;
+	}
+	if (tabla->cantidad == internador->capacidad_textos) {
+		const char** textos = realloc(internador->textos, 2 * internador->capacidad_textos * sizeof(char*));
+		if (!textos) {
+			return HASH_INTERNADOR_SIN_ID;
+		}
+		internador->textos = textos;
+		internador->capacidad_textos *= 2;
+	}
+	ranura = tabla_lugar(tabla, ranura, texto, h);
+	const char* copia = ranura ? copiar_texto(&internador->bloques, texto, strlen(texto) + 1) : NULL;
+	if (!copia) {
+		return HASH_INTERNADOR_SIN_ID;
+	}
+	uint32_t id = (uint32_t)tabla->cantidad++;
+	ranura->texto = copia;
+	ranura->hash = h;
+	ranura->id = id;
+	internador->textos[id] = copia;
+	return id;
+}
+
+uint32_t hash_internador_id(hash_internador_t *internador, const char *texto) {
+	return id_hasheado(internador, texto, hash_de(texto));
+}
+
+bool hash_internador_ids(hash_internador_t *internador, const char **textos, size_t cantidad, uint32_t *ids) {
+	uint32_t hashes[TEXTOS_POR_LOTE];
+	for (size_t inicio = 0; inicio < cantidad; inicio += TEXTOS_POR_LOTE) {
+		size_t tanda = cantidad - inicio < TEXTOS_POR_LOTE ? cantidad - inicio : TEXTOS_POR_LOTE;
+		// si la tabla crece en medio de la tanda sólo se pierde el aviso
+		size_t mascara = internador->tabla.capacidad - 1;
+		for (size_t i = 0; i < tanda; i++) {
+			hashes[i] = hash_de(textos[inicio + i]);
+			PEDIR_ANTES(&internador->tabla.ranuras[hashes[i] & mascara]);
+		}
+		for (size_t i = 0; i < tanda; i++) {
+			ids[inicio + i] = id_hasheado(internador, textos[inicio + i], hashes[i]);
+			if (ids[inicio + i] == HASH_INTERNADOR_SIN_ID) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+uint32_t hash_internador_buscar(const hash_internador_t *internador, const char *texto) {
+	const ranura_t* ranura = tabla_buscar(&internador->tabla, texto, hash_de(texto));
+	return ranura->texto ? ranura->id : HASH_INTERNADOR_SIN_ID;
+}
+
+const char *hash_internador_texto(const hash_internador_t *internador, uint32_t id) {
+	return id < internador->tabla.cantidad ? internador->textos[id] : NULL;
+}
+
+size_t hash_internador_cantidad(const hash_internador_t *internador) {
+	return internador->tabla.cantidad;
+}
+
+void hash_internador_destruir(hash_internador_t *internador) {
+	liberar_bloques(internador->bloques);
+	free(internador->tabla.ranuras);
+	free(internador->textos);
+	free(internador);
+}
+
+
+/* ******************************************************************
+ *                    INTERNADOR CONCURRENTE
+ * *****************************************************************/
+
+hash_internador_concurrente_t *hash_internador_concurrente_crear(void) {
+	hash_internador_concurrente_t* internador = malloc(sizeof(hash_internador_concurrente_t));
+	if (!internador) {
+		return NULL;
+	}
+	internador->directorio = malloc(TROZOS * sizeof(*internador->directorio));
+	size_t creados = 0;
+	while (internador->directorio && creados < FRAGMENTOS && tabla_crear(&internador->fragmentos[creados].tabla)) {
+		creados++;
+	}
+	if (creados < FRAGMENTOS) {
+		for (size_t i = 0; i < creados; i++) {
+			free(internador->fragmentos[i].tabla.ranuras);
+		}
+		free(internador->directorio);
+		free(internador);
+		return NULL;
+	}
+	for (size_t i = 0; i < TROZOS; i++) {
+		atomic_init(&internador->directorio[i], NULL);
+	}
+	for (size_t i = 0; i < FRAGMENTOS; i++) {
+		pthread_mutex_init(&internador->fragmentos[i].mutex, NULL);
+		internador->fragmentos[i].bloques = NULL;
+	}
+	atomic_init(&internador->siguiente_id, 0);
+	return internador;
+}
+
+// Los bits altos eligen el fragmento; los bajos, la ranura dentro de él
+static fragmento_t* fragmento_de(hash_internador_concurrente_t* internador, uint32_t h) {
+	return &internador->fragmentos[h >> (32 - BITS_FRAGMENTOS)];
+}
+
+/* Devuelve el trozo del directorio donde va el id, pidiéndolo si todavía
+ * no existe. Si dos hilos lo piden a la vez, gana uno y el otro libera el
+ * suyo.
+ */
+static texto_atomico_t* trozo_de(hash_internador_concurrente_t* internador, size_t id) {
+	_Atomic(texto_atomico_t*)* lugar = &internador->directorio[id >> BITS_TROZO];
+	texto_atomico_t* trozo = atomic_load_explicit(lugar, memory_order_acquire);
+	if (trozo) {
+		return trozo;
+	}
+	texto_atomico_t* nuevo = malloc(IDS_POR_TROZO * sizeof(texto_atomico_t));
+	if (!nuevo) {
+		return NULL;
+	}
+	for (size_t i = 0; i < IDS_POR_TROZO; i++) {
+		atomic_init(&nuevo[i], NULL);
+	}
+	if (!atomic_compare_exchange_strong_explicit(lugar, &trozo, nuevo, memory_order_acq_rel, memory_order_acquire)) {
+		free(nuevo);
+		return trozo;
+	}
+	return nuevo;
+}
+
+uint32_t hash_internador_concurrente_id(hash_internador_concurrente_t *internador, const char *texto) {
+	uint32_t h = hash_de(texto);
+	fragmento_t* fragmento = fragmento_de(internador, h);
+	pthread_mutex_lock(&fragmento->mutex);
+	ranura_t* ranura = tabla_buscar(&fragmento->tabla, texto, h);
+	if (ranura->texto) {
+		uint32_t id = ranura->id;
+		pthread_mutex_unlock(&fragmento->mutex);
+		return id;
+	}
+	// lo que puede fallar dentro del fragmento se hace antes de gastar un id
+	ranura = tabla_lugar(&fragmento->tabla, ranura, texto, h);
+	const char* copia = ranura ? copiar_texto(&fragmento->bloques, texto, strlen(texto) + 1) : NULL;
+	size_t id = copia ? atomic_fetch_add(&internador->siguiente_id, 1) : MAX_IDS;
+	texto_atomico_t* trozo = id < MAX_IDS ? trozo_de(internador, id) : NULL;
+	if (!trozo) {
+		// la copia queda en el bloque sin usar
+		pthread_mutex_unlock(&fragmento->mutex);
+		return HASH_INTERNADOR_SIN_ID;
+	}
+	atomic_store_explicit(&trozo[id & (IDS_POR_TROZO - 1)], copia, memory_order_release);
+	ranura->texto = copia;
+	ranura->hash = h;
+	ranura->id = (uint32_t)id;
+	fragmento->tabla.cantidad++;
+	pthread_mutex_unlock(&fragmento->mutex);
+	return (uint32_t)id;
+}
+
+uint32_t hash_internador_concurrente_buscar(hash_internador_concurrente_t *internador, const char *texto) {
+	uint32_t h = hash_de(texto);
+	fragmento_t* fragmento = fragmento_de(internador, h);
+	pthread_mutex_lock(&fragmento->mutex);
+	const ranura_t* ranura = tabla_buscar(&fragmento->tabla, texto, h);
+	uint32_t id = ranura->texto ? ranura->id : HASH_INTERNADOR_SIN_ID;
+	pthread_mutex_unlock(&fragmento->mutex);
+	return id;
+}
+
+const char *hash_internador_concurrente_texto(const hash_internador_concurrente_t *internador, uint32_t id) {
+	if (id >= MAX_IDS) {
+		return NULL;
+	}
+	texto_atomico_t* trozo = atomic_load_explicit(&internador->directorio[id >> BITS_TROZO], memory_order_acquire);
+	return trozo ? atomic_load_explicit(&trozo[id & (IDS_POR_TROZO - 1)], memory_order_acquire) : NULL;
+}
+
+size_t hash_internador_concurrente_cantidad(const hash_internador_concurrente_t *internador) {
+	size_t cantidad = atomic_load((atomic_size_t*)&internador->siguiente_id);
+	return cantidad < MAX_IDS ? cantidad : MAX_IDS;
+}
+
+void hash_internador_concurrente_destruir(hash_internador_concurrente_t *internador) {
+	for (size_t i = 0; i < FRAGMENTOS; i++) {
+		pthread_mutex_destroy(&internador->fragmentos[i].mutex);
+		free(internador->fragmentos[i].tabla.ranuras);
+		liberar_bloques(internador->fragmentos[i].bloques);
+	}
+	for (size_t i = 0; i < TROZOS; i++) {
+		free(atomic_load(&internador->directorio[i]));
+	}
+	free(internador->directorio);
+	free(internador);
+}
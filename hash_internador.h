@@ -0,0 +1,95 @@
+#ifndef HASH_INTERNADOR_H
+#define HASH_INTERNADOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Internador de textos: a cada texto distinto le da un id chico y estable
+ * (0, 1, 2, ... en el orden en que aparecen) y guarda una sola copia del
+ * texto. Después dos textos internados son iguales si y sólo si tienen el
+ * mismo id, sin comparar caracteres.
+ *
+ * Los textos se copian uno detrás de otro en bloques grandes que nunca se
+ * mueven: el puntero que devuelve hash_internador_texto vale hasta que se
+ * destruye el internador. Para encontrarlos hay una tabla de
+ * direccionamiento abierto que guarda, junto al puntero, el hash completo
+ * (hash_funcion) y el id, así crecer no vuelve a leer los textos y casi
+ * nunca se compara un texto distinto.
+ *
+ * Admite hasta 2^32 - 2 textos.
+ */
+
+#define HASH_INTERNADOR_SIN_ID UINT32_MAX
+
+struct hash_internador;
+struct hash_internador_concurrente;
+
+typedef struct hash_internador hash_internador_t;
+typedef struct hash_internador_concurrente hash_internador_concurrente_t;
+
+/* Crea el internador, o devuelve NULL si no hubo memoria.
+ */
+hash_internador_t *hash_internador_crear(void);
+
+/* Devuelve el id de texto, internándolo si es nuevo. Devuelve
+ * HASH_INTERNADOR_SIN_ID si no hubo memoria o se acabaron los ids.
+ * Pre: el internador fue creado.
+ */
+uint32_t hash_internador_id(hash_internador_t *internador, const char *texto);
+
+/* Deja en ids[i] el id de textos[i], como hash_internador_id. Calcula los
+ * hashes de a tandas y pide por adelantado las ranuras de cada tanda, así
+ * los accesos a memoria de una tanda se superponen. Devuelve false si no
+ * hubo memoria; los textos anteriores al que falló quedan internados.
+ * Pre: el internador fue creado; ids tiene lugar para cantidad.
+ */
+bool hash_internador_ids(hash_internador_t *internador, const char **textos, size_t cantidad, uint32_t *ids);
+
+/* Devuelve el id de texto si ya estaba internado, o HASH_INTERNADOR_SIN_ID.
+ * Pre: el internador fue creado.
+ */
+uint32_t hash_internador_buscar(const hash_internador_t *internador, const char *texto);
+
+/* Devuelve el texto del id, o NULL si el id no se repartió.
+ * Pre: el internador fue creado.
+ */
+const char *hash_internador_texto(const hash_internador_t *internador, uint32_t id);
+
+/* Devuelve la cantidad de textos internados.
+ * Pre: el internador fue creado.
+ */
+size_t hash_internador_cantidad(const hash_internador_t *internador);
+
+/* Destruye el internador y sus copias de los textos.
+ * Pre: el internador fue creado.
+ */
+void hash_internador_destruir(hash_internador_t *internador);
+
+/* Variante para varios hilos: todas las primitivas se pueden llamar a la
+ * vez. Los textos se reparten por hash entre fragmentos, cada uno con su
+ * tabla, sus bloques de texto y su lock, así dos hilos sólo se esperan si
+ * caen en el mismo fragmento. Los ids salen de un contador común y siguen
+ * siendo consecutivos; hash_internador_concurrente_texto no toma ningún
+ * lock.
+ */
+
+hash_internador_concurrente_t *hash_internador_concurrente_crear(void);
+
+/* Como hash_internador_id. Si no hubo memoria después de reservar el id,
+ * ese id queda sin texto.
+ */
+uint32_t hash_internador_concurrente_id(hash_internador_concurrente_t *internador, const char *texto);
+
+uint32_t hash_internador_concurrente_buscar(hash_internador_concurrente_t *internador, const char *texto);
+
+const char *hash_internador_concurrente_texto(const hash_internador_concurrente_t *internador, uint32_t id);
+
+// Devuelve la cantidad de ids repartidos.
+size_t hash_internador_concurrente_cantidad(const hash_internador_concurrente_t *internador);
+
+/* Pre: ningún hilo está usando el internador.
+ */
+void hash_internador_concurrente_destruir(hash_internador_concurrente_t *internador);
+
+#endif // HASH_INTERNADOR_H
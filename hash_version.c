@@ -0,0 +1,451 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include "hash_version.h"
+
+#define CAPACIDAD_INICIAL 8
+#define MAX_ESPACIO_USADO 2
+
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+// Las entradas y los baldes se comparten entre versiones, por eso llevan
+// su propio contador de referencias. Una vez publicados no se modifican.
+typedef struct entrada {
+	atomic_size_t refs;
+	char* clave;
+	void* dato;
+	unsigned long hash;
+} entrada_t;
+
+typedef struct balde {
+	atomic_size_t refs;
+	size_t cantidad;
+	entrada_t* entradas[];
+} balde_t;
+
+struct hash_version {
+	atomic_size_t refs;
+	balde_t** tabla;
+	size_t cantidad;
+	size_t capacidad;
+	hash_destruir_dato_t destruir_dato;
+};
+
+// Los lectores se anotan en lectores[paridad] sólo durante el instante en que
+// leen el puntero publicado y suben las referencias de la versión. Así el
+// escritor sabe cuándo ningún lector puede seguir teniendo la versión vieja
+// sin haberla referenciado todavía.
+struct hash_versionado {
+	_Atomic(hash_version_t*) publicada;
+	atomic_size_t lectores[2];
+	atomic_uint paridad;
+	hash_version_t* borrador;
+	hash_destruir_dato_t destruir_dato;
+};
+
+struct hash_version_iter {
+	const hash_version_t* version;
+	size_t pos;
+	size_t indice;
+};
+
+
+/* ******************************************************************
+ *                    ENTRADAS, BALDES Y VERSIONES
+ * *****************************************************************/
+
+static entrada_t* entrada_crear(const char* clave, void* dato, unsigned long hash) {
+	entrada_t* entrada = malloc(sizeof(entrada_t));
+	if (!entrada) {
+		return NULL;
+	}
+	size_t largo = strlen(clave) + 1;
+	entrada->clave = malloc(largo);
+	if (!entrada->clave) {
+		free(entrada);
+		return NULL;
+	}
+	memcpy(entrada->clave, clave, largo);
+	atomic_init(&entrada->refs, 1);
+	entrada->dato = dato;
+	entrada->hash = hash;
+	return entrada;
+}
+
+static void entrada_liberar(entrada_t* entrada, hash_destruir_dato_t destruir_dato) {
+	if (atomic_fetch_sub(&entrada->refs, 1) != 1) {
+		return;
+	}
+	if (destruir_dato) {
+		destruir_dato(entrada->dato);
+	}
+	free(entrada->clave);
+	free(entrada);
+}
+
+static balde_t* balde_crear(size_t cantidad) {
+	balde_t* balde = malloc(sizeof(balde_t) + cantidad * sizeof(entrada_t*));
+	if (!balde) {
+		return NULL;
+	}
+	atomic_init(&balde->refs, 1);
+	balde->cantidad = cantidad;
+	return balde;
+}
+
+static void balde_liberar(balde_t* balde, hash_destruir_dato_t destruir_dato) {
+	if (!balde || atomic_fetch_sub(&balde->refs, 1) != 1) {
+		return;
+	}
+	for (size_t i = 0; i < balde->cantidad; i++) {
+		entrada_liberar(balde->entradas[i], destruir_dato);
+	}
+	free(balde);
+}
+
+// Devuelve la posicion de la clave en el balde o balde->cantidad si no está
+static size_t balde_buscar(const balde_t* balde, const char* clave, unsigned long hash) {
+	if (!balde) {
+		return 0;
+	}
+	size_t i = 0;
+	while (i < balde->cantidad && (balde->entradas[i]->hash != hash || strcmp(balde->entradas[i]->clave, clave) != 0)) {
+		i++;
+	}
+	return i;
+}
+
+static hash_version_t* version_crear(size_t capacidad, hash_destruir_dato_t destruir_dato) {
+	hash_version_t* version = malloc(sizeof(hash_version_t));
+	if (!version) {
+		return NULL;
+	}
+	version->tabla = calloc(capacidad, sizeof(balde_t*));
+	if (!version->tabla) {
+		free(version);
+		return NULL;
+	}
+	atomic_init(&version->refs, 1);
+	version->cantidad = 0;
+	version->capacidad = capacidad;
+	version->destruir_dato = destruir_dato;
+	return version;
+}
+
+static void version_liberar(hash_version_t* version) {
+	if (atomic_fetch_sub(&version->refs, 1) != 1) {
+		return;
+	}
+	for (size_t i = 0; i < version->capacidad; i++) {
+		balde_liberar(version->tabla[i], version->destruir_dato);
+	}
+	free(version->tabla);
+	free(version);
+}
+
+// Copia el arreglo de baldes; los baldes quedan compartidos con la original
+static hash_version_t* version_copiar(const hash_version_t* original) {
+	hash_version_t* copia = version_crear(original->capacidad, original->destruir_dato);
+	if (!copia) {
+		return NULL;
+	}
+	for (size_t i = 0; i < original->capacidad; i++) {
+		balde_t* balde = original->tabla[i];
+		if (balde) {
+			atomic_fetch_add(&balde->refs, 1);
+		}
+		copia->tabla[i] = balde;
+	}
+	copia->cantidad = original->cantidad;
+	return copia;
+}
+
+//rearma los baldes del borrador con la nueva capacidad, usando el hash guardado en cada entrada
+static bool version_redimensionar(hash_version_t* version, size_t nueva_capacidad) {
+	size_t* cantidades = calloc(nueva_capacidad, sizeof(size_t));
+	balde_t** nueva_tabla = calloc(nueva_capacidad, sizeof(balde_t*));
+	if (!cantidades || !nueva_tabla) {
+		free(cantidades);
+		free(nueva_tabla);
+		return false;
+	}
+	for (size_t i = 0; i < version->capacidad; i++) {
+		balde_t* balde = version->tabla[i];
+		for (size_t j = 0; balde && j < balde->cantidad; j++) {
+			cantidades[balde->entradas[j]->hash % nueva_capacidad]++;
+		}
+	}
+	for (size_t i = 0; i < nueva_capacidad; i++) {
+		if (cantidades[i] == 0) {
+			continue;
+		}
+		nueva_tabla[i] = balde_crear(cantidades[i]);
+		if (!nueva_tabla[i]) {
+			for (size_t j = 0; j < i; j++) {
+				free(nueva_tabla[j]);
+			}
+			free(cantidades);
+			free(nueva_tabla);
+			return false;
+		}
+		nueva_tabla[i]->cantidad = 0;
+	}
+	for (size_t i = 0; i < version->capacidad; i++) {
+		balde_t* balde = version->tabla[i];
+		for (size_t j = 0; balde && j < balde->cantidad; j++) {
+			entrada_t* entrada = balde->entradas[j];
+			balde_t* destino = nueva_tabla[entrada->hash % nueva_capacidad];
+			atomic_fetch_add(&entrada->refs, 1);
+			destino->entradas[destino->cantidad++] = entrada;
+		}
+		balde_liberar(balde, version->destruir_dato);
+	}
+	free(cantidades);
+	free(version->tabla);
+	version->tabla = nueva_tabla;
+	version->capacidad = nueva_capacidad;
+	return true;
+}
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL ESCRITOR
+ * *****************************************************************/
+
+hash_versionado_t *hash_versionado_crear(hash_destruir_dato_t destruir_dato) {
+	hash_versionado_t* hash = malloc(sizeof(hash_versionado_t));
+	if (!hash) {
+		return NULL;
+	}
+	hash_version_t* inicial = version_crear(CAPACIDAD_INICIAL, destruir_dato);
+	if (!inicial) {
+		free(hash);
+		return NULL;
+	}
+	atomic_init(&hash->publicada, inicial);
+	atomic_init(&hash->lectores[0], 0);
+	atomic_init(&hash->lectores[1], 0);
+	atomic_init(&hash->paridad, 0);
+	hash->borrador = NULL;
+	hash->destruir_dato = destruir_dato;
+	return hash;
+}
+
+// El primer cambio despues de publicar copia la version publicada
+static hash_version_t* obtener_borrador(hash_versionado_t* hash) {
+	if (!hash->borrador) {
+		hash->borrador = version_copiar(atomic_load(&hash->publicada));
+	}
+	return hash->borrador;
+}
+
+bool hash_versionado_guardar(hash_versionado_t *hash, const char *clave, void *dato) {
+	hash_version_t* borrador = obtener_borrador(hash);
+	if (!borrador) {
+		return false;
+	}
+	if (borrador->cantidad >= borrador->capacidad * MAX_ESPACIO_USADO) {
+		if (!version_redimensionar(borrador, borrador->capacidad * 2)) {
+			return false;
+		}
+	}
+	unsigned long clave_hash = hash_funcion(clave);
+	size_t pos = clave_hash % borrador->capacidad;
+	balde_t* viejo = borrador->tabla[pos];
+	size_t cantidad = viejo ? viejo->cantidad : 0;
+	size_t encontrada = balde_buscar(viejo, clave, clave_hash);
+
+	entrada_t* entrada = entrada_crear(clave, dato, clave_hash);
+	balde_t* nuevo = balde_crear(encontrada < cantidad ? cantidad : cantidad + 1);
+	if (!entrada || !nuevo) {
+		if (entrada) {
+			free(entrada->clave);
+		}
+		free(entrada);
+		free(nuevo);
+		return false;
+	}
+	// el balde nuevo comparte todas las entradas menos la reemplazada
+	for (size_t i = 0; i < cantidad; i++) {
+		if (i == encontrada) {
+			continue;
+		}
+		atomic_fetch_add(&viejo->entradas[i]->refs, 1);
+		nuevo->entradas[i] = viejo->entradas[i];
+	}
+	nuevo->entradas[encontrada] = entrada;
+	if (encontrada == cantidad) {
+		borrador->cantidad++;
+	}
+	borrador->tabla[pos] = nuevo;
+	balde_liberar(viejo, borrador->destruir_dato);
+	return true;
+}
+
+bool hash_versionado_borrar(hash_versionado_t *hash, const char *clave) {
+	hash_version_t* borrador = obtener_borrador(hash);
+	if (!borrador) {
+		return false;
+	}
+	unsigned long clave_hash = hash_funcion(clave);
+	size_t pos = clave_hash % borrador->capacidad;
+	balde_t* viejo = borrador->tabla[pos];
+	size_t encontrada = balde_buscar(viejo, clave, clave_hash);
+	if (!viejo || encontrada == viejo->cantidad) {
+		return false;
+	}
+	balde_t* nuevo = NULL;
+	if (viejo->cantidad > 1) {
+		nuevo = balde_crear(viejo->cantidad - 1);
+		if (!nuevo) {
+			return false;
+		}
+		size_t j = 0;
+		for (size_t i = 0; i < viejo->cantidad; i++) {
+			if (i == encontrada) {
+				continue;
+			}
+			atomic_fetch_add(&viejo->entradas[i]->refs, 1);
+			nuevo->entradas[j++] = viejo->entradas[i];
+		}
+	}
+	borrador->tabla[pos] = nuevo;
+	borrador->cantidad--;
+	balde_liberar(viejo, borrador->destruir_dato);
+
+	// Si quedó muy vacío se achica; si no hay memoria se deja como está
+	if (borrador->capacidad > CAPACIDAD_INICIAL && borrador->cantidad * 2 < borrador->capacidad) {
+		version_redimensionar(borrador, borrador->capacidad / 2);
+	}
+	return true;
+}
+
+/* Espera a que ningún lector pueda tener la versión anterior sin haberla
+ * referenciado. Se cambia la paridad dos veces: los lectores nuevos se anotan
+ * en el contador que no se está esperando, así que la espera es acotada por
+ * lo que tarda un lector en adquirir, nunca por lo que la usa.
+ */
+static void esperar_lectores(hash_versionado_t* hash) {
+	for (int i = 0; i < 2; i++) {
+		unsigned paridad = atomic_load(&hash->paridad);
+		atomic_store(&hash->paridad, paridad ^ 1);
+		while (atomic_load(&hash->lectores[paridad]) != 0) {
+			sched_yield();
+		}
+	}
+}
+
+void hash_versionado_publicar(hash_versionado_t *hash) {
+	if (!hash->borrador) {
+		return;
+	}
+	hash_version_t* vieja = atomic_exchange(&hash->publicada, hash->borrador);
+	hash->borrador = NULL;
+	esperar_lectores(hash);
+	version_liberar(vieja);
+}
+
+void hash_versionado_destruir(hash_versionado_t *hash) {
+	if (hash->borrador) {
+		version_liberar(hash->borrador);
+	}
+	version_liberar(atomic_load(&hash->publicada));
+	free(hash);
+}
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DE LOS LECTORES
+ * *****************************************************************/
+
+const hash_version_t *hash_version_adquirir(hash_versionado_t *hash) {
+	unsigned paridad = atomic_load(&hash->paridad);
+	atomic_fetch_add(&hash->lectores[paridad], 1);
+	hash_version_t* version = atomic_load(&hash->publicada);
+	atomic_fetch_add(&version->refs, 1);
+	atomic_fetch_sub(&hash->lectores[paridad], 1);
+	return version;
+}
+
+void hash_version_liberar(const hash_version_t *version) {
+	version_liberar((hash_version_t*)version);
+}
+
+static entrada_t* version_buscar(const hash_version_t* version, const char* clave) {
+	unsigned long clave_hash = hash_funcion(clave);
+	balde_t* balde = version->tabla[clave_hash % version->capacidad];
+	size_t encontrada = balde_buscar(balde, clave, clave_hash);
+	if (!balde || encontrada == balde->cantidad) {
+		return NULL;
+	}
+	return balde->entradas[encontrada];
+}
+
+void *hash_version_obtener(const hash_version_t *version, const char *clave) {
+	entrada_t* entrada = version_buscar(version, clave);
+	return entrada ? entrada->dato : NULL;
+}
+
+bool hash_version_pertenece(const hash_version_t *version, const char *clave) {
+	return version_buscar(version, clave) != NULL;
+}
+
+size_t hash_version_cantidad(const hash_version_t *version) {
+	return version->cantidad;
+}
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL ITERADOR
+ * *****************************************************************/
+
+// deja al iterador en la proxima entrada valida (o al final)
+static void iter_acomodar(hash_version_iter_t* iter) {
+	const hash_version_t* version = iter->version;
+	while (iter->pos < version->capacidad && (!version->tabla[iter->pos] || iter->indice >= version->tabla[iter->pos]->cantidad)) {
+		iter->pos++;
+		iter->indice = 0;
+	}
+}
+
+hash_version_iter_t *hash_version_iter_crear(const hash_version_t *version) {
+	hash_version_iter_t* iter = malloc(sizeof(hash_version_iter_t));
+	if (!iter) {
+		return NULL;
+	}
+	iter->version = version;
+	iter->pos = 0;
+	iter->indice = 0;
+	iter_acomodar(iter);
+	return iter;
+}
+
+bool hash_version_iter_al_final(const hash_version_iter_t *iter) {
+	return iter->pos >= iter->version->capacidad;
+}
+
+bool hash_version_iter_avanzar(hash_version_iter_t *iter) {
+	if (hash_version_iter_al_final(iter)) {
+		return false;
+	}
+	iter->indice++;
+	iter_acomodar(iter);
+	return !hash_version_iter_al_final(iter);
+}
+
+const char *hash_version_iter_ver_actual(const hash_version_iter_t *iter) {
+	if (hash_version_iter_al_final(iter)) {
+		return NULL;
+	}
+	return iter->version->tabla[iter->pos]->entradas[iter->indice]->clave;
+}
+
+void hash_version_iter_destruir(hash_version_iter_t *iter) {
+	free(iter);
+}
@@ -0,0 +1,99 @@
+#ifndef HASH_VERSION_H
+#define HASH_VERSION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "hash.h"
+
+/* Hash versionado: un único escritor arma versiones inmutables de la tabla
+ * y las publica a través de un puntero atómico. Los lectores toman la versión
+ * publicada con hash_version_adquirir y la consultan sin ningún lock: nunca
+ * esperan al escritor ni a un redimensionamiento, porque éstos ocurren sobre
+ * un borrador que todavía no es visible.
+ *
+ * Las versiones comparten los baldes y las entradas que no cambiaron (copia
+ * por camino), así que publicar una versión cuesta copiar el arreglo de
+ * baldes más los baldes tocados, no la tabla entera.
+ */
+
+struct hash_versionado;
+struct hash_version;
+struct hash_version_iter;
+
+typedef struct hash_versionado hash_versionado_t;
+typedef struct hash_version hash_version_t;
+typedef struct hash_version_iter hash_version_iter_t;
+
+/* Primitivas del escritor. Sólo un hilo a la vez puede llamarlas. */
+
+/* Crea el hash versionado, con una primera versión vacía ya publicada.
+ */
+hash_versionado_t *hash_versionado_crear(hash_destruir_dato_t destruir_dato);
+
+/* Guarda el par (clave, dato) en el borrador, reemplazando el dato anterior
+ * si la clave ya estaba. El cambio no es visible hasta publicar.
+ * Pre: el hash versionado fue creado.
+ * Post: devuelve false si no hubo memoria para copiar el borrador.
+ */
+bool hash_versionado_guardar(hash_versionado_t *hash, const char *clave, void *dato);
+
+/* Borra la clave del borrador. A diferencia de hash_borrar no devuelve el
+ * dato: puede seguir siendo leído desde versiones viejas, así que se destruye
+ * recién cuando se libera la última versión que lo contiene.
+ * Pre: el hash versionado fue creado.
+ * Post: devuelve true si la clave estaba y fue borrada.
+ */
+bool hash_versionado_borrar(hash_versionado_t *hash, const char *clave);
+
+/* Publica el borrador como la nueva versión visible para los lectores. Si
+ * no hubo cambios desde la última publicación no hace nada.
+ * Pre: el hash versionado fue creado.
+ */
+void hash_versionado_publicar(hash_versionado_t *hash);
+
+/* Destruye el hash versionado descartando el borrador. Las versiones que
+ * los lectores todavía tengan adquiridas siguen siendo válidas hasta que
+ * las liberen.
+ * Pre: no hay llamadas a hash_version_adquirir en curso.
+ */
+void hash_versionado_destruir(hash_versionado_t *hash);
+
+/* Primitivas de los lectores. Pueden llamarse desde cualquier hilo. */
+
+/* Devuelve la versión publicada en este momento. La versión no cambia
+ * mientras se la tenga adquirida, aunque el escritor publique otras.
+ * Post: la versión debe liberarse con hash_version_liberar.
+ */
+const hash_version_t *hash_version_adquirir(hash_versionado_t *hash);
+
+// Libera una versión adquirida.
+void hash_version_liberar(const hash_version_t *version);
+
+// Obtiene el dato de la clave en la versión, o NULL si no está.
+void *hash_version_obtener(const hash_version_t *version, const char *clave);
+
+// Determina si la clave pertenece a la versión.
+bool hash_version_pertenece(const hash_version_t *version, const char *clave);
+
+// Devuelve la cantidad de elementos de la versión.
+size_t hash_version_cantidad(const hash_version_t *version);
+
+/* Iterador de una versión. La versión debe seguir adquirida mientras
+ * se use el iterador. */
+
+// Crea iterador
+hash_version_iter_t *hash_version_iter_crear(const hash_version_t *version);
+
+// Avanza iterador
+bool hash_version_iter_avanzar(hash_version_iter_t *iter);
+
+// Devuelve clave actual, esa clave no se puede modificar ni liberar.
+const char *hash_version_iter_ver_actual(const hash_version_iter_t *iter);
+
+// Comprueba si terminó la iteración
+bool hash_version_iter_al_final(const hash_version_iter_t *iter);
+
+// Destruye iterador
+void hash_version_iter_destruir(hash_version_iter_t *iter);
+
+#endif // HASH_VERSION_H
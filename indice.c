@@ -0,0 +1,288 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "indice.h"
+
+// Un AVL de n nodos mide menos de 1.45 * log2(n + 2): 64 alcanza de sobra
+#define ALTURA_MAXIMA 64
+
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+typedef struct nodo_indice {
+	struct nodo_indice* izq;
+	struct nodo_indice* der;
+	const char* clave;
+	void* valor;
+	int altura;
+} nodo_indice_t;
+
+struct indice {
+	nodo_indice_t* raiz;
+	size_t cantidad;
+};
+
+// La pila guarda los ancestros que todavía falta visitar (recorrido inorder)
+struct indice_iter {
+	nodo_indice_t* pila[ALTURA_MAXIMA];
+	size_t tope;
+};
+
+
+/* ******************************************************************
+ *                        BALANCEO AVL
+ * *****************************************************************/
+
+static int altura(const nodo_indice_t* nodo) {
+	return nodo ? nodo->altura : 0;
+}
+
+static void actualizar_altura(nodo_indice_t* nodo) {
+	int izq = altura(nodo->izq);
+	int der = altura(nodo->der);
+	nodo->altura = 1 + (izq > der ? izq : der);
+}
+
+static nodo_indice_t* rotar_derecha(nodo_indice_t* nodo) {
+	nodo_indice_t* hijo = nodo->izq;
+	nodo->izq = hijo->der;
+	hijo->der = nodo;
+	actualizar_altura(nodo);
+	actualizar_altura(hijo);
+	return hijo;
+}
+
+static nodo_indice_t* rotar_izquierda(nodo_indice_t* nodo) {
+	nodo_indice_t* hijo = nodo->der;
+	nodo->der = hijo->izq;
+	hijo->izq = nodo;
+	actualizar_altura(nodo);
+	actualizar_altura(hijo);
+	return hijo;
+}
+
+static nodo_indice_t* balancear(nodo_indice_t* nodo) {
+	actualizar_altura(nodo);
+	int factor = altura(nodo->izq) - altura(nodo->der);
+	if (factor > 1) {
+		if (altura(nodo->izq->izq) < altura(nodo->izq->der)) {
+			nodo->izq = rotar_izquierda(nodo->izq);
+		}
+		return rotar_derecha(nodo);
+	}
+	if (factor < -1) {
+		if (altura(nodo->der->der) < altura(nodo->der->izq)) {
+			nodo->der = rotar_derecha(nodo->der);
+		}
+		return rotar_izquierda(nodo);
+	}
+	return nodo;
+}
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL INDICE
+ * *****************************************************************/
+
+indice_t *indice_crear(void) {
+	indice_t* indice = malloc(sizeof(indice_t));
+	if (!indice) {
+		return NULL;
+	}
+	indice->raiz = NULL;
+	indice->cantidad = 0;
+	return indice;
+}
+
+// Inserta en el subárbol y devuelve su nueva raíz; si falta memoria lo deja intacto
+static nodo_indice_t* insertar(nodo_indice_t* nodo, const char* clave, void* valor, bool* ok, bool* agregado) {
+	if (!nodo) {
+		nodo_indice_t* hoja = malloc(sizeof(nodo_indice_t));
+		if (!hoja) {
+			*ok = false;
+			return NULL;
+		}
+		hoja->izq = NULL;
+		hoja->der = NULL;
+		hoja->clave = clave;
+		hoja->valor = valor;
+		hoja->altura = 1;
+		*agregado = true;
+		return hoja;
+	}
+	int comparacion = strcmp(clave, nodo->clave);
+	if (comparacion == 0) {
+		nodo->clave = clave;
+		nodo->valor = valor;
+		return nodo;
+	}
+	if (comparacion < 0) {
+		nodo_indice_t* izq = insertar(nodo->izq, clave, valor, ok, agregado);
+		if (!*ok) {
+			return nodo;
+		}
+		nodo->izq = izq;
+	} else {
+		nodo_indice_t* der = insertar(nodo->der, clave, valor, ok, agregado);
+		if (!*ok) {
+			return nodo;
+		}
+		nodo->der = der;
+	}
+	return balancear(nodo);
+}
+
+bool indice_guardar(indice_t *indice, const char *clave, void *valor) {
+	bool ok = true;
+	bool agregado = false;
+	indice->raiz = insertar(indice->raiz, clave, valor, &ok, &agregado);
+	if (agregado) {
+		indice->cantidad++;
+	}
+	return ok;
+}
+
+// Saca el mínimo del subárbol y lo deja en minimo
+static nodo_indice_t* sacar_minimo(nodo_indice_t* nodo, nodo_indice_t** minimo) {
+	if (!nodo->izq) {
+		*minimo = nodo;
+		return nodo->der;
+	}
+	nodo->izq = sacar_minimo(nodo->izq, minimo);
+	return balancear(nodo);
+}
+
+static nodo_indice_t* borrar(nodo_indice_t* nodo, const char* clave, bool* borrado) {
+	if (!nodo) {
+		return NULL;
+	}
+	int comparacion = strcmp(clave, nodo->clave);
+	if (comparacion < 0) {
+		nodo->izq = borrar(nodo->izq, clave, borrado);
+	} else if (comparacion > 0) {
+		nodo->der = borrar(nodo->der, clave, borrado);
+	} else {
+		*borrado = true;
+		nodo_indice_t* izq = nodo->izq;
+		nodo_indice_t* der = nodo->der;
+		free(nodo);
+		if (!der) {
+			return izq;
+		}
+		// el sucesor ocupa el lugar del nodo borrado
+		nodo_indice_t* sucesor;
+		nodo_indice_t* resto = sacar_minimo(der, &sucesor);
+		sucesor->izq = izq;
+		sucesor->der = resto;
+		return balancear(sucesor);
+	}
+	return balancear(nodo);
+}
+
+bool indice_borrar(indice_t *indice, const char *clave) {
+	bool borrado = false;
+	indice->raiz = borrar(indice->raiz, clave, &borrado);
+	if (borrado) {
+		indice->cantidad--;
+	}
+	return borrado;
+}
+
+size_t indice_cantidad(const indice_t *indice) {
+	return indice->cantidad;
+}
+
+static void destruir_nodos(nodo_indice_t* nodo) {
+	if (!nodo) {
+		return;
+	}
+	destruir_nodos(nodo->izq);
+	destruir_nodos(nodo->der);
+	free(nodo);
+}
+
+void indice_destruir(indice_t *indice) {
+	destruir_nodos(indice->raiz);
+	free(indice);
+}
+
+/* Visita el subárbol en orden podando las ramas fuera de [desde, hasta].
+ * Devuelve false si visitar pidió cortar.
+ */
+static bool rango(const nodo_indice_t* nodo, const char* desde, const char* hasta,
+		bool visitar(const char*, void*, void*), void* extra) {
+	if (!nodo) {
+		return true;
+	}
+	bool mayor_a_desde = !desde || strcmp(nodo->clave, desde) >= 0;
+	bool menor_a_hasta = !hasta || strcmp(nodo->clave, hasta) <= 0;
+	if (mayor_a_desde && !rango(nodo->izq, desde, hasta, visitar, extra)) {
+		return false;
+	}
+	if (mayor_a_desde && menor_a_hasta && !visitar(nodo->clave, nodo->valor, extra)) {
+		return false;
+	}
+	if (menor_a_hasta) {
+		return rango(nodo->der, desde, hasta, visitar, extra);
+	}
+	return true;
+}
+
+void indice_rango(const indice_t *indice, const char *desde, const char *hasta,
+		bool visitar(const char *clave, void *valor, void *extra), void *extra) {
+	rango(indice->raiz, desde, hasta, visitar, extra);
+}
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL ITERADOR
+ * *****************************************************************/
+
+// Apila el camino a la primera clave >= desde del subárbol
+static void apilar_desde(indice_iter_t* iter, nodo_indice_t* nodo, const char* desde) {
+	while (nodo) {
+		if (desde && strcmp(nodo->clave, desde) < 0) {
+			nodo = nodo->der;
+		} else {
+			iter->pila[iter->tope++] = nodo;
+			nodo = nodo->izq;
+		}
+	}
+}
+
+indice_iter_t *indice_iter_crear(const indice_t *indice, const char *desde) {
+	indice_iter_t* iter = malloc(sizeof(indice_iter_t));
+	if (!iter) {
+		return NULL;
+	}
+	iter->tope = 0;
+	apilar_desde(iter, indice->raiz, desde);
+	return iter;
+}
+
+bool indice_iter_al_final(const indice_iter_t *iter) {
+	return iter->tope == 0;
+}
+
+bool indice_iter_avanzar(indice_iter_t *iter) {
+	if (indice_iter_al_final(iter)) {
+		return false;
+	}
+	nodo_indice_t* actual = iter->pila[--iter->tope];
+	apilar_desde(iter, actual->der, NULL);
+	return true;
+}
+
+const char *indice_iter_ver_clave(const indice_iter_t *iter) {
+	return indice_iter_al_final(iter) ? NULL : iter->pila[iter->tope - 1]->clave;
+}
+
+void *indice_iter_ver_valor(const indice_iter_t *iter) {
+	return indice_iter_al_final(iter) ? NULL : iter->pila[iter->tope - 1]->valor;
+}
+
+void indice_iter_destruir(indice_iter_t *iter) {
+	free(iter);
+}
@@ -0,0 +1,67 @@
+#ifndef INDICE_H
+#define INDICE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Índice ordenado por clave (árbol AVL). No es dueño de las claves: guarda
+ * el puntero que recibe, que debe seguir siendo válido mientras la clave
+ * esté en el índice. El hash lo usa para mantener sus claves en orden.
+ */
+
+struct indice;
+struct indice_iter;
+
+typedef struct indice indice_t;
+typedef struct indice_iter indice_iter_t;
+
+// Crea un índice vacío, o devuelve NULL si no hubo memoria.
+indice_t *indice_crear(void);
+
+/* Agrega la clave con su valor. Si la clave ya estaba reemplaza la clave y el
+ * valor guardados. Devuelve false si no hubo memoria.
+ * Pre: el índice fue creado.
+ */
+bool indice_guardar(indice_t *indice, const char *clave, void *valor);
+
+/* Saca la clave del índice. Devuelve false si no estaba.
+ * Pre: el índice fue creado.
+ */
+bool indice_borrar(indice_t *indice, const char *clave);
+
+// Devuelve la cantidad de claves del índice.
+size_t indice_cantidad(const indice_t *indice);
+
+// Destruye el índice. No toca las claves ni los valores.
+void indice_destruir(indice_t *indice);
+
+/* Aplica visitar, en orden, a cada par con desde <= clave <= hasta hasta que
+ * devuelva false. Un extremo NULL no pone límite de ese lado.
+ * Cuesta O(log n + k), con k la cantidad de claves visitadas.
+ * Pre: el índice fue creado.
+ */
+void indice_rango(const indice_t *indice, const char *desde, const char *hasta,
+		bool visitar(const char *clave, void *valor, void *extra), void *extra);
+
+/* Iterador en orden */
+
+// Crea un iterador que arranca en la primera clave >= desde (o en la primera
+// clave si desde es NULL).
+indice_iter_t *indice_iter_crear(const indice_t *indice, const char *desde);
+
+// Avanza iterador
+bool indice_iter_avanzar(indice_iter_t *iter);
+
+// Devuelve la clave actual, o NULL si terminó la iteración.
+const char *indice_iter_ver_clave(const indice_iter_t *iter);
+
+// Devuelve el valor actual, o NULL si terminó la iteración.
+void *indice_iter_ver_valor(const indice_iter_t *iter);
+
+// Comprueba si terminó la iteración
+bool indice_iter_al_final(const indice_iter_t *iter);
+
+// Destruye iterador
+void indice_iter_destruir(indice_iter_t *iter);
+
+#endif // INDICE_H
@@ -80,6 +80,57 @@ bool lista_insertar_ultimo(lista_t *lista, void* dato){
 	return true;
 }
 
+bool lista_insertar_varios(lista_t *lista, void* datos[], size_t cantidad){
+	// se arma la cadena aparte para no dejar la lista a medias si falla un malloc
+	nodo_t* primero = NULL;
+	nodo_t* ultimo = NULL;
+	for (size_t i = 0; i < cantidad; i++){
+		nodo_t* nodo = nodo_crear(datos[i]);
+		if (nodo == NULL){
+			while (primero){
+				nodo = primero;
+				primero = primero->proximo;
+				free(nodo);
+			}
+			return false;
+		}
+		nodo->proximo = NULL;
+		if (ultimo){
+			ultimo->proximo = nodo;
+		} else {
+			primero = nodo;
+		}
+		ultimo = nodo;
+	}
+	if (!primero){
+		return true;
+	}
+	if (lista->ultimo){
+		lista->ultimo->proximo = primero;
+	} else {
+		lista->primero = primero;
+	}
+	lista->ultimo = ultimo;
+	lista->tam += cantidad;
+	return true;
+}
+
+void lista_extender(lista_t *lista, lista_t *otra){
+	if (lista_esta_vacia(otra)){
+		return;
+	}
+	if (lista->ultimo){
+		lista->ultimo->proximo = otra->primero;
+	} else {
+		lista->primero = otra->primero;
+	}
+	lista->ultimo = otra->ultimo;
+	lista->tam += otra->tam;
+	otra->primero = NULL;
+	otra->ultimo = NULL;
+	otra->tam = 0;
+}
+
 void* lista_borrar_primero(lista_t *lista){
 	if (lista_esta_vacia(lista)){
 		return NULL;
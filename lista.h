@@ -31,6 +31,17 @@ bool lista_insertar_primero(lista_t* lista, void* dato);
 // de la lista.
 bool lista_insertar_ultimo(lista_t* lista, void* dato);
 
+// Agrega al final de la lista los cantidad datos del arreglo, en orden.
+// Devuelve falso en caso de error, y en ese caso la lista queda como estaba.
+// Pre: la lista fue creada.
+// Post: se agregaron los datos al final de la lista.
+bool lista_insertar_varios(lista_t* lista, void* datos[], size_t cantidad);
+
+// Mueve al final de la lista todos los elementos de otra, sin copiarlos.
+// Pre: ambas listas fueron creadas.
+// Post: los elementos de otra quedaron al final de la lista y otra quedó vacía.
+void lista_extender(lista_t* lista, lista_t* otra);
+
 // Saca el primer elemento de la lista. Si la lista tiene elementos, se quita el
 // primero de la lista, y se devuelve su valor, si está vacía, devuelve NULL.
 // Pre: la lista fue creada.
@@ -0,0 +1,340 @@
+#define _POSIX_C_SOURCE 200112L
+#include "lista_bloque.h"
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+
+#define TAM_LINEA_CACHE 64
+// con los dos punteros y los contadores el bloque ocupa justo dos líneas
+#define ELEMENTOS_POR_BLOQUE 13
+
+struct bloque {
+	struct bloque* anterior;
+	struct bloque* proximo;
+	unsigned short inicio;
+	unsigned short cantidad;
+	void* datos[ELEMENTOS_POR_BLOQUE];
+};
+
+typedef struct bloque bloque_t;
+
+struct lista_bloque {
+	bloque_t* primero;
+	bloque_t* ultimo;
+	size_t tam;
+};
+
+struct lista_bloque_iter {
+	lista_bloque_t* lista;
+	bloque_t* actual;
+	size_t pos;
+};
+
+/* Los datos de un bloque ocupan datos[inicio, inicio + cantidad). Dejar lugar
+ * libre adelante permite que borrar_primero e insertar_primero no muevan nada.
+ */
+static bloque_t* bloque_crear(unsigned short inicio) {
+	void* memoria;
+	if (posix_memalign(&memoria, TAM_LINEA_CACHE, sizeof(bloque_t)) != 0) {
+		return NULL;
+	}
+	bloque_t* bloque = memoria;
+	bloque->anterior = NULL;
+	bloque->proximo = NULL;
+	bloque->inicio = inicio;
+	bloque->cantidad = 0;
+	return bloque;
+}
+
+static size_t bloque_fin(const bloque_t* bloque) {
+	return (size_t)bloque->inicio + bloque->cantidad;
+}
+
+// Engancha nuevo despues de bloque (o al principio si bloque es NULL)
+static void enlazar_despues(lista_bloque_t* lista, bloque_t* bloque, bloque_t* nuevo) {
+	nuevo->anterior = bloque;
+	nuevo->proximo = bloque ? bloque->proximo : lista->primero;
+	if (nuevo->proximo) {
+		nuevo->proximo->anterior = nuevo;
+	} else {
+		lista->ultimo = nuevo;
+	}
+	if (bloque) {
+		bloque->proximo = nuevo;
+	} else {
+		lista->primero = nuevo;
+	}
+}
+
+static void desenlazar(lista_bloque_t* lista, bloque_t* bloque) {
+	if (bloque->anterior) {
+		bloque->anterior->proximo = bloque->proximo;
+	} else {
+		lista->primero = bloque->proximo;
+	}
+	if (bloque->proximo) {
+		bloque->proximo->anterior = bloque->anterior;
+	} else {
+		lista->ultimo = bloque->anterior;
+	}
+	free(bloque);
+}
+
+/* Hace lugar en la posición pos del bloque (que no está lleno) corriendo
+ * hacia el lado que tenga espacio. Devuelve la posición libre resultante.
+ */
+static size_t bloque_abrir_hueco(bloque_t* bloque, size_t pos) {
+	if (bloque_fin(bloque) < ELEMENTOS_POR_BLOQUE) {
+		memmove(&bloque->datos[pos + 1], &bloque->datos[pos], (bloque_fin(bloque) - pos) * sizeof(void*));
+	} else {
+		memmove(&bloque->datos[bloque->inicio - 1], &bloque->datos[bloque->inicio], (pos - bloque->inicio) * sizeof(void*));
+		bloque->inicio--;
+		pos--;
+	}
+	bloque->cantidad++;
+	return pos;
+}
+
+lista_bloque_t* lista_bloque_crear(void){
+	lista_bloque_t* lista = malloc(sizeof(lista_bloque_t));
+	if (lista == NULL) {
+		return NULL;
+	}
+	lista->primero = NULL;
+	lista->ultimo = NULL;
+	lista->tam = 0;
+	return lista;
+}
+
+bool lista_bloque_esta_vacia(const lista_bloque_t* lista){
+	return lista->tam == 0;
+}
+
+bool lista_bloque_insertar_primero(lista_bloque_t* lista, void* dato){
+	bloque_t* bloque = lista->primero;
+	if (!bloque || bloque->cantidad == ELEMENTOS_POR_BLOQUE) {
+		bloque = bloque_crear(ELEMENTOS_POR_BLOQUE);
+		if (!bloque) {
+			return false;
+		}
+		enlazar_despues(lista, NULL, bloque);
+	}
+	size_t pos = bloque_abrir_hueco(bloque, bloque->inicio);
+	bloque->datos[pos] = dato;
+	lista->tam++;
+	return true;
+}
+
+bool lista_bloque_insertar_ultimo(lista_bloque_t* lista, void* dato){
+	bloque_t* bloque = lista->ultimo;
+	if (!bloque || bloque->cantidad == ELEMENTOS_POR_BLOQUE) {
+		bloque = bloque_crear(0);
+		if (!bloque) {
+			return false;
+		}
+		enlazar_despues(lista, lista->ultimo, bloque);
+	}
+	size_t pos = bloque_abrir_hueco(bloque, bloque_fin(bloque));
+	bloque->datos[pos] = dato;
+	lista->tam++;
+	return true;
+}
+
+bool lista_bloque_insertar_varios(lista_bloque_t* lista, void* datos[], size_t cantidad){
+	// primero se piden todos los bloques que hagan falta, así un error no deja la lista a medias
+	size_t libres = lista->ultimo ? ELEMENTOS_POR_BLOQUE - bloque_fin(lista->ultimo) : 0;
+	size_t a_llenar = cantidad > libres ? cantidad - libres : 0;
+	size_t bloques = (a_llenar + ELEMENTOS_POR_BLOQUE - 1) / ELEMENTOS_POR_BLOQUE;
+	lista_bloque_t nuevos = {NULL, NULL, 0};
+	for (size_t i = 0; i < bloques; i++) {
+		bloque_t* bloque = bloque_crear(0);
+		if (!bloque) {
+			while (nuevos.primero) {
+				desenlazar(&nuevos, nuevos.primero);
+			}
+			return false;
+		}
+		enlazar_despues(&nuevos, nuevos.ultimo, bloque);
+	}
+
+	size_t copiados = cantidad < libres ? cantidad : libres;
+	if (copiados > 0) {
+		memcpy(&lista->ultimo->datos[bloque_fin(lista->ultimo)], datos, copiados * sizeof(void*));
+		lista->ultimo->cantidad = (unsigned short)(lista->ultimo->cantidad + copiados);
+	}
+	for (bloque_t* bloque = nuevos.primero; bloque; bloque = bloque->proximo) {
+		size_t n = cantidad - copiados < ELEMENTOS_POR_BLOQUE ? cantidad - copiados : ELEMENTOS_POR_BLOQUE;
+		memcpy(bloque->datos, &datos[copiados], n * sizeof(void*));
+		bloque->cantidad = (unsigned short)n;
+		copiados += n;
+	}
+	lista_bloque_extender(lista, &nuevos);
+	lista->tam += cantidad;
+	return true;
+}
+
+void lista_bloque_extender(lista_bloque_t* lista, lista_bloque_t* otra){
+	if (!otra->primero) {
+		return;
+	}
+	otra->primero->anterior = lista->ultimo;
+	if (lista->ultimo) {
+		lista->ultimo->proximo = otra->primero;
+	} else {
+		lista->primero = otra->primero;
+	}
+	lista->ultimo = otra->ultimo;
+	lista->tam += otra->tam;
+	otra->primero = NULL;
+	otra->ultimo = NULL;
+	otra->tam = 0;
+}
+
+void* lista_bloque_borrar_primero(lista_bloque_t* lista){
+	bloque_t* bloque = lista->primero;
+	if (!bloque) {
+		return NULL;
+	}
+	void* dato = bloque->datos[bloque->inicio];
+	bloque->inicio++;
+	bloque->cantidad--;
+	if (bloque->cantidad == 0) {
+		desenlazar(lista, bloque);
+	}
+	lista->tam--;
+	return dato;
+}
+
+void* lista_bloque_ver_primero(const lista_bloque_t* lista){
+	if (lista_bloque_esta_vacia(lista)){
+		return NULL;
+	}
+	return lista->primero->datos[lista->primero->inicio];
+}
+
+void* lista_bloque_ver_ultimo(const lista_bloque_t* lista){
+	if (lista_bloque_esta_vacia(lista)){
+		return NULL;
+	}
+	return lista->ultimo->datos[bloque_fin(lista->ultimo) - 1];
+}
+
+size_t lista_bloque_largo(const lista_bloque_t* lista){
+	return lista->tam;
+}
+
+void lista_bloque_destruir(lista_bloque_t* lista, void destruir_dato(void*)){
+	bloque_t* bloque = lista->primero;
+	while (bloque) {
+		bloque_t* proximo = bloque->proximo;
+		for (size_t i = bloque->inicio; destruir_dato && i < bloque_fin(bloque); i++) {
+			destruir_dato(bloque->datos[i]);
+		}
+		free(bloque);
+		bloque = proximo;
+	}
+	free(lista);
+}
+
+void lista_bloque_iterar(lista_bloque_t* lista, bool visitar(void*, void*), void* extra){
+	for (bloque_t* bloque = lista->primero; bloque; bloque = bloque->proximo) {
+		for (size_t i = bloque->inicio; i < bloque_fin(bloque); i++) {
+			if (!visitar(bloque->datos[i], extra)) {
+				return;
+			}
+		}
+	}
+}
+
+lista_bloque_iter_t* lista_bloque_iter_crear(lista_bloque_t* lista){
+	lista_bloque_iter_t* iter = malloc(sizeof(lista_bloque_iter_t));
+	if (iter != NULL){
+		iter->lista = lista;
+		iter->actual = lista->primero;
+		iter->pos = lista->primero ? lista->primero->inicio : 0;
+	}
+	return iter;
+}
+
+// Si pos quedó fuera de los datos del bloque actual pasa al siguiente bloque
+static void iter_acomodar(lista_bloque_iter_t* iter){
+	if (iter->actual && iter->pos >= bloque_fin(iter->actual)) {
+		iter->actual = iter->actual->proximo;
+		iter->pos = iter->actual ? iter->actual->inicio : 0;
+	}
+}
+
+bool lista_bloque_iter_avanzar(lista_bloque_iter_t* iter){
+	if (lista_bloque_iter_al_final(iter)) {
+		return false;
+	}
+	iter->pos++;
+	iter_acomodar(iter);
+	return true;
+}
+
+void* lista_bloque_iter_ver_actual(const lista_bloque_iter_t* iter){
+	if (lista_bloque_iter_al_final(iter)) {
+		return NULL;
+	}
+	return iter->actual->datos[iter->pos];
+}
+
+bool lista_bloque_iter_al_final(const lista_bloque_iter_t* iter){
+	return iter->actual == NULL;
+}
+
+void lista_bloque_iter_destruir(lista_bloque_iter_t* iter){
+	free(iter);
+}
+
+bool lista_bloque_iter_insertar(lista_bloque_iter_t* iter, void* dato){
+	if (lista_bloque_iter_al_final(iter)) {
+		if (!lista_bloque_insertar_ultimo(iter->lista, dato)) {
+			return false;
+		}
+		iter->actual = iter->lista->ultimo;
+		iter->pos = bloque_fin(iter->actual) - 1;
+		return true;
+	}
+	bloque_t* bloque = iter->actual;
+	if (bloque->cantidad == ELEMENTOS_POR_BLOQUE) {
+		// bloque lleno: la mitad de atrás pasa a un bloque nuevo
+		bloque_t* nuevo = bloque_crear(0);
+		if (!nuevo) {
+			return false;
+		}
+		size_t mitad = bloque->inicio + ELEMENTOS_POR_BLOQUE / 2;
+		nuevo->cantidad = (unsigned short)(bloque_fin(bloque) - mitad);
+		memcpy(nuevo->datos, &bloque->datos[mitad], nuevo->cantidad * sizeof(void*));
+		bloque->cantidad = (unsigned short)(bloque->cantidad - nuevo->cantidad);
+		enlazar_despues(iter->lista, bloque, nuevo);
+		if (iter->pos >= mitad) {
+			iter->actual = nuevo;
+			iter->pos -= mitad;
+		}
+	}
+	iter->pos = bloque_abrir_hueco(iter->actual, iter->pos);
+	iter->actual->datos[iter->pos] = dato;
+	iter->lista->tam++;
+	return true;
+}
+
+void* lista_bloque_iter_borrar(lista_bloque_iter_t* iter){
+	if (lista_bloque_iter_al_final(iter)) {
+		return NULL;
+	}
+	bloque_t* bloque = iter->actual;
+	void* dato = bloque->datos[iter->pos];
+	memmove(&bloque->datos[iter->pos], &bloque->datos[iter->pos + 1], (bloque_fin(bloque) - iter->pos - 1) * sizeof(void*));
+	bloque->cantidad--;
+	iter->lista->tam--;
+	if (bloque->cantidad == 0) {
+		iter->actual = bloque->proximo;
+		iter->pos = iter->actual ? iter->actual->inicio : 0;
+		desenlazar(iter->lista, bloque);
+	} else {
+		iter_acomodar(iter);
+	}
+	return dato;
+}
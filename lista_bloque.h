@@ -0,0 +1,100 @@
+#ifndef LISTA_BLOQUE_H
+#define LISTA_BLOQUE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Lista desenrollada: en lugar de un nodo por elemento guarda hasta
+ * ELEMENTOS_POR_BLOQUE datos contiguos en bloques alineados a línea de caché,
+ * así recorrerla o usarla como cola toca una fracción de los nodos que
+ * toca lista_t. Tiene las mismas primitivas que lista.h.
+ */
+
+struct lista_bloque;
+typedef struct lista_bloque lista_bloque_t;
+
+typedef struct lista_bloque_iter lista_bloque_iter_t;
+
+/* Primitivas de la Lista */
+
+// Crea una lista.
+// Post: devuelve una nueva lista vacía.
+lista_bloque_t* lista_bloque_crear(void);
+
+// Devuelve verdadero o falso, según si la lista tiene o no elementos.
+// Pre: la lista fue creada.
+bool lista_bloque_esta_vacia(const lista_bloque_t* lista);
+
+// Agrega un nuevo elemento al principio de la lista. Devuelve falso en caso de error.
+// Pre: la lista fue creada.
+bool lista_bloque_insertar_primero(lista_bloque_t* lista, void* dato);
+
+// Agrega un nuevo elemento al final de la lista. Devuelve falso en caso de error.
+// Pre: la lista fue creada.
+bool lista_bloque_insertar_ultimo(lista_bloque_t* lista, void* dato);
+
+// Agrega al final de la lista los cantidad datos del arreglo, en orden, llenando
+// bloques enteros de una vez. Devuelve falso en caso de error, y en ese caso
+// la lista queda como estaba.
+// Pre: la lista fue creada.
+bool lista_bloque_insertar_varios(lista_bloque_t* lista, void* datos[], size_t cantidad);
+
+// Mueve al final de la lista todos los elementos de otra, sin copiarlos.
+// Pre: ambas listas fueron creadas.
+// Post: otra queda vacía.
+void lista_bloque_extender(lista_bloque_t* lista, lista_bloque_t* otra);
+
+// Saca el primer elemento de la lista y devuelve su valor, o NULL si está vacía.
+// Pre: la lista fue creada.
+void* lista_bloque_borrar_primero(lista_bloque_t* lista);
+
+// Obtiene el valor del primer elemento de la lista, o NULL si está vacía.
+// Pre: la lista fue creada.
+void* lista_bloque_ver_primero(const lista_bloque_t* lista);
+
+// Obtiene el valor del ultimo elemento de la lista, o NULL si está vacía.
+// Pre: la lista fue creada.
+void* lista_bloque_ver_ultimo(const lista_bloque_t* lista);
+
+// Devuelve la cantidad de elementos
+// Pre: la lista fue creada.
+size_t lista_bloque_largo(const lista_bloque_t* lista);
+
+// Destruye la lista. Si se recibe la función destruir_dato por parámetro,
+// para cada uno de los elementos de la lista llama a destruir_dato.
+// Pre: la lista fue creada.
+void lista_bloque_destruir(lista_bloque_t* lista, void destruir_dato(void*));
+
+/* Primitivas del Iterador Interno */
+
+// Recorre la lista y le aplica la función visitar a cada uno de los elementos.
+// Si visitar devuelve false deja de recorrer la lista.
+// Pre: la lista fue creada.
+void lista_bloque_iterar(lista_bloque_t* lista, bool visitar(void*, void*), void* extra);
+
+/* Primitivas del Iterador externo */
+
+// Crea un iterador externo que apunta al primer elemento de la lista.
+lista_bloque_iter_t* lista_bloque_iter_crear(lista_bloque_t* lista);
+
+// Avanza al siguiente elemento. Devuelve false si ya estaba al final.
+bool lista_bloque_iter_avanzar(lista_bloque_iter_t* iter);
+
+// Devuelve el dato al que apunta el iterador, o NULL si está al final.
+void* lista_bloque_iter_ver_actual(const lista_bloque_iter_t* iter);
+
+// Indica si el iterador llegó al final.
+bool lista_bloque_iter_al_final(const lista_bloque_iter_t* iter);
+
+// Destruye el iterador.
+void lista_bloque_iter_destruir(lista_bloque_iter_t* iter);
+
+// Inserta un elemento en la posición del iterador; el iterador queda apuntando
+// al elemento nuevo. Devuelve false si no se pudo insertar.
+bool lista_bloque_iter_insertar(lista_bloque_iter_t* iter, void* dato);
+
+// Elimina el elemento al que apunta el iterador y lo devuelve; el iterador
+// queda apuntando al siguiente. Devuelve NULL si estaba al final.
+void* lista_bloque_iter_borrar(lista_bloque_iter_t* iter);
+
+#endif // LISTA_BLOQUE_H
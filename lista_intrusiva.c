@@ -0,0 +1,120 @@
+#include "lista_intrusiva.h"
+
+void lista_intrusiva_iniciar(lista_intrusiva_t* lista){
+	lista->primero = NULL;
+	lista->ultimo = NULL;
+	lista->tam = 0;
+}
+
+bool lista_intrusiva_esta_vacia(const lista_intrusiva_t* lista){
+	return lista->tam == 0;
+}
+
+// Engancha enlace antes de siguiente (al final si siguiente es NULL)
+static void enlazar_antes(lista_intrusiva_t* lista, lista_enlace_t* siguiente, lista_enlace_t* enlace){
+	enlace->proximo = siguiente;
+	enlace->anterior = siguiente ? siguiente->anterior : lista->ultimo;
+	if (enlace->anterior){
+		enlace->anterior->proximo = enlace;
+	} else {
+		lista->primero = enlace;
+	}
+	if (siguiente){
+		siguiente->anterior = enlace;
+	} else {
+		lista->ultimo = enlace;
+	}
+	lista->tam++;
+}
+
+void lista_intrusiva_insertar_primero(lista_intrusiva_t* lista, lista_enlace_t* enlace){
+	enlazar_antes(lista, lista->primero, enlace);
+}
+
+void lista_intrusiva_insertar_ultimo(lista_intrusiva_t* lista, lista_enlace_t* enlace){
+	enlazar_antes(lista, NULL, enlace);
+}
+
+void lista_intrusiva_borrar(lista_intrusiva_t* lista, lista_enlace_t* enlace){
+	if (enlace->anterior){
+		enlace->anterior->proximo = enlace->proximo;
+	} else {
+		lista->primero = enlace->proximo;
+	}
+	if (enlace->proximo){
+		enlace->proximo->anterior = enlace->anterior;
+	} else {
+		lista->ultimo = enlace->anterior;
+	}
+	enlace->anterior = NULL;
+	enlace->proximo = NULL;
+	lista->tam--;
+}
+
+lista_enlace_t* lista_intrusiva_borrar_primero(lista_intrusiva_t* lista){
+	lista_enlace_t* enlace = lista->primero;
+	if (enlace){
+		lista_intrusiva_borrar(lista, enlace);
+	}
+	return enlace;
+}
+
+lista_enlace_t* lista_intrusiva_ver_primero(const lista_intrusiva_t* lista){
+	return lista->primero;
+}
+
+lista_enlace_t* lista_intrusiva_ver_ultimo(const lista_intrusiva_t* lista){
+	return lista->ultimo;
+}
+
+size_t lista_intrusiva_largo(const lista_intrusiva_t* lista){
+	return lista->tam;
+}
+
+void lista_intrusiva_iterar(lista_intrusiva_t* lista, bool visitar(lista_enlace_t*, void*), void* extra){
+	lista_enlace_t* enlace = lista->primero;
+	while (enlace){
+		// se guarda el siguiente antes de visitar por si visitar lo saca de la lista
+		lista_enlace_t* proximo = enlace->proximo;
+		if (!visitar(enlace, extra)){
+			return;
+		}
+		enlace = proximo;
+	}
+}
+
+void lista_intrusiva_iter_iniciar(lista_intrusiva_iter_t* iter, lista_intrusiva_t* lista){
+	iter->lista = lista;
+	iter->actual = lista->primero;
+}
+
+bool lista_intrusiva_iter_avanzar(lista_intrusiva_iter_t* iter){
+	if (lista_intrusiva_iter_al_final(iter)){
+		return false;
+	}
+	iter->actual = iter->actual->proximo;
+	return true;
+}
+
+lista_enlace_t* lista_intrusiva_iter_ver_actual(const lista_intrusiva_iter_t* iter){
+	return iter->actual;
+}
+
+bool lista_intrusiva_iter_al_final(const lista_intrusiva_iter_t* iter){
+	return iter->actual == NULL;
+}
+
+void lista_intrusiva_iter_insertar(lista_intrusiva_iter_t* iter, lista_enlace_t* enlace){
+	enlazar_antes(iter->lista, iter->actual, enlace);
+	iter->actual = enlace;
+}
+
+lista_enlace_t* lista_intrusiva_iter_borrar(lista_intrusiva_iter_t* iter){
+	lista_enlace_t* enlace = iter->actual;
+	if (!enlace){
+		return NULL;
+	}
+	iter->actual = enlace->proximo;
+	lista_intrusiva_borrar(iter->lista, enlace);
+	return enlace;
+}
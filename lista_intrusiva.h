@@ -0,0 +1,114 @@
+#ifndef LISTA_INTRUSIVA_H
+#define LISTA_INTRUSIVA_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Lista doblemente enlazada intrusiva: en lugar de pedir un nodo por elemento,
+ * cada elemento lleva adentro un lista_enlace_t. Ninguna primitiva pide ni
+ * libera memoria, y un elemento se puede sacar en O(1) a partir de su enlace.
+ *
+ *    typedef struct persona {
+ *        const char* nombre;
+ *        lista_enlace_t enlace;
+ *    } persona_t;
+ *
+ *    lista_intrusiva_insertar_ultimo(&lista, &persona->enlace);
+ *    persona_t* primera = lista_contenedor(lista_intrusiva_ver_primero(&lista), persona_t, enlace);
+ *
+ * La lista no es dueña de los elementos: destruirlos es responsabilidad de
+ * quien los creó. Un enlace puede estar en una sola lista a la vez.
+ */
+
+typedef struct lista_enlace {
+	struct lista_enlace* anterior;
+	struct lista_enlace* proximo;
+} lista_enlace_t;
+
+// Los campos son públicos sólo para que la lista pueda vivir dentro de otro
+// struct o en un arreglo; no deben modificarse directamente.
+typedef struct lista_intrusiva {
+	lista_enlace_t* primero;
+	lista_enlace_t* ultimo;
+	size_t tam;
+} lista_intrusiva_t;
+
+typedef struct lista_intrusiva_iter {
+	lista_intrusiva_t* lista;
+	lista_enlace_t* actual;
+} lista_intrusiva_iter_t;
+
+// Devuelve el struct de tipo tipo que contiene al enlace en el campo campo.
+#define lista_contenedor(enlace, tipo, campo) \
+	((tipo*)((char*)(enlace) - offsetof(tipo, campo)))
+
+/* Primitivas de la Lista */
+
+// Inicializa una lista vacía. Una lista llena de ceros también está vacía.
+// Post: la lista está vacía.
+void lista_intrusiva_iniciar(lista_intrusiva_t* lista);
+
+// Devuelve verdadero o falso, según si la lista tiene o no elementos.
+// Pre: la lista fue iniciada.
+bool lista_intrusiva_esta_vacia(const lista_intrusiva_t* lista);
+
+// Agrega el elemento del enlace al principio de la lista.
+// Pre: la lista fue iniciada y el enlace no está en ninguna lista.
+void lista_intrusiva_insertar_primero(lista_intrusiva_t* lista, lista_enlace_t* enlace);
+
+// Agrega el elemento del enlace al final de la lista.
+// Pre: la lista fue iniciada y el enlace no está en ninguna lista.
+void lista_intrusiva_insertar_ultimo(lista_intrusiva_t* lista, lista_enlace_t* enlace);
+
+// Saca el primer elemento de la lista y devuelve su enlace, o NULL si está vacía.
+// Pre: la lista fue iniciada.
+lista_enlace_t* lista_intrusiva_borrar_primero(lista_intrusiva_t* lista);
+
+// Saca de la lista el elemento del enlace, en O(1).
+// Pre: el enlace está en la lista.
+void lista_intrusiva_borrar(lista_intrusiva_t* lista, lista_enlace_t* enlace);
+
+// Devuelve el enlace del primer elemento, o NULL si la lista está vacía.
+// Pre: la lista fue iniciada.
+lista_enlace_t* lista_intrusiva_ver_primero(const lista_intrusiva_t* lista);
+
+// Devuelve el enlace del último elemento, o NULL si la lista está vacía.
+// Pre: la lista fue iniciada.
+lista_enlace_t* lista_intrusiva_ver_ultimo(const lista_intrusiva_t* lista);
+
+// Devuelve la cantidad de elementos
+// Pre: la lista fue iniciada.
+size_t lista_intrusiva_largo(const lista_intrusiva_t* lista);
+
+/* Primitivas del Iterador Interno */
+
+// Aplica visitar a cada enlace de la lista hasta que devuelva false. visitar
+// puede sacar de la lista el enlace que recibe.
+// Pre: la lista fue iniciada.
+void lista_intrusiva_iterar(lista_intrusiva_t* lista, bool visitar(lista_enlace_t*, void*), void* extra);
+
+/* Primitivas del Iterador externo. El iterador no pide memoria: se declara
+ * en la pila y se inicia con lista_intrusiva_iter_iniciar. */
+
+// Deja al iterador apuntando al primer elemento de la lista.
+void lista_intrusiva_iter_iniciar(lista_intrusiva_iter_t* iter, lista_intrusiva_t* lista);
+
+// Avanza al siguiente elemento. Devuelve false si ya estaba al final.
+bool lista_intrusiva_iter_avanzar(lista_intrusiva_iter_t* iter);
+
+// Devuelve el enlace actual, o NULL si el iterador está al final.
+lista_enlace_t* lista_intrusiva_iter_ver_actual(const lista_intrusiva_iter_t* iter);
+
+// Indica si el iterador llegó al final.
+bool lista_intrusiva_iter_al_final(const lista_intrusiva_iter_t* iter);
+
+// Inserta el elemento del enlace en la posición del iterador; el iterador
+// queda apuntando al elemento nuevo.
+// Pre: el enlace no está en ninguna lista.
+void lista_intrusiva_iter_insertar(lista_intrusiva_iter_t* iter, lista_enlace_t* enlace);
+
+// Saca el elemento actual de la lista y devuelve su enlace; el iterador queda
+// apuntando al siguiente. Devuelve NULL si estaba al final.
+lista_enlace_t* lista_intrusiva_iter_borrar(lista_intrusiva_iter_t* iter);
+
+#endif // LISTA_INTRUSIVA_H
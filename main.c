@@ -1,6 +1,7 @@
 #include "testing.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 /* ******************************************************************
  *                        PROGRAMA PRINCIPAL
@@ -8,9 +9,19 @@
 
 void pruebas_hash_catedra(void);
 void pruebas_volumen_catedra(size_t);
+void pruebas_hash_alumno(void);
+void pruebas_perfil(size_t);
 
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && strcmp(argv[1], "--perfil") == 0) {
+        // Contadores de hardware por fase: ./pruebas --perfil [largo]
+        long largo = argc > 2 ? strtol(argv[2], NULL, 10) : 1000000;
+        pruebas_perfil((size_t) largo);
+
+        return 0;
+    }
+
     if (argc > 1) {
         // Asumimos que nos están pidiendo pruebas de volumen.
         long largo = strtol(argv[1], NULL, 10);
@@ -22,5 +33,8 @@ int main(int argc, char *argv[])
     printf("~~~ PRUEBAS CÁTEDRA ~~~\n");
     pruebas_hash_catedra();
 
+    printf("~~~ PRUEBAS ALUMNO ~~~\n");
+    pruebas_hash_alumno();
+
     return failure_count() > 0;
 }
@@ -0,0 +1,138 @@
+#define _DEFAULT_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "paginas_grandes.h"
+
+#define TAM_PAGINA_GRANDE ((size_t)2 << 20)
+
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+// El asignador va primero: el puntero que recibe el usuario es el de la estructura
+typedef struct paginas_grandes {
+	hash_asignador_t asignador;
+	char* ruta;
+	size_t umbral;
+} paginas_grandes_t;
+
+static size_t redondear(size_t tam) {
+	return (tam + TAM_PAGINA_GRANDE - 1) & ~(TAM_PAGINA_GRANDE - 1);
+}
+
+
+/* ******************************************************************
+ *                    MAPEOS
+ * *****************************************************************/
+
+/* mmap sólo garantiza alineación de página chica: se pide una página
+ * grande de más y se recortan las puntas, así el kernel puede usar una
+ * página grande desde el primer byte.
+ */
+static void* mapear_anonimo(size_t largo) {
+	size_t pedido = largo + TAM_PAGINA_GRANDE;
+	char* base = mmap(NULL, pedido, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (base == MAP_FAILED) {
+		return NULL;
+	}
+	char* inicio = (char*)(((uintptr_t)base + TAM_PAGINA_GRANDE - 1) & ~(uintptr_t)(TAM_PAGINA_GRANDE - 1));
+	if (inicio > base) {
+		munmap(base, inicio - base);
+	}
+	size_t sobra = (base + pedido) - (inicio + largo);
+	if (sobra > 0) {
+		munmap(inicio + largo, sobra);
+	}
+#ifdef MADV_HUGEPAGE
+	madvise(inicio, largo, MADV_HUGEPAGE);
+#endif
+	return inicio;
+}
+
+static void* mapear_hugetlbfs(const char* ruta, size_t largo) {
+	char* nombre = malloc(strlen(ruta) + sizeof("/hashXXXXXX"));
+	if (!nombre) {
+		return NULL;
+	}
+	sprintf(nombre, "%s/hashXXXXXX", ruta);
+	int fd = mkstemp(nombre);
+	if (fd < 0) {
+		free(nombre);
+		return NULL;
+	}
+	// la memoria sigue viva mientras esté mapeada aunque el archivo no tenga nombre
+	unlink(nombre);
+	free(nombre);
+	void* memoria = MAP_FAILED;
+	if (ftruncate(fd, (off_t)largo) == 0) {
+		memoria = mmap(NULL, largo, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+	close(fd);
+	return memoria == MAP_FAILED ? NULL : memoria;
+}
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL ASIGNADOR
+ * *****************************************************************/
+
+// Si el tamaño decide de dónde sale la memoria, liberar sabe a dónde devolverla
+static void* paginas_pedir(size_t tam, size_t alineacion, void* contexto) {
+	paginas_grandes_t* paginas = contexto;
+	if (tam < TAM_PAGINA_GRANDE) {
+		void* memoria;
+		if (alineacion < sizeof(void*)) {
+			alineacion = sizeof(void*);
+		}
+		return posix_memalign(&memoria, alineacion, tam) == 0 ? memoria : NULL;
+	}
+	size_t largo = redondear(tam);
+	if (paginas->ruta && tam >= paginas->umbral) {
+		void* memoria = mapear_hugetlbfs(paginas->ruta, largo);
+		if (memoria) {
+			return memoria;
+		}
+	}
+	return mapear_anonimo(largo);
+}
+
+static void paginas_liberar(void* memoria, size_t tam, void* contexto) {
+	(void)contexto;
+	if (tam < TAM_PAGINA_GRANDE) {
+		free(memoria);
+	} else {
+		munmap(memoria, redondear(tam));
+	}
+}
+
+hash_asignador_t *paginas_grandes_crear(const char *ruta_hugetlbfs, size_t umbral) {
+	paginas_grandes_t* paginas = malloc(sizeof(paginas_grandes_t));
+	if (!paginas) {
+		return NULL;
+	}
+	paginas->ruta = NULL;
+	if (ruta_hugetlbfs) {
+		paginas->ruta = malloc(strlen(ruta_hugetlbfs) + 1);
+		if (!paginas->ruta) {
+			free(paginas);
+			return NULL;
+		}
+		strcpy(paginas->ruta, ruta_hugetlbfs);
+	}
+	paginas->umbral = umbral;
+	paginas->asignador.pedir = paginas_pedir;
+	paginas->asignador.liberar = paginas_liberar;
+	paginas->asignador.contexto = paginas;
+	return &paginas->asignador;
+}
+
+void paginas_grandes_destruir(hash_asignador_t *asignador) {
+	paginas_grandes_t* paginas = asignador->contexto;
+	free(paginas->ruta);
+	free(paginas);
+}
@@ -0,0 +1,30 @@
+#ifndef PAGINAS_GRANDES_H
+#define PAGINAS_GRANDES_H
+
+#include <stddef.h>
+#include "hash.h"
+
+/* Asignador para hash_crear_con_asignador que pone los pedidos de al menos
+ * 2 MB (en la práctica, la tabla de baldes) en páginas grandes, para que
+ * recorrer una tabla enorme no se pase la vida fallando en la TLB. Los
+ * pedidos chicos (nodos, claves, bloques de desborde) van a malloc.
+ *
+ * Por defecto la memoria grande es anónima, alineada a 2 MB y marcada con
+ * madvise(MADV_HUGEPAGE) para que el kernel la respalde con páginas
+ * grandes transparentes. Si se da una ruta de hugetlbfs, los pedidos desde
+ * umbral bytes salen de un archivo ahí (sin nombre: se borra apenas se
+ * mapea), que garantiza páginas grandes reservadas; si no se puede, se
+ * vuelve a la memoria anónima.
+ */
+
+/* Crea el asignador. ruta_hugetlbfs puede ser NULL.
+ * Post: devuelve el asignador, o NULL si no hubo memoria.
+ */
+hash_asignador_t *paginas_grandes_crear(const char *ruta_hugetlbfs, size_t umbral);
+
+/* Destruye el asignador.
+ * Pre: ningún hash creado con él sigue vivo.
+ */
+void paginas_grandes_destruir(hash_asignador_t *asignador);
+
+#endif // PAGINAS_GRANDES_H
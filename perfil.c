@@ -0,0 +1,322 @@
+#define _DEFAULT_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+#include "hash.h"
+#include "perfil.h"
+
+#define MAX_REDIMENSIONES 256
+#define CUBETAS_HISTOGRAMA 40 // potencias de 2 de nanosegundos
+#define ANCHO_BARRA 40
+
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+struct perfil {
+	int fd[PERFIL_CONTADORES]; // -1 si no está disponible
+};
+
+static const char* NOMBRES[PERFIL_CONTADORES] = {
+	"ciclos", "instr", "L1d", "LLC", "dTLB", "saltos",
+};
+
+
+/* ******************************************************************
+ *                    CONTADORES
+ * *****************************************************************/
+
+static uint64_t ahora(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+#ifdef __linux__
+// Fallos de lectura de una cache, en el formato de PERF_TYPE_HW_CACHE
+static uint64_t fallos_de(uint64_t cache) {
+	return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+static int abrir_contador(perfil_contador_t contador) {
+	struct perf_event_attr atributos;
+	memset(&atributos, 0, sizeof(atributos));
+	atributos.size = sizeof(atributos);
+	switch (contador) {
+	case PERFIL_CICLOS:
+		atributos.type = PERF_TYPE_HARDWARE;
+		atributos.config = PERF_COUNT_HW_CPU_CYCLES;
+		break;
+	case PERFIL_INSTRUCCIONES:
+		atributos.type = PERF_TYPE_HARDWARE;
+		atributos.config = PERF_COUNT_HW_INSTRUCTIONS;
+		break;
+	case PERFIL_FALLOS_L1D:
+		atributos.type = PERF_TYPE_HW_CACHE;
+		atributos.config = fallos_de(PERF_COUNT_HW_CACHE_L1D);
+		break;
+	case PERFIL_FALLOS_LLC:
+		atributos.type = PERF_TYPE_HW_CACHE;
+		atributos.config = fallos_de(PERF_COUNT_HW_CACHE_LL);
+		break;
+	case PERFIL_FALLOS_DTLB:
+		atributos.type = PERF_TYPE_HW_CACHE;
+		atributos.config = fallos_de(PERF_COUNT_HW_CACHE_DTLB);
+		break;
+	default:
+		atributos.type = PERF_TYPE_HARDWARE;
+		atributos.config = PERF_COUNT_HW_BRANCH_MISSES;
+		break;
+	}
+	// sin el kernel alcanza con perf_event_paranoid <= 2, el valor por defecto
+	atributos.exclude_kernel = 1;
+	atributos.exclude_hv = 1;
+	atributos.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	return (int)syscall(SYS_perf_event_open, &atributos, 0, -1, -1, 0);
+}
+#else
+static int abrir_contador(perfil_contador_t contador) {
+	(void)contador;
+	return -1;
+}
+#endif
+
+perfil_t *perfil_crear(void) {
+	perfil_t* perfil = malloc(sizeof(perfil_t));
+	if (!perfil) {
+		return NULL;
+	}
+	for (int i = 0; i < PERFIL_CONTADORES; i++) {
+		perfil->fd[i] = abrir_contador((perfil_contador_t)i);
+	}
+	return perfil;
+}
+
+bool perfil_disponible(const perfil_t *perfil, perfil_contador_t contador) {
+	return perfil->fd[contador] >= 0;
+}
+
+const char *perfil_nombre(perfil_contador_t contador) {
+	return NOMBRES[contador];
+}
+
+void perfil_leer(const perfil_t *perfil, perfil_lectura_t *lectura) {
+	for (int i = 0; i < PERFIL_CONTADORES; i++) {
+		uint64_t leido[3] = {0, 0, 0};
+		if (perfil->fd[i] >= 0 && read(perfil->fd[i], leido, sizeof(leido)) != (ssize_t)sizeof(leido)) {
+			memset(leido, 0, sizeof(leido));
+		}
+		lectura->valor[i] = leido[0];
+		lectura->habilitado[i] = leido[1];
+		lectura->corriendo[i] = leido[2];
+	}
+	lectura->nanosegundos = ahora();
+}
+
+double perfil_diferencia(const perfil_lectura_t *desde, const perfil_lectura_t *hasta, perfil_contador_t contador) {
+	uint64_t corriendo = hasta->corriendo[contador] - desde->corriendo[contador];
+	if (corriendo == 0) {
+		return -1;
+	}
+	double habilitado = (double)(hasta->habilitado[contador] - desde->habilitado[contador]);
+	return (double)(hasta->valor[contador] - desde->valor[contador]) * habilitado / (double)corriendo;
+}
+
+void perfil_destruir(perfil_t *perfil) {
+	for (int i = 0; i < PERFIL_CONTADORES; i++) {
+		if (perfil->fd[i] >= 0) {
+			close(perfil->fd[i]);
+		}
+	}
+	free(perfil);
+}
+
+
+/* ******************************************************************
+ *                    PERFIL DEL HASH
+ * *****************************************************************/
+
+typedef struct redimension {
+	size_t vieja;
+	size_t nueva;
+	perfil_lectura_t antes;
+	perfil_lectura_t despues;
+} redimension_t;
+
+typedef struct redimensiones {
+	const perfil_t* perfil;
+	redimension_t medidas[MAX_REDIMENSIONES];
+	size_t cantidad;
+	size_t perdidas; // las que no entraron en medidas
+} redimensiones_t;
+
+static void imprimir_encabezado(const char* primera, const char* unidad) {
+	printf("%-16s %10s", primera, unidad);
+	for (int i = 0; i < PERFIL_CONTADORES; i++) {
+		printf(" %10s", perfil_nombre((perfil_contador_t)i));
+	}
+	printf("\n");
+}
+
+static void imprimir_fila(const char* nombre, const perfil_lectura_t* antes, const perfil_lectura_t* despues, size_t operaciones) {
+	double ops = operaciones ? (double)operaciones : 1;
+	printf("%-16s %10.1f", nombre, (double)(despues->nanosegundos - antes->nanosegundos) / ops);
+	for (int i = 0; i < PERFIL_CONTADORES; i++) {
+		double cuenta = perfil_diferencia(antes, despues, (perfil_contador_t)i);
+		if (cuenta < 0) {
+			printf(" %10s", "-");
+		} else {
+			printf(" %10.3f", cuenta / ops);
+		}
+	}
+	printf("\n");
+}
+
+#ifdef HASH_PERFIL
+static void anotar_redimension(size_t vieja, size_t nueva, bool termino, void* extra) {
+	redimensiones_t* redimensiones = extra;
+	if (redimensiones->cantidad == MAX_REDIMENSIONES) {
+		redimensiones->perdidas += termino;
+		return;
+	}
+	redimension_t* medida = &redimensiones->medidas[redimensiones->cantidad];
+	if (!termino) {
+		medida->vieja = vieja;
+		medida->nueva = nueva;
+		perfil_leer(redimensiones->perfil, &medida->antes);
+		return;
+	}
+	perfil_leer(redimensiones->perfil, &medida->despues);
+	redimensiones->cantidad++;
+}
+
+// Una fila por redimensión, con sus totales, y el histograma de sus tiempos
+static void imprimir_redimensiones(const redimensiones_t* redimensiones) {
+	printf("\n");
+	imprimir_encabezado("redimension", "ns");
+	size_t cubetas[CUBETAS_HISTOGRAMA] = {0};
+	size_t mayor = 0;
+	for (size_t i = 0; i < redimensiones->cantidad; i++) {
+		const redimension_t* medida = &redimensiones->medidas[i];
+		char nombre[48];
+		snprintf(nombre, sizeof(nombre), "%zu->%zu", medida->vieja, medida->nueva);
+		imprimir_fila(nombre, &medida->antes, &medida->despues, 1);
+		uint64_t ns = medida->despues.nanosegundos - medida->antes.nanosegundos;
+		size_t cubeta = 0;
+		while (cubeta + 1 < CUBETAS_HISTOGRAMA && ns >= ((uint64_t)2 << cubeta)) {
+			cubeta++;
+		}
+		cubetas[cubeta]++;
+		mayor = cubetas[cubeta] > mayor ? cubetas[cubeta] : mayor;
+	}
+	if (redimensiones->perdidas) {
+		printf("(%zu redimensiones sin medir)\n", redimensiones->perdidas);
+	}
+	printf("\nduracion de las redimensiones\n");
+	for (size_t i = 0; i < CUBETAS_HISTOGRAMA; i++) {
+		if (!cubetas[i]) {
+			continue;
+		}
+		char barra[ANCHO_BARRA + 1];
+		size_t largo = (cubetas[i] * ANCHO_BARRA + mayor - 1) / mayor;
+		memset(barra, '#', largo);
+		barra[largo] = '\0';
+		printf(">= %12llu ns %6zu %s\n", (unsigned long long)1 << i, cubetas[i], barra);
+	}
+}
+#endif
+
+/* Modo de perfil de main: corre cada fase sobre largo claves y muestra,
+ * por operación, el tiempo y los contadores de hardware. Las redimensiones
+ * se miden una por una si se compiló con -DHASH_PERFIL.
+ */
+void pruebas_perfil(size_t largo) {
+	perfil_t* perfil = perfil_crear();
+	char* textos = malloc(largo * 24 + 1);
+	const char** claves = malloc((largo + 1) * sizeof(char*));
+	redimensiones_t* redimensiones = calloc(1, sizeof(redimensiones_t));
+	hash_t* hash = hash_crear(NULL);
+	if (!perfil || !textos || !claves || !redimensiones || !hash) {
+		fprintf(stderr, "no hay memoria para el perfil\n");
+		free(textos);
+		free(claves);
+		free(redimensiones);
+		if (perfil) perfil_destruir(perfil);
+		if (hash) hash_destruir(hash);
+		return;
+	}
+	for (size_t i = 0; i < largo; i++) {
+		claves[i] = textos + i * 24;
+		snprintf(textos + i * 24, 24, "%08zu", i);
+	}
+	redimensiones->perfil = perfil;
+#ifdef HASH_PERFIL
+	hash_perfil_redimensiones(anotar_redimension, redimensiones);
+#endif
+
+	printf("%zu claves\n", largo);
+	for (int i = 0; i < PERFIL_CONTADORES; i++) {
+		if (!perfil_disponible(perfil, (perfil_contador_t)i)) {
+			printf("(contador %s no disponible)\n", perfil_nombre((perfil_contador_t)i));
+		}
+	}
+	imprimir_encabezado("fase", "ns/op");
+	perfil_lectura_t antes, despues;
+	// los datos no son NULL, así el compilador no puede descartar las búsquedas
+	size_t encontradas = 0;
+
+	perfil_leer(perfil, &antes);
+	for (size_t i = 0; i < largo; i++) {
+		hash_guardar(hash, claves[i], (void*)claves[i]);
+	}
+	perfil_leer(perfil, &despues);
+	imprimir_fila("guardar", &antes, &despues, largo);
+
+	perfil_leer(perfil, &antes);
+	for (size_t i = 0; i < largo; i++) {
+		encontradas += hash_obtener(hash, claves[i]) != NULL;
+	}
+	perfil_leer(perfil, &despues);
+	imprimir_fila("obtener", &antes, &despues, largo);
+
+	size_t recorridas = 0;
+	perfil_leer(perfil, &antes);
+	hash_iter_t* iter = hash_iter_crear(hash);
+	for (; iter && !hash_iter_al_final(iter); hash_iter_avanzar(iter)) {
+		recorridas += hash_iter_ver_actual(iter) != NULL;
+	}
+	perfil_leer(perfil, &despues);
+	if (iter) hash_iter_destruir(iter);
+	imprimir_fila("iterar", &antes, &despues, largo);
+
+	perfil_leer(perfil, &antes);
+	for (size_t i = 0; i < largo; i++) {
+		encontradas += hash_borrar(hash, claves[i]) != NULL;
+	}
+	perfil_leer(perfil, &despues);
+	imprimir_fila("borrar", &antes, &despues, largo);
+
+#ifdef HASH_PERFIL
+	hash_perfil_redimensiones(NULL, NULL);
+	imprimir_redimensiones(redimensiones);
+#else
+	printf("\n(compilar con -DHASH_PERFIL para medir cada redimension)\n");
+#endif
+	if (encontradas != 2 * largo || recorridas != largo) {
+		printf("ERROR: el hash perdio claves\n");
+	}
+
+	hash_destruir(hash);
+	free(redimensiones);
+	free(claves);
+	free(textos);
+	perfil_destruir(perfil);
+}
@@ -0,0 +1,61 @@
+#ifndef PERFIL_H
+#define PERFIL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Contadores de hardware del hilo actual (perf_event_open de Linux), sólo
+ * en modo usuario. Cada contador se abre por separado: si el procesador no
+ * tiene lugar para todos a la vez, el kernel los turna y perfil_diferencia
+ * extrapola la cuenta al tiempo total. Los que no se pueden abrir (otro
+ * sistema, una máquina virtual sin PMU o perf_event_paranoid muy alto)
+ * quedan como no disponibles y el resto sigue andando.
+ */
+
+typedef enum perfil_contador {
+	PERFIL_CICLOS,
+	PERFIL_INSTRUCCIONES,
+	PERFIL_FALLOS_L1D,
+	PERFIL_FALLOS_LLC,
+	PERFIL_FALLOS_DTLB,
+	PERFIL_FALLOS_SALTO,
+	PERFIL_CONTADORES
+} perfil_contador_t;
+
+struct perfil;
+
+typedef struct perfil perfil_t;
+
+// Lo acumulado por los contadores hasta un momento dado.
+typedef struct perfil_lectura {
+	uint64_t valor[PERFIL_CONTADORES];
+	uint64_t habilitado[PERFIL_CONTADORES]; // ns que el contador estuvo pedido
+	uint64_t corriendo[PERFIL_CONTADORES];  // ns que estuvo en el hardware
+	uint64_t nanosegundos;                  // reloj monótono
+} perfil_lectura_t;
+
+/* Abre y arranca los contadores. Devuelve NULL sólo si no hubo memoria.
+ */
+perfil_t *perfil_crear(void);
+
+// Determina si el contador se pudo abrir.
+bool perfil_disponible(const perfil_t *perfil, perfil_contador_t contador);
+
+// Devuelve un nombre corto para el contador.
+const char *perfil_nombre(perfil_contador_t contador);
+
+/* Lee todos los contadores y el reloj. Las lecturas no reinician nada, así
+ * que se pueden anidar mediciones.
+ */
+void perfil_leer(const perfil_t *perfil, perfil_lectura_t *lectura);
+
+/* Devuelve cuánto contó contador entre las dos lecturas, corregido por el
+ * tiempo que estuvo fuera del hardware, o -1 si no está disponible o no
+ * llegó a correr.
+ */
+double perfil_diferencia(const perfil_lectura_t *desde, const perfil_lectura_t *hasta, perfil_contador_t contador);
+
+// Cierra los contadores.
+void perfil_destruir(perfil_t *perfil);
+
+#endif // PERFIL_H
@@ -0,0 +1,1946 @@
+#include "hash.h"
+#include "hash_version.h"
+#include "hash_durable.h"
+#include "hash_buffer.h"
+#include "hash_cuco.h"
+#include "hash_compacto.h"
+#include "hash_asincrono.h"
+#include "epoca.h"
+#include "hash_internador.h"
+#include "paginas_grandes.h"
+#include "hamt.h"
+#include "cola_concurrente.h"
+#include "lista.h"
+#include "lista_bloque.h"
+#include "lista_intrusiva.h"
+#include "testing.h"
+
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/* ******************************************************************
+ *                        PRUEBAS UNITARIAS
+ * *****************************************************************/
+
+static void prueba_hash_versionado()
+{
+    hash_versionado_t* hash = hash_versionado_crear(NULL);
+    char *clave1 = "perro", *valor1a = "guau", *valor1b = "warf";
+    char *clave2 = "gato", *valor2 = "miau";
+
+    const hash_version_t* vacia = hash_version_adquirir(hash);
+    print_test("Prueba hash versionado la version inicial esta vacia", hash_version_cantidad(vacia) == 0);
+
+    print_test("Prueba hash versionado guardar clave1", hash_versionado_guardar(hash, clave1, valor1a));
+    print_test("Prueba hash versionado guardar clave2", hash_versionado_guardar(hash, clave2, valor2));
+    const hash_version_t* sin_publicar = hash_version_adquirir(hash);
+    print_test("Prueba hash versionado sin publicar no se ven los cambios", !hash_version_pertenece(sin_publicar, clave1));
+    hash_version_liberar(sin_publicar);
+
+    hash_versionado_publicar(hash);
+    const hash_version_t* v1 = hash_version_adquirir(hash);
+    print_test("Prueba hash versionado la version publicada tiene 2 elementos", hash_version_cantidad(v1) == 2);
+    print_test("Prueba hash versionado obtener clave1 es valor1a", hash_version_obtener(v1, clave1) == valor1a);
+
+    print_test("Prueba hash versionado reemplazar clave1", hash_versionado_guardar(hash, clave1, valor1b));
+    print_test("Prueba hash versionado borrar clave2", hash_versionado_borrar(hash, clave2));
+    print_test("Prueba hash versionado borrar clave2 de nuevo es false", !hash_versionado_borrar(hash, clave2));
+    hash_versionado_publicar(hash);
+    const hash_version_t* v2 = hash_version_adquirir(hash);
+
+    print_test("Prueba hash versionado la version vieja no cambia", hash_version_obtener(v1, clave1) == valor1a);
+    print_test("Prueba hash versionado la version vieja conserva clave2", hash_version_pertenece(v1, clave2));
+    print_test("Prueba hash versionado la version nueva tiene valor1b", hash_version_obtener(v2, clave1) == valor1b);
+    print_test("Prueba hash versionado la version nueva no tiene clave2", !hash_version_pertenece(v2, clave2));
+    print_test("Prueba hash versionado la version vacia sigue vacia", hash_version_cantidad(vacia) == 0);
+
+    hash_version_iter_t* iter = hash_version_iter_crear(v1);
+    size_t recorridos = 0;
+    while (!hash_version_iter_al_final(iter)) {
+        recorridos++;
+        hash_version_iter_avanzar(iter);
+    }
+    print_test("Prueba hash versionado iterar la version vieja recorre 2 claves", recorridos == 2);
+    hash_version_iter_destruir(iter);
+
+    hash_version_liberar(vacia);
+    hash_version_liberar(v1);
+    hash_versionado_destruir(hash);
+    // la version sigue siendo valida despues de destruir el hash versionado
+    print_test("Prueba hash versionado la version sobrevive al escritor", hash_version_obtener(v2, clave1) == valor1b);
+    hash_version_liberar(v2);
+}
+
+static void prueba_hash_versionado_volumen(size_t largo)
+{
+    hash_versionado_t* hash = hash_versionado_crear(free);
+    char clave[10];
+
+    bool ok = true;
+    for (unsigned i = 0; i < largo && ok; i++) {
+        sprintf(clave, "%08d", i);
+        unsigned* valor = malloc(sizeof(unsigned));
+        *valor = i;
+        ok = hash_versionado_guardar(hash, clave, valor);
+        if (i % 100 == 0) hash_versionado_publicar(hash);
+    }
+    hash_versionado_publicar(hash);
+    print_test("Prueba hash versionado guardar muchos elementos", ok);
+
+    const hash_version_t* version = hash_version_adquirir(hash);
+    for (unsigned i = 0; i < largo && ok; i++) {
+        sprintf(clave, "%08d", i);
+        unsigned* valor = hash_version_obtener(version, clave);
+        ok = valor && *valor == i;
+    }
+    print_test("Prueba hash versionado obtener muchos elementos", ok);
+
+    for (unsigned i = 0; i < largo && ok; i++) {
+        sprintf(clave, "%08d", i);
+        ok = hash_versionado_borrar(hash, clave);
+    }
+    hash_versionado_publicar(hash);
+    print_test("Prueba hash versionado borrar muchos elementos", ok);
+    print_test("Prueba hash versionado la version adquirida conserva todo", hash_version_cantidad(version) == largo);
+    hash_version_liberar(version);
+
+    version = hash_version_adquirir(hash);
+    print_test("Prueba hash versionado la ultima version esta vacia", hash_version_cantidad(version) == 0);
+    hash_version_liberar(version);
+    hash_versionado_destruir(hash);
+}
+
+static void prueba_hamt_clonar()
+{
+    hamt_t* hamt = hamt_crear(NULL);
+    char *clave1 = "perro", *valor1a = "guau", *valor1b = "warf";
+    char *clave2 = "gato", *valor2 = "miau";
+    char *clave3 = "vaca", *valor3 = "mu";
+
+    print_test("Prueba hamt insertar clave1", hamt_guardar(hamt, clave1, valor1a));
+    print_test("Prueba hamt insertar clave2", hamt_guardar(hamt, clave2, valor2));
+    hamt_t* clon = hamt_clonar(hamt);
+    print_test("Prueba hamt clonar", clon && hamt_cantidad(clon) == 2);
+
+    print_test("Prueba hamt reemplazar clave1 en el original", hamt_guardar(hamt, clave1, valor1b));
+    print_test("Prueba hamt borrar clave2 del original", hamt_borrar(hamt, clave2) == valor2);
+    print_test("Prueba hamt insertar clave3 en el clon", hamt_guardar(clon, clave3, valor3));
+
+    print_test("Prueba hamt el original tiene valor1b", hamt_obtener(hamt, clave1) == valor1b);
+    print_test("Prueba hamt el original no tiene clave2", !hamt_pertenece(hamt, clave2));
+    print_test("Prueba hamt el original no tiene clave3", !hamt_pertenece(hamt, clave3));
+    print_test("Prueba hamt el original tiene 1 elemento", hamt_cantidad(hamt) == 1);
+    print_test("Prueba hamt el clon conserva valor1a", hamt_obtener(clon, clave1) == valor1a);
+    print_test("Prueba hamt el clon conserva clave2", hamt_obtener(clon, clave2) == valor2);
+    print_test("Prueba hamt el clon tiene 3 elementos", hamt_cantidad(clon) == 3);
+
+    hamt_destruir(hamt);
+    print_test("Prueba hamt el clon sobrevive al original", hamt_obtener(clon, clave1) == valor1a);
+    hamt_destruir(clon);
+}
+
+static void prueba_hamt_volumen(size_t largo)
+{
+    hamt_t* hamt = hamt_crear(free);
+    char clave[10];
+
+    bool ok = true;
+    for (unsigned i = 0; i < largo && ok; i++) {
+        sprintf(clave, "%08d", i);
+        unsigned* valor = malloc(sizeof(unsigned));
+        *valor = i;
+        ok = hamt_guardar(hamt, clave, valor);
+    }
+    print_test("Prueba hamt almacenar muchos elementos", ok);
+    print_test("Prueba hamt la cantidad de elementos es correcta", hamt_cantidad(hamt) == largo);
+
+    hamt_t* clon = hamt_clonar(hamt);
+    for (unsigned i = 0; i < largo && ok; i += 2) {
+        sprintf(clave, "%08d", i);
+        ok = hamt_borrar(clon, clave) != NULL;
+    }
+    print_test("Prueba hamt borrar la mitad en el clon", ok && hamt_cantidad(clon) == largo / 2);
+
+    size_t recorridos = 0;
+    hamt_iter_t* iter = hamt_iter_crear(hamt);
+    while (!hamt_iter_al_final(iter) && ok) {
+        unsigned* valor = hamt_obtener(hamt, hamt_iter_ver_actual(iter));
+        ok = valor != NULL;
+        recorridos++;
+        hamt_iter_avanzar(iter);
+    }
+    hamt_iter_destruir(iter);
+    print_test("Prueba hamt iterar el original recorre todo", ok && recorridos == largo);
+
+    hamt_destruir(clon);
+    hamt_destruir(hamt);
+}
+
+static bool sumar(void* dato, void* extra)
+{
+    *(size_t*)extra += *(size_t*)dato;
+    return true;
+}
+
+static void prueba_lista_bloque()
+{
+    const size_t largo = 1000;
+    size_t valores[largo];
+    void* datos[largo];
+    size_t esperado = 0;
+    for (size_t i = 0; i < largo; i++) {
+        valores[i] = i;
+        datos[i] = &valores[i];
+        esperado += i;
+    }
+
+    lista_bloque_t* lista = lista_bloque_crear();
+    print_test("Prueba lista bloque insertar varios", lista_bloque_insertar_varios(lista, datos, largo / 2));
+    bool ok = true;
+    for (size_t i = largo / 2; i < largo && ok; i++) {
+        ok = lista_bloque_insertar_ultimo(lista, datos[i]);
+    }
+    print_test("Prueba lista bloque insertar ultimo", ok);
+    print_test("Prueba lista bloque el largo es correcto", lista_bloque_largo(lista) == largo);
+
+    size_t suma = 0;
+    lista_bloque_iterar(lista, sumar, &suma);
+    print_test("Prueba lista bloque iterar recorre todo", suma == esperado);
+
+    lista_bloque_iter_t* iter = lista_bloque_iter_crear(lista);
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = lista_bloque_iter_ver_actual(iter) == datos[i];
+        lista_bloque_iter_avanzar(iter);
+    }
+    print_test("Prueba lista bloque el iterador respeta el orden", ok && lista_bloque_iter_al_final(iter));
+    lista_bloque_iter_destruir(iter);
+
+    lista_bloque_t* otra = lista_bloque_crear();
+    lista_bloque_insertar_primero(otra, datos[1]);
+    lista_bloque_insertar_primero(otra, datos[0]);
+    lista_bloque_extender(lista, otra);
+    print_test("Prueba lista bloque extender vacia la otra lista", lista_bloque_esta_vacia(otra));
+    print_test("Prueba lista bloque extender agrega al final", lista_bloque_ver_ultimo(lista) == datos[1] && lista_bloque_largo(lista) == largo + 2);
+
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = lista_bloque_borrar_primero(lista) == datos[i];
+    }
+    print_test("Prueba lista bloque borrar primero respeta el orden", ok);
+    print_test("Prueba lista bloque quedan los elementos extendidos", lista_bloque_ver_primero(lista) == datos[0] && lista_bloque_largo(lista) == 2);
+
+    lista_bloque_destruir(otra, NULL);
+    lista_bloque_destruir(lista, NULL);
+}
+
+static void prueba_lista_insertar_varios()
+{
+    int valores[] = {1, 2, 3};
+    void* datos[] = {&valores[0], &valores[1], &valores[2]};
+
+    lista_t* lista = lista_crear();
+    lista_t* otra = lista_crear();
+    print_test("Prueba lista insertar varios", lista_insertar_varios(lista, datos, 2));
+    print_test("Prueba lista insertar varios en la otra", lista_insertar_varios(otra, &datos[2], 1));
+    lista_extender(lista, otra);
+    print_test("Prueba lista extender deja la otra vacia", lista_esta_vacia(otra));
+    print_test("Prueba lista extender suma los largos", lista_largo(lista) == 3);
+    print_test("Prueba lista el primero es el primero insertado", lista_ver_primero(lista) == datos[0]);
+    print_test("Prueba lista el ultimo es el de la otra lista", lista_ver_ultimo(lista) == datos[2]);
+    lista_destruir(otra, NULL);
+    lista_destruir(lista, NULL);
+}
+
+typedef struct elemento {
+    int valor;
+    lista_enlace_t enlace;
+} elemento_t;
+
+static void prueba_lista_intrusiva()
+{
+    elemento_t elementos[4] = {{.valor = 0}, {.valor = 1}, {.valor = 2}, {.valor = 3}};
+    lista_intrusiva_t lista;
+    lista_intrusiva_iniciar(&lista);
+
+    print_test("Prueba lista intrusiva esta vacia", lista_intrusiva_esta_vacia(&lista));
+    lista_intrusiva_insertar_ultimo(&lista, &elementos[1].enlace);
+    lista_intrusiva_insertar_ultimo(&lista, &elementos[3].enlace);
+    lista_intrusiva_insertar_primero(&lista, &elementos[0].enlace);
+
+    lista_intrusiva_iter_t iter;
+    lista_intrusiva_iter_iniciar(&iter, &lista);
+    lista_intrusiva_iter_avanzar(&iter);
+    lista_intrusiva_iter_avanzar(&iter);
+    lista_intrusiva_iter_insertar(&iter, &elementos[2].enlace);
+    print_test("Prueba lista intrusiva iter insertar apunta al nuevo", lista_intrusiva_iter_ver_actual(&iter) == &elementos[2].enlace);
+    print_test("Prueba lista intrusiva el largo es 4", lista_intrusiva_largo(&lista) == 4);
+
+    bool ok = true;
+    int esperado = 0;
+    for (lista_intrusiva_iter_iniciar(&iter, &lista); !lista_intrusiva_iter_al_final(&iter); lista_intrusiva_iter_avanzar(&iter)) {
+        ok &= lista_contenedor(lista_intrusiva_iter_ver_actual(&iter), elemento_t, enlace)->valor == esperado++;
+    }
+    print_test("Prueba lista intrusiva recorre en orden", ok && esperado == 4);
+
+    lista_intrusiva_borrar(&lista, &elementos[2].enlace);
+    print_test("Prueba lista intrusiva borrar del medio", lista_intrusiva_largo(&lista) == 3);
+    lista_intrusiva_borrar(&lista, &elementos[3].enlace);
+    print_test("Prueba lista intrusiva borrar el ultimo actualiza el ultimo", lista_intrusiva_ver_ultimo(&lista) == &elementos[1].enlace);
+    print_test("Prueba lista intrusiva borrar primero", lista_intrusiva_borrar_primero(&lista) == &elementos[0].enlace);
+    lista_intrusiva_iter_iniciar(&iter, &lista);
+    print_test("Prueba lista intrusiva iter borrar", lista_intrusiva_iter_borrar(&iter) == &elementos[1].enlace);
+    print_test("Prueba lista intrusiva queda vacia", lista_intrusiva_esta_vacia(&lista) && lista_intrusiva_iter_al_final(&iter));
+}
+
+static void prueba_cola_concurrente()
+{
+    int valores[3] = {1, 2, 3};
+    cola_concurrente_t* cola = cola_concurrente_crear();
+
+    print_test("Prueba cola concurrente crear", cola);
+    print_test("Prueba cola concurrente esta vacia", cola_concurrente_esta_vacia(cola));
+    print_test("Prueba cola concurrente borrar primero vacia es NULL", !cola_concurrente_borrar_primero(cola));
+    bool ok = true;
+    for (size_t i = 0; i < 3; i++) {
+        ok &= cola_concurrente_insertar_ultimo(cola, &valores[i]);
+    }
+    print_test("Prueba cola concurrente insertar ultimo", ok && !cola_concurrente_esta_vacia(cola));
+    print_test("Prueba cola concurrente sale el primero", cola_concurrente_borrar_primero(cola) == &valores[0]);
+    print_test("Prueba cola concurrente sale el segundo", cola_concurrente_borrar_primero(cola) == &valores[1]);
+    cola_concurrente_salir(cola);
+
+    int* resto = malloc(sizeof(int));
+    print_test("Prueba cola concurrente insertar despues de salir", cola_concurrente_insertar_ultimo(cola, resto));
+    print_test("Prueba cola concurrente sale el tercero", cola_concurrente_borrar_primero(cola) == &valores[2]);
+    cola_concurrente_destruir(cola, free);
+}
+
+
+static bool contar_rango(const char* clave, void* dato, void* extra)
+{
+    (void)dato;
+    size_t* visitados = extra;
+    (*visitados)++;
+    return strcmp(clave, "mm") != 0;
+}
+
+static void prueba_hash_ordenado()
+{
+    hash_t* hash = hash_crear_ordenado(NULL);
+    char* claves[] = {"pera", "manzana", "perro", "banana", "perdiz", "uva"};
+    for (size_t i = 0; i < 6; i++) {
+        hash_guardar(hash, claves[i], claves[i]);
+    }
+    hash_t* sin_orden = hash_crear(NULL);
+    print_test("Prueba hash sin orden no tiene iterador ordenado", hash_iter_crear_ordenado(sin_orden) == NULL);
+    hash_destruir(sin_orden);
+
+    hash_iter_t* iter = hash_iter_crear_ordenado(hash);
+    const char* anterior = "";
+    size_t cantidad = 0;
+    bool ok = true;
+    for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)) {
+        ok &= strcmp(anterior, hash_iter_ver_actual(iter)) < 0;
+        anterior = hash_iter_ver_actual(iter);
+        cantidad++;
+    }
+    print_test("Prueba hash ordenado recorre todas las claves en orden", ok && cantidad == 6);
+    hash_iter_destruir(iter);
+
+    hash_borrar(hash, "perro");
+    iter = hash_iter_crear_prefijo(hash, "per");
+    print_test("Prueba hash ordenado prefijo empieza en pera", strcmp(hash_iter_ver_actual(iter), "pera") == 0);
+    hash_iter_avanzar(iter);
+    print_test("Prueba hash ordenado prefijo sigue en perdiz", strcmp(hash_iter_ver_actual(iter), "perdiz") == 0);
+    hash_iter_avanzar(iter);
+    print_test("Prueba hash ordenado prefijo no ve la clave borrada", hash_iter_al_final(iter));
+    hash_iter_destruir(iter);
+
+    size_t visitados = 0;
+    hash_rango(hash, "c", "p", contar_rango, &visitados);
+    print_test("Prueba hash ordenado rango [c, p] visita solo manzana", visitados == 1);
+    visitados = 0;
+    hash_rango(hash, NULL, "mm", contar_rango, &visitados);
+    print_test("Prueba hash ordenado rango corta cuando visitar devuelve false", visitados == 2);
+    hash_destruir(hash);
+
+    sin_orden = hash_crear(NULL);
+    hash_guardar(sin_orden, "manzana", NULL);
+    visitados = 0;
+    hash_rango(sin_orden, NULL, NULL, contar_rango, &visitados);
+    print_test("Prueba hash rango sin orden no visita nada", visitados == 0);
+    hash_destruir(sin_orden);
+}
+
+static void prueba_hash_ordenado_volumen(size_t largo)
+{
+    hash_t* hash = hash_crear_ordenado(NULL);
+    char clave[24];
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%08zu", (i * 7919) % largo);
+        hash_guardar(hash, clave, NULL);
+    }
+    // borra las claves pares
+    for (size_t i = 0; i < largo; i += 2) {
+        sprintf(clave, "%08zu", i);
+        hash_borrar(hash, clave);
+    }
+
+    hash_iter_t* iter = hash_iter_crear_ordenado(hash);
+    bool ok = true;
+    size_t esperado = 1;
+    for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter), esperado += 2) {
+        sprintf(clave, "%08zu", esperado);
+        ok &= strcmp(hash_iter_ver_actual(iter), clave) == 0;
+    }
+    print_test("Prueba hash ordenado volumen recorre las impares en orden", ok && esperado == largo + 1);
+    hash_iter_destruir(iter);
+    hash_destruir(hash);
+}
+
+#define RUTA_PRUEBA_DURABLE "/tmp/prueba_hash_durable"
+
+static void borrar_hash_durable(void)
+{
+    char ruta[64];
+    remove(RUTA_PRUEBA_DURABLE "/instantanea");
+    remove(RUTA_PRUEBA_DURABLE "/instantanea.tmp");
+    for (int i = 0; i < 10; i++) {
+        sprintf(ruta, RUTA_PRUEBA_DURABLE "/log.%d", i);
+        remove(ruta);
+    }
+    remove(RUTA_PRUEBA_DURABLE);
+}
+
+static bool valor_durable_es(const hash_durable_t* hash, const char* clave, const char* esperado)
+{
+    size_t largo;
+    const char* valor = hash_durable_obtener(hash, clave, &largo);
+    return valor && largo == strlen(esperado) && memcmp(valor, esperado, largo) == 0;
+}
+
+static void prueba_hash_durable()
+{
+    borrar_hash_durable();
+    hash_durable_t* hash = hash_durable_abrir(RUTA_PRUEBA_DURABLE);
+    print_test("Prueba hash durable abrir crea un hash vacio", hash && hash_durable_cantidad(hash) == 0);
+    hash_durable_guardar(hash, "perro", "guau", 4);
+    hash_durable_guardar(hash, "gato", "miau", 4);
+    hash_durable_guardar(hash, "vaca", "mu", 2);
+    hash_durable_guardar(hash, "perro", "warf", 4);
+    print_test("Prueba hash durable borrar", hash_durable_borrar(hash, "gato"));
+    print_test("Prueba hash durable borrar una clave inexistente", !hash_durable_borrar(hash, "gato"));
+    print_test("Prueba hash durable cerrar confirma lo pendiente", hash_durable_cerrar(hash));
+
+    hash = hash_durable_abrir(RUTA_PRUEBA_DURABLE);
+    print_test("Prueba hash durable reabrir recupera la cantidad", hash && hash_durable_cantidad(hash) == 2);
+    print_test("Prueba hash durable reabrir recupera el ultimo valor", valor_durable_es(hash, "perro", "warf"));
+    print_test("Prueba hash durable reabrir no tiene la clave borrada", !hash_durable_pertenece(hash, "gato"));
+    hash_durable_cerrar(hash);
+
+    // un registro a medio escribir al final del log se descarta
+    FILE* log = fopen(RUTA_PRUEBA_DURABLE "/log.0", "ab");
+    fwrite("G\x05\0\0", 1, 4, log);
+    fclose(log);
+    hash = hash_durable_abrir(RUTA_PRUEBA_DURABLE);
+    print_test("Prueba hash durable ignora un registro cortado", hash && hash_durable_cantidad(hash) == 2);
+    hash_durable_guardar(hash, "oveja", "bee", 3);
+    hash_durable_cerrar(hash);
+    hash = hash_durable_abrir(RUTA_PRUEBA_DURABLE);
+    print_test("Prueba hash durable sigue escribiendo despues del corte", hash && valor_durable_es(hash, "oveja", "bee"));
+
+    char clave[16];
+    for (int i = 0; i < 1000; i++) {
+        sprintf(clave, "clave%d", i);
+        hash_durable_guardar(hash, clave, clave, strlen(clave));
+    }
+    print_test("Prueba hash durable compactar", hash_durable_compactar(hash));
+    hash_durable_borrar(hash, "clave0");
+    hash_durable_guardar(hash, "clave1", "otro", 4);
+    print_test("Prueba hash durable esperar compactacion", hash_durable_esperar_compactacion(hash));
+    hash_durable_cerrar(hash);
+
+    log = fopen(RUTA_PRUEBA_DURABLE "/log.0", "rb");
+    print_test("Prueba hash durable la compactacion borra los segmentos viejos", log == NULL);
+    if (log) fclose(log);
+    hash = hash_durable_abrir(RUTA_PRUEBA_DURABLE);
+    bool ok = hash && hash_durable_cantidad(hash) == 1002 && !hash_durable_pertenece(hash, "clave0");
+    ok = ok && valor_durable_es(hash, "clave1", "otro") && valor_durable_es(hash, "clave999", "clave999");
+    print_test("Prueba hash durable recupera instantanea y log", ok);
+    hash_durable_cerrar(hash);
+    borrar_hash_durable();
+}
+
+static void* sumar_contador(void* actual, void* nuevo)
+{
+    *(int*)actual += *(int*)nuevo;
+    free(nuevo);
+    return actual;
+}
+
+static int* contador_crear(int valor)
+{
+    int* contador = malloc(sizeof(int));
+    *contador = valor;
+    return contador;
+}
+
+static void prueba_hash_obtener_o_guardar()
+{
+    hash_t* hash = hash_crear(NULL);
+    bool estaba = true;
+    void** lugar = hash_obtener_o_guardar(hash, "gato", (void*)1, &estaba);
+    print_test("Prueba hash obtener o guardar clave nueva", lugar && !estaba && *lugar == (void*)1);
+    lugar = hash_obtener_o_guardar(hash, "gato", (void*)2, &estaba);
+    print_test("Prueba hash obtener o guardar clave existente", lugar && estaba && *lugar == (void*)1);
+    *lugar = (void*)3;
+    print_test("Prueba hash obtener o guardar cambia el dato", hash_obtener(hash, "gato") == (void*)3 && hash_cantidad(hash) == 1);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_guardar_lote()
+{
+    hash_t* hash = hash_crear(free);
+    hash_guardar(hash, "b", contador_crear(10));
+    const char* claves[] = {"a", "b", "c", "a", "b", "a"};
+    void* datos[6];
+    for (size_t i = 0; i < 6; i++) {
+        datos[i] = contador_crear((int)i + 1);
+    }
+    print_test("Prueba hash guardar lote combinando", hash_guardar_lote(hash, claves, datos, 6, sumar_contador));
+    print_test("Prueba hash guardar lote la cantidad es 3", hash_cantidad(hash) == 3);
+    print_test("Prueba hash guardar lote suma las repetidas", *(int*)hash_obtener(hash, "a") == 1 + 4 + 6);
+    print_test("Prueba hash guardar lote suma sobre el dato que estaba", *(int*)hash_obtener(hash, "b") == 10 + 2 + 5);
+
+    // sin combinar gana la ultima aparicion de cada clave
+    const char* otras[] = {"c", "d", "c"};
+    for (size_t i = 0; i < 3; i++) {
+        datos[i] = contador_crear((int)i + 1);
+    }
+    hash_guardar_lote(hash, otras, datos, 3, NULL);
+    print_test("Prueba hash guardar lote sin combinar reemplaza", *(int*)hash_obtener(hash, "c") == 3 && *(int*)hash_obtener(hash, "d") == 2);
+
+    char clave[16];
+    const char* muchas[1000];
+    char memoria[1000][16];
+    for (size_t i = 0; i < 1000; i++) {
+        sprintf(memoria[i], "%zu", i % 500);
+        muchas[i] = memoria[i];
+    }
+    void** unos = malloc(1000 * sizeof(void*));
+    for (size_t i = 0; i < 1000; i++) {
+        unos[i] = contador_crear(1);
+    }
+    hash_guardar_lote(hash, muchas, unos, 1000, sumar_contador);
+    bool ok = hash_cantidad(hash) == 504;
+    for (size_t i = 0; i < 500; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= *(int*)hash_obtener(hash, clave) == 2;
+    }
+    print_test("Prueba hash guardar lote con redimension", ok);
+    free(unos);
+    hash_destruir(hash);
+
+    // en dos pasos: el hash puede cambiar entre preparar y aplicar
+    hash_t* ordenado = hash_crear_ordenado(free);
+    const char* lote_claves[] = {"x", "y", "x"};
+    for (size_t i = 0; i < 3; i++) {
+        datos[i] = contador_crear((int)i + 1);
+    }
+    hash_lote_t* lote = hash_lote_preparar(ordenado, lote_claves, datos, 3);
+    hash_guardar(ordenado, "y", contador_crear(10));
+    print_test("Prueba hash lote aplicar", lote && hash_lote_aplicar(ordenado, lote, sumar_contador));
+    hash_lote_destruir(lote);
+    print_test("Prueba hash lote aplicar combina con lo guardado en el medio",
+               hash_cantidad(ordenado) == 2 && *(int*)hash_obtener(ordenado, "x") == 1 + 3 && *(int*)hash_obtener(ordenado, "y") == 10 + 2);
+    hash_iter_t* iter = hash_iter_crear_ordenado(ordenado);
+    ok = iter && strcmp(hash_iter_ver_actual(iter), "x") == 0 && hash_iter_avanzar(iter) && strcmp(hash_iter_ver_actual(iter), "y") == 0;
+    hash_iter_destruir(iter);
+    print_test("Prueba hash lote aplicar actualiza el orden", ok);
+    hash_destruir(ordenado);
+}
+
+#define HILOS_BUFFER 4
+#define CLAVES_BUFFER 100
+
+typedef struct ingesta {
+    hash_t* hash;
+    pthread_mutex_t* mutex;
+} ingesta_t;
+
+static void* ingerir(void* extra)
+{
+    ingesta_t* ingesta = extra;
+    hash_buffer_t* buffer = hash_buffer_crear(ingesta->hash, ingesta->mutex, free, sumar_contador, 32, 0);
+    char clave[16];
+    for (int i = 0; i < 10000; i++) {
+        sprintf(clave, "contador%d", i % CLAVES_BUFFER);
+        hash_buffer_guardar(buffer, clave, contador_crear(1));
+    }
+    hash_buffer_destruir(buffer);
+    return NULL;
+}
+
+static void prueba_hash_buffer()
+{
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    hash_t* hash = hash_crear(free);
+    hash_buffer_t* buffer = hash_buffer_crear(hash, &mutex, free, sumar_contador, 1000, 0);
+    hash_buffer_guardar(buffer, "x", contador_crear(1));
+    hash_buffer_guardar(buffer, "x", contador_crear(2));
+    print_test("Prueba hash buffer junta la clave repetida", hash_buffer_cantidad(buffer) == 1);
+    print_test("Prueba hash buffer no escribe antes de vaciar", !hash_pertenece(hash, "x"));
+    print_test("Prueba hash buffer vaciar", hash_buffer_vaciar(buffer) && hash_buffer_cantidad(buffer) == 0);
+    print_test("Prueba hash buffer vuelca el dato combinado", *(int*)hash_obtener(hash, "x") == 3);
+    hash_buffer_destruir(buffer);
+
+    ingesta_t ingesta = {hash, &mutex};
+    pthread_t hilos[HILOS_BUFFER];
+    for (size_t i = 0; i < HILOS_BUFFER; i++) {
+        pthread_create(&hilos[i], NULL, ingerir, &ingesta);
+    }
+    for (size_t i = 0; i < HILOS_BUFFER; i++) {
+        pthread_join(hilos[i], NULL);
+    }
+    bool ok = hash_cantidad(hash) == CLAVES_BUFFER + 1;
+    char clave[16];
+    for (int i = 0; i < CLAVES_BUFFER; i++) {
+        sprintf(clave, "contador%d", i);
+        ok &= *(int*)hash_obtener(hash, clave) == HILOS_BUFFER * 10000 / CLAVES_BUFFER;
+    }
+    print_test("Prueba hash buffer varios hilos no pierden cuentas", ok);
+    hash_destruir(hash);
+}
+
+static intptr_t valor_numerico(const hash_t* hash, const char* clave)
+{
+    return (intptr_t)hash_obtener(hash, clave);
+}
+
+static void prueba_hash_fusionar()
+{
+    hash_t* hash = hash_crear(NULL);
+    hash_fusionar(hash, "suma", 5, &HASH_FUSION_SUMA);
+    hash_fusionar(hash, "suma", -2, &HASH_FUSION_SUMA);
+    print_test("Prueba hash fusionar suma", valor_numerico(hash, "suma") == 3);
+    hash_fusionar(hash, "minimo", 7, &HASH_FUSION_MINIMO);
+    hash_fusionar(hash, "minimo", 4, &HASH_FUSION_MINIMO);
+    hash_fusionar(hash, "minimo", 9, &HASH_FUSION_MINIMO);
+    print_test("Prueba hash fusionar minimo", valor_numerico(hash, "minimo") == 4);
+    hash_fusionar(hash, "maximo", -7, &HASH_FUSION_MAXIMO);
+    hash_fusionar(hash, "maximo", -4, &HASH_FUSION_MAXIMO);
+    print_test("Prueba hash fusionar maximo", valor_numerico(hash, "maximo") == -4);
+
+    char elemento[16];
+    for (int i = 0; i < 1000; i++) {
+        sprintf(elemento, "usuario%d", i % 200);
+        hash_fusionar(hash, "distintos", (intptr_t)hash_funcion(elemento), &HASH_FUSION_HLL);
+    }
+    double estimacion = hash_hll_estimar(valor_numerico(hash, "distintos"));
+    print_test("Prueba hash fusionar hll estima los distintos", estimacion > 100 && estimacion < 300);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_unir(size_t largo)
+{
+    hash_t* destino = hash_crear(NULL);
+    hash_t* origen = hash_crear(NULL);
+    char clave[24];
+    // la mitad de las claves de origen ya estan en destino
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        hash_fusionar(destino, clave, 1, &HASH_FUSION_SUMA);
+        sprintf(clave, "%zu", i + largo / 2);
+        hash_fusionar(origen, clave, 10, &HASH_FUSION_SUMA);
+    }
+    print_test("Prueba hash unir", hash_unir(destino, origen, &HASH_FUSION_SUMA));
+    print_test("Prueba hash unir la cantidad es correcta", hash_cantidad(destino) == largo + largo / 2);
+    bool ok = true;
+    for (size_t i = 0; i < largo + largo / 2; i++) {
+        sprintf(clave, "%zu", i);
+        intptr_t esperado = (i < largo ? 1 : 0) + (i >= largo / 2 ? 10 : 0);
+        ok &= valor_numerico(destino, clave) == esperado;
+    }
+    print_test("Prueba hash unir fusiona los valores", ok);
+    hash_destruir(destino);
+    hash_destruir(origen);
+}
+
+static void prueba_hash_cuco()
+{
+    hash_cuco_t* hash = hash_cuco_crear(free);
+    print_test("Prueba hash cuco crear vacio", hash_cuco_cantidad(hash) == 0);
+    print_test("Prueba hash cuco guardar", hash_cuco_guardar(hash, "gato", contador_crear(1)));
+    print_test("Prueba hash cuco reemplazar", hash_cuco_guardar(hash, "gato", contador_crear(2)));
+    print_test("Prueba hash cuco obtener", *(int*)hash_cuco_obtener(hash, "gato") == 2);
+    print_test("Prueba hash cuco la cantidad es 1", hash_cuco_cantidad(hash) == 1);
+    print_test("Prueba hash cuco clave inexistente", !hash_cuco_pertenece(hash, "perro"));
+    int* dato = hash_cuco_borrar(hash, "gato");
+    print_test("Prueba hash cuco borrar", dato && *dato == 2 && !hash_cuco_pertenece(hash, "gato"));
+    free(dato);
+    print_test("Prueba hash cuco borrar inexistente", !hash_cuco_borrar(hash, "gato"));
+    hash_cuco_destruir(hash);
+}
+
+static void prueba_hash_cuco_volumen(size_t largo)
+{
+    hash_cuco_t* hash = hash_cuco_crear(NULL);
+    char clave[24];
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_cuco_guardar(hash, clave, (void*)(i + 1));
+    }
+    print_test("Prueba hash cuco almacenar muchos elementos", ok && hash_cuco_cantidad(hash) == largo);
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_cuco_obtener(hash, clave) == (void*)(i + 1);
+    }
+    print_test("Prueba hash cuco los valores desplazados son correctos", ok);
+
+    size_t recorridos = 0;
+    hash_cuco_iter_t* iter = hash_cuco_iter_crear(hash);
+    for (; !hash_cuco_iter_al_final(iter); hash_cuco_iter_avanzar(iter)) {
+        ok &= hash_cuco_pertenece(hash, hash_cuco_iter_ver_actual(iter));
+        recorridos++;
+    }
+    hash_cuco_iter_destruir(iter);
+    print_test("Prueba hash cuco iterar recorre todo", ok && recorridos == largo);
+
+    for (size_t i = 0; i < largo; i += 2) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_cuco_borrar(hash, clave) == (void*)(i + 1);
+    }
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_cuco_pertenece(hash, clave) == (i % 2 == 1);
+    }
+    print_test("Prueba hash cuco borrar la mitad", ok && hash_cuco_cantidad(hash) == largo / 2);
+    hash_cuco_destruir(hash);
+}
+
+#define ETAPAS_CHOQUE 4 // 2^4 claves con el mismo hash
+#define LARGO_BLOQUE_CHOQUE 6
+#define CANDIDATOS_CHOQUE (1 << 18)
+
+typedef struct candidato_choque {
+    unsigned acumulado;
+    unsigned indice;
+} candidato_choque_t;
+
+static int comparar_candidatos(const void* a, const void* b)
+{
+    unsigned x = ((const candidato_choque_t*)a)->acumulado;
+    unsigned y = ((const candidato_choque_t*)b)->acumulado;
+    return (x > y) - (x < y);
+}
+
+static void bloque_choque(unsigned indice, char* bloque)
+{
+    for (int i = 0; i < LARGO_BLOQUE_CHOQUE; i++) {
+        bloque[i] = (char)('a' + indice % 26);
+        indice /= 26;
+    }
+}
+
+/* Arma claves con el mismo hash_funcion: en cada etapa busca por cumpleaños
+ * dos bloques que lleven el estado al mismo valor, y cualquier combinación
+ * de los bloques elegidos termina igual. Devuelve false si en alguna etapa
+ * no encontró choque.
+ */
+static bool generar_choques(char claves[][ETAPAS_CHOQUE * LARGO_BLOQUE_CHOQUE + 1])
+{
+    candidato_choque_t* candidatos = malloc(CANDIDATOS_CHOQUE * sizeof(candidato_choque_t));
+    if (!candidatos) {
+        return false;
+    }
+    char elegidos[ETAPAS_CHOQUE][2][LARGO_BLOQUE_CHOQUE];
+    hash_estado_t estado;
+    hash_estado_iniciar(&estado);
+    bool ok = true;
+    for (int etapa = 0; ok && etapa < ETAPAS_CHOQUE; etapa++) {
+        for (unsigned i = 0; i < CANDIDATOS_CHOQUE; i++) {
+            char bloque[LARGO_BLOQUE_CHOQUE];
+            bloque_choque(i, bloque);
+            hash_estado_t siguiente = estado;
+            hash_estado_agregar(&siguiente, bloque, LARGO_BLOQUE_CHOQUE);
+            candidatos[i] = (candidato_choque_t){siguiente.acumulado, i};
+        }
+        qsort(candidatos, CANDIDATOS_CHOQUE, sizeof(candidato_choque_t), comparar_candidatos);
+        size_t i = 1;
+        while (i < CANDIDATOS_CHOQUE && candidatos[i].acumulado != candidatos[i - 1].acumulado) {
+            i++;
+        }
+        ok = i < CANDIDATOS_CHOQUE;
+        if (ok) {
+            bloque_choque(candidatos[i - 1].indice, elegidos[etapa][0]);
+            bloque_choque(candidatos[i].indice, elegidos[etapa][1]);
+            hash_estado_agregar(&estado, elegidos[etapa][0], LARGO_BLOQUE_CHOQUE);
+        }
+    }
+    free(candidatos);
+    for (int c = 0; ok && c < 1 << ETAPAS_CHOQUE; c++) {
+        for (int etapa = 0; etapa < ETAPAS_CHOQUE; etapa++) {
+            memcpy(claves[c] + etapa * LARGO_BLOQUE_CHOQUE, elegidos[etapa][(c >> etapa) & 1], LARGO_BLOQUE_CHOQUE);
+        }
+        claves[c][ETAPAS_CHOQUE * LARGO_BLOQUE_CHOQUE] = '\0';
+    }
+    return ok;
+}
+
+static void prueba_hash_cuco_choques()
+{
+    char claves[1 << ETAPAS_CHOQUE][ETAPAS_CHOQUE * LARGO_BLOQUE_CHOQUE + 1];
+    bool generadas = generar_choques(claves);
+    bool ok = generadas;
+    for (int i = 1; generadas && i < 1 << ETAPAS_CHOQUE; i++) {
+        ok &= strcmp(claves[i], claves[0]) != 0 && hash_funcion(claves[i]) == hash_funcion(claves[0]);
+    }
+    print_test("Prueba hash cuco claves con el mismo hash", ok);
+    if (!generadas) {
+        return;
+    }
+
+    // Entran en sus dos baldes 2 * 4 claves; las demas no tienen lugar en
+    // ningun tamaño y guardarlas tiene que fallar sin agrandar sin fin.
+    hash_cuco_t* hash = hash_cuco_crear(NULL);
+    size_t guardadas = 0;
+    for (int i = 0; i < 1 << ETAPAS_CHOQUE; i++) {
+        guardadas += hash_cuco_guardar(hash, claves[i], (void*)(intptr_t)(i + 1));
+    }
+    print_test("Prueba hash cuco con choques guarda lo que entra", guardadas == 8 && hash_cuco_cantidad(hash) == 8);
+    ok = true;
+    for (int i = 0; i < 1 << ETAPAS_CHOQUE; i++) {
+        void* dato = hash_cuco_obtener(hash, claves[i]);
+        ok &= i < 8 ? dato == (void*)(intptr_t)(i + 1) : dato == NULL;
+    }
+    print_test("Prueba hash cuco con choques los valores son correctos", ok);
+
+    char clave[24];
+    for (size_t i = 0; i < 10000; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_cuco_guardar(hash, clave, (void*)(i + 1));
+    }
+    print_test("Prueba hash cuco con choques sigue guardando otras claves", ok && hash_cuco_cantidad(hash) == 10008);
+    hash_cuco_destruir(hash);
+}
+
+#define FIJAS_CUCO 1000
+
+typedef struct lectura_cuco {
+    hash_cuco_t* hash;
+    atomic_bool terminar;
+    bool ok;
+} lectura_cuco_t;
+
+static void* leer_cuco(void* extra)
+{
+    lectura_cuco_t* lectura = extra;
+    char clave[24];
+    while (!atomic_load(&lectura->terminar)) {
+        for (int i = 0; i < FIJAS_CUCO; i++) {
+            sprintf(clave, "fija%d", i);
+            lectura->ok &= hash_cuco_obtener(lectura->hash, clave) == (void*)(intptr_t)(i + 1);
+        }
+    }
+    return NULL;
+}
+
+static void prueba_hash_cuco_concurrente(size_t largo)
+{
+    hash_cuco_t* hash = hash_cuco_crear(NULL);
+    char clave[32];
+    for (int i = 0; i < FIJAS_CUCO; i++) {
+        sprintf(clave, "fija%d", i);
+        hash_cuco_guardar(hash, clave, (void*)(intptr_t)(i + 1));
+    }
+    lectura_cuco_t lectura = {.hash = hash, .ok = true};
+    atomic_init(&lectura.terminar, false);
+    pthread_t lector;
+    pthread_create(&lector, NULL, leer_cuco, &lectura);
+    // las inserciones desplazan y redimensionan mientras el lector busca
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "movil%zu", i);
+        hash_cuco_guardar(hash, clave, NULL);
+        if (i % 3 == 0) {
+            hash_cuco_borrar(hash, clave);
+        }
+    }
+    atomic_store(&lectura.terminar, true);
+    pthread_join(lector, NULL);
+    print_test("Prueba hash cuco el lector nunca pierde una clave", lectura.ok);
+    hash_cuco_destruir(hash);
+}
+
+// Cuenta lo que pide el hash y delega en otro asignador
+typedef struct cuenta_memoria {
+    hash_asignador_t* real;
+    size_t pedidos;
+    size_t bytes;
+    bool agotada; // simula que no hay más memoria
+} cuenta_memoria_t;
+
+static void* pedir_contado(size_t tam, size_t alineacion, void* contexto)
+{
+    cuenta_memoria_t* cuenta = contexto;
+    if (cuenta->agotada) return NULL;
+    void* memoria = cuenta->real->pedir(tam, alineacion, cuenta->real->contexto);
+    if (memoria) {
+        cuenta->pedidos++;
+        cuenta->bytes += tam;
+    }
+    return memoria;
+}
+
+static void liberar_contado(void* memoria, size_t tam, void* contexto)
+{
+    cuenta_memoria_t* cuenta = contexto;
+    cuenta->pedidos--;
+    cuenta->bytes -= tam;
+    cuenta->real->liberar(memoria, tam, cuenta->real->contexto);
+}
+
+static void prueba_hash_asignador(size_t largo)
+{
+    cuenta_memoria_t cuenta = {paginas_grandes_crear(NULL, 0), 0, 0, false};
+    hash_asignador_t asignador = {pedir_contado, liberar_contado, &cuenta};
+    hash_t* hash = hash_crear_con_asignador(NULL, &asignador);
+    char clave[24];
+    for (size_t i = 0; i < 1000; i++) {
+        sprintf(clave, "%zu", i);
+        hash_guardar(hash, clave, (void*)(i + 1));
+    }
+    for (size_t i = 0; i < 1000; i += 2) {
+        sprintf(clave, "%zu", i);
+        hash_borrar(hash, clave);
+    }
+    print_test("Prueba hash asignador recibe los pedidos", cuenta.pedidos > 500);
+
+    // sin memoria no se puede achicar la tabla, pero borrar tiene que andar
+    cuenta.agotada = true;
+    bool borradas = !hash_guardar(hash, "nueva", NULL);
+    for (size_t i = 1; i < 1000; i += 2) {
+        sprintf(clave, "%zu", i);
+        borradas &= hash_borrar(hash, clave) == (void*)(i + 1);
+    }
+    print_test("Prueba hash borrar sin memoria", borradas && hash_cantidad(hash) == 0);
+    cuenta.agotada = false;
+    hash_destruir(hash);
+    print_test("Prueba hash asignador se devuelve toda la memoria", cuenta.pedidos == 0 && cuenta.bytes == 0);
+    paginas_grandes_destruir(cuenta.real);
+
+    // la tabla pasa los 2 MB: primero anónima y desde 4 MB en el archivo
+    hash_asignador_t* paginas = paginas_grandes_crear("/tmp", 4 << 20);
+    hash = hash_crear_con_asignador(NULL, paginas);
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_guardar(hash, clave, (void*)(i + 1));
+    }
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_obtener(hash, clave) == (void*)(i + 1);
+    }
+    print_test("Prueba hash paginas grandes guarda y obtiene", ok && hash_cantidad(hash) == largo);
+    hash_destruir(hash);
+    paginas_grandes_destruir(paginas);
+}
+
+static void prueba_hash_en_linea()
+{
+    cuenta_memoria_t cuenta = {paginas_grandes_crear(NULL, 0), 0, 0, false};
+    hash_asignador_t asignador = {pedir_contado, liberar_contado, &cuenta};
+    hash_t* hash = hash_crear_con_asignador(NULL, &asignador);
+    // el unico pedido es el del struct, con el balde adentro
+    print_test("Prueba hash chico crear no pide tabla", hash && cuenta.pedidos == 1);
+    char clave[24];
+    bool ok = true;
+    for (size_t i = 0; i < 6; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_guardar(hash, clave, (void*)(i + 1));
+    }
+    print_test("Prueba hash chico un pedido por clave", ok && cuenta.pedidos == 1 + 6);
+    ok = hash_guardar(hash, "6", (void*)7) && cuenta.pedidos == 1 + 8;
+    for (size_t i = 0; i < 7; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_obtener(hash, clave) == (void*)(i + 1);
+    }
+    print_test("Prueba hash chico pasa a tabla aparte al llenarse", ok && !hash_pertenece(hash, "7"));
+    hash_destruir(hash);
+    print_test("Prueba hash chico devuelve toda la memoria", cuenta.pedidos == 0 && cuenta.bytes == 0);
+    paginas_grandes_destruir(cuenta.real);
+}
+
+static void prueba_hash_politica_memoria(size_t largo)
+{
+    cuenta_memoria_t cuenta = {paginas_grandes_crear(NULL, 0), 0, 0, false};
+    hash_asignador_t asignador = {pedir_contado, liberar_contado, &cuenta};
+    hash_t* hash = hash_crear_con_asignador(NULL, &asignador);
+    char clave[24];
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        hash_guardar(hash, clave, (void*)(i + 1));
+    }
+    size_t pico = cuenta.bytes;
+    for (size_t i = 0; i < largo - largo / 100; i++) {
+        sprintf(clave, "%zu", i);
+        hash_borrar(hash, clave);
+    }
+    print_test("Prueba hash borrar achica la tabla", cuenta.bytes < pico / 20);
+
+    // sin achicar al borrar la tabla queda hasta que haya tiempo libre
+    hash_politica_t politica = {.achicar_debajo_de = 0.25, .achicar_al_borrar = false};
+    hash_politica_memoria(hash, &politica);
+    for (size_t i = 0; i < largo - largo / 100; i++) {
+        sprintf(clave, "%zu", i);
+        hash_guardar(hash, clave, (void*)(i + 1));
+    }
+    pico = cuenta.bytes;
+    for (size_t i = 0; i < largo - largo / 100; i++) {
+        sprintf(clave, "%zu", i);
+        hash_borrar(hash, clave);
+    }
+    size_t sin_achicar = cuenta.bytes;
+    hash_politica_t al_borrar = {.achicar_debajo_de = 0.25, .achicar_al_borrar = true};
+    hash_politica_memoria(hash, &al_borrar);
+    hash_borrar(hash, "no esta");
+    print_test("Prueba hash borrar una clave que no esta no achica", cuenta.bytes == sin_achicar);
+    hash_politica_memoria(hash, &politica);
+    size_t pasos = 0;
+    while (hash_achicar_paso(hash)) {
+        pasos++;
+    }
+    print_test("Prueba hash achicar de a pasos", pasos > 1 && cuenta.bytes < sin_achicar / 4 && sin_achicar > pico / 4);
+    bool ok = hash_cantidad(hash) == largo / 100;
+    for (size_t i = largo - largo / 100; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_obtener(hash, clave) == (void*)(i + 1);
+    }
+    print_test("Prueba hash achicar conserva las claves", ok);
+    hash_destruir(hash);
+    paginas_grandes_destruir(cuenta.real);
+
+    hash = hash_crear(NULL);
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        hash_guardar(hash, clave, NULL);
+    }
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        hash_borrar(hash, clave);
+    }
+    hash_liberar_memoria(hash);
+    print_test("Prueba hash liberar memoria", hash_cantidad(hash) == 0 && !hash_achicar_paso(hash));
+    hash_destruir(hash);
+}
+
+static void prueba_hash_compacto()
+{
+    hash_compacto_t* hash = hash_compacto_crear(free);
+    print_test("Prueba hash compacto guardar", hash_compacto_guardar(hash, "gato", contador_crear(1)));
+    print_test("Prueba hash compacto reemplazar", hash_compacto_guardar(hash, "gato", contador_crear(2)));
+    print_test("Prueba hash compacto obtener", *(int*)hash_compacto_obtener(hash, "gato") == 2);
+    print_test("Prueba hash compacto clave inexistente", !hash_compacto_pertenece(hash, "perro"));
+    int* dato = hash_compacto_borrar(hash, "gato");
+    print_test("Prueba hash compacto borrar", dato && *dato == 2 && hash_compacto_cantidad(hash) == 0);
+    free(dato);
+    print_test("Prueba hash compacto borrar inexistente", !hash_compacto_borrar(hash, "gato"));
+    hash_compacto_destruir(hash);
+}
+
+static void prueba_hash_compacto_volumen(size_t largo)
+{
+    hash_compacto_t* hash = hash_compacto_crear(NULL);
+    char clave[24];
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_compacto_guardar(hash, clave, (void*)(i + 1));
+    }
+    print_test("Prueba hash compacto almacenar muchos elementos", ok && hash_compacto_cantidad(hash) == largo);
+    hash_compacto_estadisticas_t estadisticas;
+    hash_compacto_estadisticas(hash, &estadisticas);
+    print_test("Prueba hash compacto la sobrecarga por entrada es chica", estadisticas.sobrecarga_por_entrada < 32);
+
+    // borrar mueve entradas y compacta la arena: los valores no se mezclan
+    for (size_t i = 0; i < largo; i++) {
+        if (i % 4 != 0) {
+            sprintf(clave, "%zu", i);
+            ok &= hash_compacto_borrar(hash, clave) == (void*)(i + 1);
+        }
+    }
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_compacto_obtener(hash, clave) == (i % 4 == 0 ? (void*)(i + 1) : NULL);
+    }
+    print_test("Prueba hash compacto borrar tres cuartos", ok && hash_compacto_cantidad(hash) == (largo + 3) / 4);
+
+    size_t recorridos = 0;
+    hash_compacto_iter_t* iter = hash_compacto_iter_crear(hash);
+    for (; !hash_compacto_iter_al_final(iter); hash_compacto_iter_avanzar(iter)) {
+        ok &= hash_compacto_pertenece(hash, hash_compacto_iter_ver_actual(iter));
+        recorridos++;
+    }
+    hash_compacto_iter_destruir(iter);
+    print_test("Prueba hash compacto iterar recorre todo", ok && recorridos == hash_compacto_cantidad(hash));
+    hash_compacto_destruir(hash);
+}
+
+#define RUTA_PRUEBA_COMPACTO "/tmp/prueba_hash_compacto"
+
+typedef struct respuestas {
+    size_t recibidas;
+    size_t correctas;
+} respuestas_t;
+
+// Las claves "<i>" tienen el dato i + 1 y las "no<i>" no están
+static void anotar_respuesta(const char* clave, void* dato, void* extra)
+{
+    respuestas_t* respuestas = extra;
+    respuestas->recibidas++;
+    if (clave[0] == 'n' ? !dato : dato == (void*)(uintptr_t)(strtoul(clave, NULL, 10) + 1)) {
+        respuestas->correctas++;
+    }
+}
+
+static void prueba_hash_compacto_mapeado(size_t largo)
+{
+    hash_compacto_t* hash = hash_compacto_crear(NULL);
+    char clave[24];
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        hash_compacto_guardar(hash, clave, (void*)(i + 1));
+    }
+    print_test("Prueba hash compacto escribir", hash_compacto_escribir(hash, RUTA_PRUEBA_COMPACTO));
+    hash_compacto_destruir(hash);
+
+    hash = hash_compacto_mapear(RUTA_PRUEBA_COMPACTO);
+    print_test("Prueba hash compacto mapear", hash && hash_compacto_cantidad(hash) == largo);
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_compacto_obtener(hash, clave) == (void*)(i + 1);
+    }
+    print_test("Prueba hash compacto mapeado obtener", ok && !hash_compacto_pertenece(hash, "no"));
+    print_test("Prueba hash compacto mapeado es de solo lectura", !hash_compacto_guardar(hash, "x", NULL));
+
+    // la mitad de cada lote son claves que no estan
+    const char** claves = malloc(largo * sizeof(char*));
+    char* textos = malloc(largo * 24);
+    for (size_t i = 0; i < largo; i++) {
+        claves[i] = textos + i * 24;
+        sprintf(textos + i * 24, i % 2 ? "%zu" : "no%zu", i);
+    }
+    respuestas_t respuestas = {0, 0};
+    hash_asincrono_t* asincrono = hash_asincrono_crear(hash);
+    for (size_t i = 0; i < largo; i += 1000) {
+        ok &= hash_asincrono_obtener_lote(asincrono, claves + i, largo - i < 1000 ? largo - i : 1000, anotar_respuesta, &respuestas);
+    }
+    hash_asincrono_esperar(asincrono);
+    print_test("Prueba hash asincrono responde todas las claves", ok && respuestas.recibidas == largo);
+    print_test("Prueba hash asincrono las respuestas son correctas", respuestas.correctas == largo);
+    hash_asincrono_destruir(asincrono);
+    free(claves);
+    free(textos);
+    hash_compacto_destruir(hash);
+    remove(RUTA_PRUEBA_COMPACTO);
+}
+
+// Pisa largo bytes del archivo a partir de posicion
+static void pisar_archivo(const char* ruta, long posicion, const void* bytes, size_t largo)
+{
+    FILE* archivo = fopen(ruta, "r+b");
+    if (archivo) {
+        fseek(archivo, posicion, SEEK_SET);
+        fwrite(bytes, 1, largo, archivo);
+        fclose(archivo);
+    }
+}
+
+static bool mapear_rechaza(void)
+{
+    hash_compacto_t* hash = hash_compacto_mapear(RUTA_PRUEBA_COMPACTO);
+    if (hash) {
+        hash_compacto_destruir(hash);
+    }
+    return hash == NULL;
+}
+
+static void prueba_hash_compacto_mapear_danado()
+{
+    hash_compacto_t* hash = hash_compacto_crear(NULL);
+    hash_compacto_guardar(hash, "a", (void*)1);
+    hash_compacto_guardar(hash, "b", (void*)2);
+    hash_compacto_guardar(hash, "c", (void*)3);
+    // encabezado de 40 bytes, 16 ranuras de 4, 16 huellas de 2, 3 claves de
+    // 4 (alineadas a 16), 3 datos y la arena "a\0b\0c\0" alineada a 8
+    const long ranuras = 40, claves = 40 + 64 + 32, fin_arena = claves + 16 + 3 * (long)sizeof(void*) + 5;
+    uint32_t todas[16];
+    for (size_t i = 0; i < 16; i++) {
+        todas[i] = 1;
+    }
+    uint32_t fuera = 99;
+    char sin_fin = 'x';
+
+    hash_compacto_escribir(hash, RUTA_PRUEBA_COMPACTO);
+    print_test("Prueba hash compacto mapear archivo sano", !mapear_rechaza());
+    pisar_archivo(RUTA_PRUEBA_COMPACTO, ranuras, &fuera, sizeof(fuera));
+    print_test("Prueba hash compacto mapear rechaza ranura fuera de rango", mapear_rechaza());
+    hash_compacto_escribir(hash, RUTA_PRUEBA_COMPACTO);
+    pisar_archivo(RUTA_PRUEBA_COMPACTO, ranuras, todas, sizeof(todas));
+    print_test("Prueba hash compacto mapear rechaza tabla sin ranuras libres", mapear_rechaza());
+    hash_compacto_escribir(hash, RUTA_PRUEBA_COMPACTO);
+    pisar_archivo(RUTA_PRUEBA_COMPACTO, claves, &fuera, sizeof(fuera));
+    print_test("Prueba hash compacto mapear rechaza clave fuera de la arena", mapear_rechaza());
+    hash_compacto_escribir(hash, RUTA_PRUEBA_COMPACTO);
+    pisar_archivo(RUTA_PRUEBA_COMPACTO, fin_arena, &sin_fin, 1);
+    print_test("Prueba hash compacto mapear rechaza arena sin terminar", mapear_rechaza());
+    hash_compacto_destruir(hash);
+    remove(RUTA_PRUEBA_COMPACTO);
+}
+
+static void prueba_hash_obtener_con_prefijo()
+{
+    hash_estado_t estado;
+    hash_estado_iniciar(&estado);
+    hash_estado_agregar(&estado, "tenant:", 7);
+    hash_estado_agregar(&estado, "usuario", 7);
+    print_test("Prueba hash estado por partes es igual al hash entero",
+               hash_estado_terminar(&estado) == hash_funcion("tenant:usuario"));
+
+    hash_t* hash = hash_crear(NULL);
+    hash_guardar(hash, "acme:ana:nombre", "Ana");
+    hash_guardar(hash, "acme:ana:mail", "ana@acme");
+    hash_guardar(hash, "acme:beto:nombre", "Beto");
+    const char* sufijos[] = {"nombre", "mail", "telefono"};
+    void* datos[3];
+    hash_obtener_con_prefijo(hash, "acme:ana:", sufijos, 3, datos);
+    print_test("Prueba hash obtener con prefijo encuentra los campos",
+               strcmp(datos[0], "Ana") == 0 && strcmp(datos[1], "ana@acme") == 0);
+    print_test("Prueba hash obtener con prefijo campo inexistente", datos[2] == NULL);
+    hash_obtener_con_prefijo(hash, "acme:beto:", sufijos, 2, datos);
+    print_test("Prueba hash obtener con prefijo otro usuario", strcmp(datos[0], "Beto") == 0 && datos[1] == NULL);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_conjuntos(size_t largo)
+{
+    hash_t* pares = hash_crear(NULL);
+    hash_t* tercios = hash_crear(NULL);
+    char clave[24];
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        if (i % 2 == 0) {
+            hash_guardar(pares, clave, (void*)(i + 1));
+        }
+        if (i % 3 == 0) {
+            hash_guardar(tercios, clave, (void*)(i + 2));
+        }
+    }
+    hash_t* interseccion = hash_interseccion(pares, tercios);
+    hash_t* union_ = hash_union(pares, tercios);
+    hash_t* diferencia = hash_diferencia(pares, tercios);
+    bool ok = interseccion && union_ && diferencia;
+    for (size_t i = 0; ok && i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        bool par = i % 2 == 0;
+        bool tercio = i % 3 == 0;
+        ok &= hash_pertenece(interseccion, clave) == (par && tercio);
+        ok &= hash_pertenece(union_, clave) == (par || tercio);
+        ok &= hash_pertenece(diferencia, clave) == (par && !tercio);
+        if (par || tercio) {
+            ok &= hash_obtener(union_, clave) == (void*)(i + (par ? 1 : 2));
+        }
+    }
+    print_test("Prueba hash interseccion, union y diferencia", ok);
+    print_test("Prueba hash conjuntos las cantidades son correctas",
+               ok && hash_cantidad(interseccion) == (largo + 5) / 6
+               && hash_cantidad(union_) + hash_cantidad(interseccion) == hash_cantidad(pares) + hash_cantidad(tercios)
+               && hash_cantidad(diferencia) == hash_cantidad(pares) - hash_cantidad(interseccion));
+    hash_destruir(interseccion);
+    hash_destruir(union_);
+    hash_destruir(diferencia);
+    hash_destruir(pares);
+    hash_destruir(tercios);
+}
+
+typedef struct pares_join {
+    atomic_size_t pares;
+    atomic_size_t suma;
+} pares_join_t;
+
+static void contar_par(const char* clave, void* dato_construccion, void* dato_sondeo, void* extra)
+{
+    (void)clave;
+    pares_join_t* pares = extra;
+    atomic_fetch_add(&pares->pares, 1);
+    atomic_fetch_add(&pares->suma, (size_t)dato_construccion * (size_t)dato_sondeo);
+}
+
+static void prueba_hash_join(size_t largo)
+{
+    // construccion: cada clave k<i> dos veces, con datos 1 y 2
+    // sondeo: las claves k<i> de i par una vez, con dato 10, y otras que no cruzan
+    hash_filas_t construccion = {malloc(2 * largo * sizeof(char*)), malloc(2 * largo * sizeof(void*)), 2 * largo};
+    hash_filas_t sondeo = {malloc(largo * sizeof(char*)), malloc(largo * sizeof(void*)), largo};
+    char* textos = malloc(2 * largo * 24);
+    for (size_t i = 0; i < largo; i++) {
+        char* clave = textos + i * 24;
+        char* otra = textos + (largo + i) * 24;
+        sprintf(clave, "k%zu", i);
+        sprintf(otra, "x%zu", i);
+        construccion.claves[2 * i] = clave;
+        construccion.claves[2 * i + 1] = clave;
+        construccion.datos[2 * i] = (void*)1;
+        construccion.datos[2 * i + 1] = (void*)2;
+        sondeo.claves[i] = i % 2 == 0 ? clave : otra;
+        sondeo.datos[i] = (void*)10;
+    }
+    pares_join_t pares;
+    atomic_init(&pares.pares, 0);
+    atomic_init(&pares.suma, 0);
+    print_test("Prueba hash join", hash_join(&construccion, &sondeo, contar_par, &pares));
+    size_t cruzan = (largo + 1) / 2;
+    print_test("Prueba hash join visita cada par una vez", atomic_load(&pares.pares) == 2 * cruzan);
+    print_test("Prueba hash join pasa los datos de cada lado", atomic_load(&pares.suma) == 30 * cruzan);
+    free(construccion.claves);
+    free(construccion.datos);
+    free(sondeo.claves);
+    free(sondeo.datos);
+    free(textos);
+}
+
+#define RUTA_PRUEBA_CONGELADO "/tmp/prueba_hash_congelado"
+
+static void prueba_hash_congelar(size_t largo)
+{
+    hash_t* hash = hash_crear(NULL);
+    char clave[24];
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "c%zu", i);
+        hash_guardar(hash, clave, (void*)(i + 1));
+    }
+    print_test("Prueba hash congelar", hash_congelar(hash) && hash_cantidad(hash) == largo);
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "c%zu", i);
+        ok &= hash_obtener(hash, clave) == (void*)(i + 1);
+        sprintf(clave, "d%zu", i);
+        ok &= !hash_pertenece(hash, clave);
+    }
+    print_test("Prueba hash congelado obtener todas las claves", ok);
+    print_test("Prueba hash congelado es de solo lectura",
+               !hash_guardar(hash, "x", NULL) && !hash_borrar(hash, "c0") && hash_pertenece(hash, "c0"));
+
+    size_t recorridas = 0;
+    ok = true;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)) {
+        ok &= hash_pertenece(hash, hash_iter_ver_actual(iter));
+        recorridas++;
+    }
+    hash_iter_destruir(iter);
+    print_test("Prueba hash congelado iterar", ok && recorridas == largo);
+
+    const char* sufijos[] = {"1", "2", "x"};
+    void* datos[3];
+    hash_obtener_con_prefijo(hash, "c", sufijos, 3, datos);
+    print_test("Prueba hash congelado obtener con prefijo",
+               datos[0] == (void*)2 && datos[1] == (void*)3 && !datos[2]);
+
+    print_test("Prueba hash congelado escribir", hash_congelado_escribir(hash, RUTA_PRUEBA_CONGELADO));
+    hash_destruir(hash);
+    hash = hash_congelado_mapear(RUTA_PRUEBA_CONGELADO);
+    print_test("Prueba hash congelado mapear", hash && hash_cantidad(hash) == largo);
+    ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "c%zu", i);
+        ok &= hash_obtener(hash, clave) == (void*)(i + 1);
+    }
+    print_test("Prueba hash congelado mapeado obtener", ok && !hash_obtener(hash, "d0"));
+    hash_destruir(hash);
+    remove(RUTA_PRUEBA_CONGELADO);
+
+    // el congelado se queda con los datos y los destruye al final
+    hash = hash_crear(free);
+    for (size_t i = 0; i < 100; i++) {
+        sprintf(clave, "%zu", i);
+        hash_guardar(hash, clave, malloc(1));
+    }
+    print_test("Prueba hash congelar con destruir dato", hash_congelar(hash) && hash_congelar(hash));
+    hash_destruir(hash);
+
+    hash = hash_crear(NULL);
+    print_test("Prueba hash congelar vacio", hash_congelar(hash) && !hash_pertenece(hash, ""));
+    iter = hash_iter_crear(hash);
+    print_test("Prueba hash congelado vacio iterador al final", hash_iter_al_final(iter));
+    hash_iter_destruir(iter);
+    hash_destruir(hash);
+
+    hash = hash_crear_ordenado(NULL);
+    print_test("Prueba hash ordenado no se congela", !hash_congelar(hash));
+    hash_destruir(hash);
+}
+
+static uint64_t leer_numero_archivo(const char* ruta, long posicion)
+{
+    uint64_t numero = 0;
+    FILE* archivo = fopen(ruta, "rb");
+    if (archivo) {
+        fseek(archivo, posicion, SEEK_SET);
+        if (fread(&numero, sizeof(numero), 1, archivo) != 1) {
+            numero = 0;
+        }
+        fclose(archivo);
+    }
+    return numero;
+}
+
+static bool mapear_congelado_rechaza(void)
+{
+    hash_t* hash = hash_congelado_mapear(RUTA_PRUEBA_CONGELADO);
+    if (hash) {
+        hash_destruir(hash);
+    }
+    return hash == NULL;
+}
+
+static void alinear_a_8(long* posicion)
+{
+    *posicion = (*posicion + 7) & ~7L;
+}
+
+static void prueba_hash_congelado_mapear_danado()
+{
+    hash_t* hash = hash_crear(NULL);
+    char clave[24];
+    for (size_t i = 0; i < 1000; i++) {
+        sprintf(clave, "c%zu", i);
+        hash_guardar(hash, clave, (void*)(i + 1));
+    }
+    hash_congelar(hash);
+    hash_congelado_escribir(hash, RUTA_PRUEBA_CONGELADO);
+
+    // encabezado de 56 bytes (cantidad en 16, niveles en 24, palabras en
+    // 32) y despues inicios, bits, rangos y desplazamientos
+    uint64_t cantidad = leer_numero_archivo(RUTA_PRUEBA_CONGELADO, 16);
+    uint64_t niveles = leer_numero_archivo(RUTA_PRUEBA_CONGELADO, 24);
+    uint64_t palabras = leer_numero_archivo(RUTA_PRUEBA_CONGELADO, 32);
+    long bits = 56 + (long)(niveles + 1) * 8;
+    long rangos = bits + (long)palabras * 8;
+    long desplazamientos = rangos + (long)(palabras / 8 + 1) * 8;
+    long arena = desplazamientos + (long)(cantidad + 1) * 8 + (long)cantidad * (long)sizeof(void*);
+    alinear_a_8(&arena);
+    uint64_t enorme = (uint64_t)1 << 40;
+    uint64_t palabra = leer_numero_archivo(RUTA_PRUEBA_CONGELADO, bits) ^ 1;
+    uint64_t fin_primera = leer_numero_archivo(RUTA_PRUEBA_CONGELADO, desplazamientos + 8);
+    char sin_fin = 'x';
+
+    print_test("Prueba hash congelado mapear archivo sano", !mapear_congelado_rechaza());
+    pisar_archivo(RUTA_PRUEBA_CONGELADO, rangos, &enorme, sizeof(enorme));
+    print_test("Prueba hash congelado mapear rechaza rangos falsos", mapear_congelado_rechaza());
+    hash_congelado_escribir(hash, RUTA_PRUEBA_CONGELADO);
+    pisar_archivo(RUTA_PRUEBA_CONGELADO, bits, &palabra, sizeof(palabra));
+    print_test("Prueba hash congelado mapear rechaza bits que no cuadran", mapear_congelado_rechaza());
+    hash_congelado_escribir(hash, RUTA_PRUEBA_CONGELADO);
+    pisar_archivo(RUTA_PRUEBA_CONGELADO, desplazamientos + 8, &enorme, sizeof(enorme));
+    print_test("Prueba hash congelado mapear rechaza clave fuera de la arena", mapear_congelado_rechaza());
+    hash_congelado_escribir(hash, RUTA_PRUEBA_CONGELADO);
+    pisar_archivo(RUTA_PRUEBA_CONGELADO, arena + (long)fin_primera - 1, &sin_fin, 1);
+    print_test("Prueba hash congelado mapear rechaza clave sin terminar", mapear_congelado_rechaza());
+    hash_destruir(hash);
+    remove(RUTA_PRUEBA_CONGELADO);
+}
+
+// Flujo de bytes en memoria para serializar y deserializar
+typedef struct flujo {
+    char* bytes;
+    size_t largo;
+    size_t capacidad;
+    size_t leidos;
+} flujo_t;
+
+static bool escribir_en_flujo(const void* datos, size_t largo, void* contexto)
+{
+    flujo_t* flujo = contexto;
+    if (flujo->largo + largo > flujo->capacidad) {
+        size_t capacidad = 2 * (flujo->largo + largo);
+        char* bytes = realloc(flujo->bytes, capacidad);
+        if (!bytes) return false;
+        flujo->bytes = bytes;
+        flujo->capacidad = capacidad;
+    }
+    memcpy(flujo->bytes + flujo->largo, datos, largo);
+    flujo->largo += largo;
+    return true;
+}
+
+// entrega de a poco, como un pipe
+static size_t leer_de_flujo(void* destino, size_t largo, void* contexto)
+{
+    flujo_t* flujo = contexto;
+    size_t quedan = flujo->largo - flujo->leidos;
+    if (largo > quedan) largo = quedan;
+    if (largo > 1000) largo = 1000;
+    memcpy(destino, flujo->bytes + flujo->leidos, largo);
+    flujo->leidos += largo;
+    return largo;
+}
+
+static bool escribir_numero(const void* dato, const hash_escritor_t* escritor)
+{
+    return escritor->escribir(dato, sizeof(size_t), escritor->contexto);
+}
+
+static bool leer_numero(const hash_lector_t* lector, void** dato)
+{
+    size_t* numero = malloc(sizeof(size_t));
+    if (!numero || lector->leer(numero, sizeof(size_t), lector->contexto) != sizeof(size_t)) {
+        free(numero);
+        return false;
+    }
+    *dato = numero;
+    return true;
+}
+
+static void* copiar_numero(const void* dato)
+{
+    size_t* copia = malloc(sizeof(size_t));
+    if (copia) *copia = *(const size_t*)dato;
+    return copia;
+}
+
+static void prueba_hash_clonar(size_t largo)
+{
+    hash_t* hash = hash_crear(free);
+    char clave[24];
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "c%zu", i);
+        hash_guardar(hash, clave, copiar_numero(&i));
+    }
+    hash_t* clon = hash_clonar(hash, copiar_numero);
+    print_test("Prueba hash clonar", clon && hash_cantidad(clon) == largo);
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "c%zu", i);
+        size_t* original = hash_obtener(hash, clave);
+        size_t* copia = hash_obtener(clon, clave);
+        ok &= copia && *copia == i && copia != original;
+    }
+    print_test("Prueba hash clon tiene sus propios datos", ok);
+    free(hash_borrar(hash, "c0"));
+    hash_guardar(hash, "nueva", copiar_numero(&largo));
+    print_test("Prueba hash clon independiente del original",
+               hash_pertenece(clon, "c0") && !hash_pertenece(clon, "nueva") && hash_cantidad(clon) == largo);
+    hash_destruir(clon);
+
+    clon = hash_clonar(hash, NULL);
+    print_test("Prueba hash clon comparte los datos", clon && hash_obtener(clon, "nueva") == hash_obtener(hash, "nueva"));
+    hash_destruir(clon);
+    hash_destruir(hash);
+
+    hash = hash_crear_ordenado(NULL);
+    hash_guardar(hash, "b", NULL);
+    hash_guardar(hash, "a", NULL);
+    clon = hash_clonar(hash, NULL);
+    hash_iter_t* iter = hash_iter_crear_ordenado(clon);
+    print_test("Prueba hash clon ordenado", iter && strcmp(hash_iter_ver_actual(iter), "a") == 0);
+    hash_iter_destruir(iter);
+    hash_destruir(clon);
+    hash_destruir(hash);
+
+    hash = hash_crear(NULL);
+    hash_guardar(hash, "a", NULL);
+    hash_congelar(hash);
+    print_test("Prueba hash congelado no se clona", !hash_clonar(hash, NULL));
+    hash_destruir(hash);
+}
+
+static void prueba_hash_serializar(size_t largo)
+{
+    hash_t* hash = hash_crear(NULL);
+    char clave[24];
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "c%zu", i);
+        hash_guardar(hash, clave, (void*)(i + 1));
+    }
+    flujo_t flujo = {NULL, 0, 0, 0};
+    hash_escritor_t escritor = {escribir_en_flujo, &flujo};
+    hash_lector_t lector = {leer_de_flujo, &flujo};
+    print_test("Prueba hash serializar", hash_serializar(hash, &escritor, NULL));
+    hash_t* leido = hash_deserializar(&lector, NULL, NULL);
+    bool ok = leido && hash_cantidad(leido) == largo;
+    for (size_t i = 0; ok && i < largo; i++) {
+        sprintf(clave, "c%zu", i);
+        ok &= hash_obtener(leido, clave) == (void*)(i + 1);
+    }
+    print_test("Prueba hash deserializar", ok && !hash_pertenece(leido, "d0"));
+    print_test("Prueba hash deserializado se puede modificar",
+               hash_guardar(leido, "d0", NULL) && hash_borrar(leido, "c0") == (void*)1);
+    hash_destruir(leido);
+
+    // cortado a la mitad o con otra versión no se lee
+    size_t completo = flujo.largo;
+    flujo.largo = completo / 2;
+    flujo.leidos = 0;
+    print_test("Prueba hash deserializar flujo cortado", !hash_deserializar(&lector, NULL, NULL));
+    flujo.largo = completo;
+    flujo.leidos = 0;
+    flujo.bytes[8]++;
+    print_test("Prueba hash deserializar otra version", !hash_deserializar(&lector, NULL, NULL));
+    hash_destruir(hash);
+
+    hash = hash_crear_ordenado(free);
+    for (size_t i = 0; i < 1000; i++) {
+        sprintf(clave, "%04zu", i);
+        hash_guardar(hash, clave, copiar_numero(&i));
+    }
+    flujo.largo = 0;
+    flujo.leidos = 0;
+    ok = hash_serializar(hash, &escritor, escribir_numero);
+    hash_destruir(hash);
+    hash = hash_deserializar(&lector, free, leer_numero);
+    hash_iter_t* iter = hash ? hash_iter_crear_ordenado(hash) : NULL;
+    for (size_t i = 0; ok && iter && i < 1000; i++, hash_iter_avanzar(iter)) {
+        sprintf(clave, "%04zu", i);
+        ok &= strcmp(hash_iter_ver_actual(iter), clave) == 0 && *(size_t*)hash_obtener(hash, clave) == i;
+    }
+    print_test("Prueba hash serializar ordenado con datos propios", ok && iter && hash_iter_al_final(iter));
+    hash_iter_destruir(iter);
+    hash_destruir(hash);
+
+    // cabecera de 32 bytes: magia, version, ordenado, cantidad y capacidad
+    hash = hash_crear(NULL);
+    hash_guardar(hash, "a", (void*)1);
+    flujo.largo = 0;
+    hash_serializar(hash, &escritor, NULL);
+    hash_destruir(hash);
+    uint64_t cantidad = 0, capacidad = (uint64_t)1 << 28;
+    char cabecera[32];
+    memcpy(cabecera, flujo.bytes, sizeof(cabecera));
+    memcpy(cabecera + 16, &cantidad, sizeof(cantidad));
+    memcpy(cabecera + 24, &capacidad, sizeof(capacidad));
+    flujo_t falso = {cabecera, sizeof(cabecera), sizeof(cabecera), 0};
+    hash_lector_t lector_falso = {leer_de_flujo, &falso};
+    hash = hash_deserializar(&lector_falso, NULL, NULL);
+    print_test("Prueba hash deserializar ignora una capacidad enorme", hash && hash_cantidad(hash) == 0 && hash_guardar(hash, "b", NULL));
+    hash_destruir(hash);
+
+    // la misma entrada dos veces
+    size_t largo_entrada = flujo.largo - sizeof(cabecera);
+    char* repetido = malloc(sizeof(cabecera) + 2 * largo_entrada);
+    cantidad = 2;
+    memcpy(repetido, flujo.bytes, sizeof(cabecera) + largo_entrada);
+    memcpy(repetido + 16, &cantidad, sizeof(cantidad));
+    memcpy(repetido + sizeof(cabecera) + largo_entrada, flujo.bytes + sizeof(cabecera), largo_entrada);
+    falso = (flujo_t){repetido, sizeof(cabecera) + 2 * largo_entrada, sizeof(cabecera) + 2 * largo_entrada, 0};
+    print_test("Prueba hash deserializar rechaza claves repetidas", !hash_deserializar(&lector_falso, NULL, NULL));
+    free(repetido);
+    free(flujo.bytes);
+}
+
+static void prueba_hash_multiple(size_t largo)
+{
+    hash_t* hash = hash_crear_multiple(NULL);
+    char clave[24];
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "t%zu", i % 1000);
+        ok &= hash_agregar(hash, clave, (void*)(i + 1));
+    }
+    print_test("Prueba hash multiple agregar", ok && hash_cantidad(hash) == 1000);
+    void** datos;
+    size_t cantidad;
+    for (size_t i = 0; i < 1000; i++) {
+        sprintf(clave, "t%zu", i);
+        ok &= hash_obtener_todos(hash, clave, &datos, &cantidad) && cantidad == largo / 1000;
+        for (size_t j = 0; ok && j < cantidad; j++) {
+            ok &= datos[j] == (void*)(j * 1000 + i + 1);
+        }
+    }
+    print_test("Prueba hash multiple obtener todos en orden", ok);
+    print_test("Prueba hash multiple obtener da el primero", hash_obtener(hash, "t7") == (void*)8);
+    print_test("Prueba hash multiple clave ausente",
+               !hash_obtener_todos(hash, "x", &datos, &cantidad) && !datos && cantidad == 0);
+    print_test("Prueba hash multiple no guarda", !hash_guardar(hash, "t1", NULL));
+    print_test("Prueba hash multiple borrar", !hash_borrar(hash, "t1") && !hash_pertenece(hash, "t1"));
+    hash_destruir(hash);
+
+    hash = hash_crear_multiple(free);
+    for (size_t i = 0; i < 100; i++) {
+        hash_agregar(hash, i % 2 ? "impar" : "par", malloc(1));
+    }
+    hash_borrar(hash, "par");
+    print_test("Prueba hash multiple con destruir dato",
+               hash_obtener_todos(hash, "impar", &datos, &cantidad) && cantidad == 50);
+    hash_destruir(hash);
+
+    hash = hash_crear(NULL);
+    print_test("Prueba hash simple no agrega", !hash_agregar(hash, "a", NULL) && !hash_pertenece(hash, "a"));
+    hash_destruir(hash);
+}
+
+static atomic_size_t destruidos_diferidos;
+
+static void destruir_contando(void* dato)
+{
+    atomic_fetch_add(&destruidos_diferidos, 1);
+    free(dato);
+}
+
+static void prueba_hash_destruccion_diferida(size_t largo)
+{
+    epoca_t* epoca = epoca_crear();
+    hash_t* hash = hash_crear(destruir_contando);
+    hash_diferir_destruccion(hash, epoca);
+    atomic_store(&destruidos_diferidos, 0);
+    char clave[24];
+    for (size_t r = 0; r < 2; r++) {
+        for (size_t i = 0; i < largo; i++) {
+            sprintf(clave, "c%zu", i);
+            hash_guardar(hash, clave, malloc(sizeof(size_t)));
+        }
+    }
+    print_test("Prueba hash diferido reemplazar no destruye",
+               atomic_load(&destruidos_diferidos) == 0 && epoca_pendientes(epoca) == largo);
+    print_test("Prueba hash diferido recolectar con presupuesto",
+               hash_recolectar(hash, 100) == 100 && atomic_load(&destruidos_diferidos) == 100);
+
+    epoca_lector_t* lector = epoca_lector_crear(epoca);
+    epoca_entrar(lector);
+    hash_guardar(hash, "c0", malloc(sizeof(size_t)));
+    hash_recolectar(hash, SIZE_MAX);
+    print_test("Prueba hash diferido respeta al lector adentro", epoca_pendientes(epoca) == 1);
+    epoca_salir(lector);
+    print_test("Prueba hash diferido recolecta al salir el lector",
+               hash_recolectar(hash, SIZE_MAX) == 1 && epoca_pendientes(epoca) == 0);
+    epoca_lector_destruir(lector);
+
+    hash_destruir(hash);
+    print_test("Prueba hash diferido destruir", epoca_pendientes(epoca) == largo);
+    print_test("Prueba hash diferido hilo recolector",
+               epoca_recolectar_en_hilo(epoca, 64, 1) && !epoca_recolectar_en_hilo(epoca, 64, 1));
+    for (long vueltas = 0; epoca_pendientes(epoca) > 0 && vueltas < 100000000; vueltas++) {
+        sched_yield();
+    }
+    print_test("Prueba hash diferido el hilo destruye todo",
+               epoca_pendientes(epoca) == 0 && atomic_load(&destruidos_diferidos) == 2 * largo + 1);
+    epoca_destruir(epoca);
+}
+
+#define FIJAS_DIFERIDO 64
+
+typedef struct lectura_diferida {
+    hash_cuco_t* hash;
+    epoca_t* epoca;
+    atomic_bool terminar;
+    bool ok;
+} lectura_diferida_t;
+
+static void* leer_diferido(void* extra)
+{
+    lectura_diferida_t* lectura = extra;
+    epoca_lector_t* lector = epoca_lector_crear(lectura->epoca);
+    char clave[24];
+    while (!atomic_load(&lectura->terminar)) {
+        for (size_t i = 0; i < FIJAS_DIFERIDO; i++) {
+            sprintf(clave, "fija%zu", i);
+            epoca_entrar(lector);
+            size_t* valor = hash_cuco_obtener(lectura->hash, clave);
+            lectura->ok &= valor && *valor == i;
+            epoca_salir(lector);
+        }
+    }
+    epoca_lector_destruir(lector);
+    return NULL;
+}
+
+static void prueba_hash_cuco_diferido(size_t largo)
+{
+    epoca_t* epoca = epoca_crear();
+    hash_cuco_t* hash = hash_cuco_crear(free);
+    hash_cuco_diferir_destruccion(hash, epoca);
+    char clave[24];
+    for (size_t i = 0; i < FIJAS_DIFERIDO; i++) {
+        sprintf(clave, "fija%zu", i);
+        hash_cuco_guardar(hash, clave, copiar_numero(&i));
+    }
+    lectura_diferida_t lectura = {.hash = hash, .epoca = epoca, .ok = true};
+    atomic_init(&lectura.terminar, false);
+    pthread_t hilo;
+    pthread_create(&hilo, NULL, leer_diferido, &lectura);
+    // cada reemplazo retira el dato que el lector puede estar leyendo
+    for (size_t r = 0; r < largo; r++) {
+        size_t i = r % FIJAS_DIFERIDO;
+        sprintf(clave, "fija%zu", i);
+        hash_cuco_guardar(hash, clave, copiar_numero(&i));
+        if (r % FIJAS_DIFERIDO == 0) {
+            epoca_recolectar(epoca, FIJAS_DIFERIDO);
+        }
+    }
+    atomic_store(&lectura.terminar, true);
+    pthread_join(hilo, NULL);
+    print_test("Prueba hash cuco diferido el lector nunca ve un dato destruido", lectura.ok);
+    hash_cuco_destruir(hash);
+    epoca_destruir(epoca);
+}
+
+static void prueba_hash_internador(size_t largo)
+{
+    hash_internador_t* internador = hash_internador_crear();
+    uint32_t id = hash_internador_id(internador, "hola");
+    print_test("Prueba internador primer id", id == 0);
+    print_test("Prueba internador mismo texto mismo id", hash_internador_id(internador, "hola") == id);
+    print_test("Prueba internador texto vacio", hash_internador_id(internador, "") == 1);
+    print_test("Prueba internador buscar ausente", hash_internador_buscar(internador, "chau") == HASH_INTERNADOR_SIN_ID);
+    const char* hola = hash_internador_texto(internador, id);
+    print_test("Prueba internador texto del id", hola && strcmp(hola, "hola") == 0);
+    print_test("Prueba internador id sin repartir", !hash_internador_texto(internador, 2));
+
+    char texto[24];
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(texto, "t%zu", i);
+        ok &= hash_internador_id(internador, texto) == i + 2;
+    }
+    print_test("Prueba internador ids consecutivos", ok && hash_internador_cantidad(internador) == largo + 2);
+    print_test("Prueba internador el texto no se mueve al crecer", hash_internador_texto(internador, id) == hola);
+    ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(texto, "t%zu", i);
+        ok &= hash_internador_buscar(internador, texto) == i + 2;
+        ok &= strcmp(hash_internador_texto(internador, (uint32_t)(i + 2)), texto) == 0;
+    }
+    print_test("Prueba internador buscar y texto en volumen", ok);
+
+    // la mitad ya internados y la mitad nuevos
+    const char** textos = malloc(largo * sizeof(char*));
+    uint32_t* ids = malloc(largo * sizeof(uint32_t));
+    char (*copias)[24] = malloc(largo * sizeof(*copias));
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(copias[i], "t%zu", largo / 2 + i);
+        textos[i] = copias[i];
+    }
+    ok = hash_internador_ids(internador, textos, largo, ids);
+    for (size_t i = 0; i < largo; i++) {
+        ok &= ids[i] == largo / 2 + i + 2;
+    }
+    print_test("Prueba internador ids en lote", ok && hash_internador_cantidad(internador) == largo + largo / 2 + 2);
+    free(copias);
+    free(ids);
+    free(textos);
+    hash_internador_destruir(internador);
+}
+
+#define HILOS_INTERNADOR 4
+
+typedef struct internado {
+    hash_internador_concurrente_t* internador;
+    size_t desde;
+    size_t largo;
+    uint32_t* ids;
+} internado_t;
+
+static void* internar(void* extra)
+{
+    internado_t* internado = extra;
+    char texto[24];
+    for (size_t i = 0; i < internado->largo; i++) {
+        sprintf(texto, "t%zu", internado->desde + i);
+        internado->ids[i] = hash_internador_concurrente_id(internado->internador, texto);
+    }
+    return NULL;
+}
+
+static void prueba_hash_internador_concurrente(size_t largo)
+{
+    hash_internador_concurrente_t* internador = hash_internador_concurrente_crear();
+    pthread_t hilos[HILOS_INTERNADOR];
+    internado_t internados[HILOS_INTERNADOR];
+    // cada hilo comparte la mitad de sus textos con el siguiente
+    for (size_t i = 0; i < HILOS_INTERNADOR; i++) {
+        internados[i] = (internado_t){internador, i * largo / 2, largo, malloc(largo * sizeof(uint32_t))};
+        pthread_create(&hilos[i], NULL, internar, &internados[i]);
+    }
+    for (size_t i = 0; i < HILOS_INTERNADOR; i++) {
+        pthread_join(hilos[i], NULL);
+    }
+    size_t distintos = (HILOS_INTERNADOR + 1) * largo / 2;
+    print_test("Prueba internador concurrente cantidad", hash_internador_concurrente_cantidad(internador) == distintos);
+
+    bool ok = true;
+    bool* usados = calloc(distintos, sizeof(bool));
+    char texto[24];
+    for (size_t i = 0; i < HILOS_INTERNADOR; i++) {
+        for (size_t j = 0; j < largo; j++) {
+            uint32_t id = internados[i].ids[j];
+            sprintf(texto, "t%zu", internados[i].desde + j);
+            const char* guardado = id < distintos ? hash_internador_concurrente_texto(internador, id) : NULL;
+            ok &= guardado && strcmp(guardado, texto) == 0;
+            ok &= hash_internador_concurrente_buscar(internador, texto) == id;
+            if (id < distintos) {
+                usados[id] = true;
+            }
+        }
+        free(internados[i].ids);
+    }
+    for (size_t i = 0; i < distintos; i++) {
+        ok &= usados[i];
+    }
+    print_test("Prueba internador concurrente ids unicos y consistentes", ok);
+    print_test("Prueba internador concurrente buscar ausente",
+               hash_internador_concurrente_buscar(internador, "x") == HASH_INTERNADOR_SIN_ID);
+    free(usados);
+    hash_internador_concurrente_destruir(internador);
+}
+
+/* ******************************************************************
+ *                        FUNCIÓN PRINCIPAL
+ * *****************************************************************/
+
+
+void pruebas_hash_alumno()
+{
+    prueba_hash_versionado();
+    prueba_hash_versionado_volumen(5000);
+    prueba_hamt_clonar();
+    prueba_hamt_volumen(5000);
+    prueba_cola_concurrente();
+    prueba_lista_bloque();
+    prueba_lista_insertar_varios();
+    prueba_lista_intrusiva();
+    prueba_hash_ordenado();
+    prueba_hash_ordenado_volumen(5000);
+    prueba_hash_durable();
+    prueba_hash_obtener_o_guardar();
+    prueba_hash_guardar_lote();
+    prueba_hash_buffer();
+    prueba_hash_fusionar();
+    prueba_hash_unir(100000);
+    prueba_hash_cuco();
+    prueba_hash_cuco_volumen(100000);
+    prueba_hash_cuco_choques();
+    prueba_hash_cuco_concurrente(50000);
+    prueba_hash_asignador(200000);
+    prueba_hash_politica_memoria(100000);
+    prueba_hash_en_linea();
+    prueba_hash_compacto();
+    prueba_hash_compacto_volumen(100000);
+    prueba_hash_compacto_mapeado(50000);
+    prueba_hash_compacto_mapear_danado();
+    prueba_hash_obtener_con_prefijo();
+    prueba_hash_conjuntos(60000);
+    prueba_hash_join(100000);
+    prueba_hash_congelar(100000);
+    prueba_hash_congelado_mapear_danado();
+    prueba_hash_clonar(100000);
+    prueba_hash_serializar(100000);
+    prueba_hash_multiple(100000);
+    prueba_hash_destruccion_diferida(10000);
+    prueba_hash_cuco_diferido(200000);
+    prueba_hash_internador(100000);
+    prueba_hash_internador_concurrente(50000);
+}